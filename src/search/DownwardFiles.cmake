@@ -51,6 +51,8 @@ fast_downward_plugin(
         abstract_task
         axioms
         command_line
+        concurrent_state_registry
+        concurrent_state_registry_benchmark
         evaluation_context
         evaluation_result
         evaluator
@@ -68,9 +70,11 @@ fast_downward_plugin(
         pruning_method
         search_algorithm
         search_node_info
+        search_profiler
         search_progress
         search_space
         search_statistics
+        state_compressor
         state_id
         state_registry
         task_id
@@ -86,9 +90,10 @@ fast_downward_plugin(
         SOURCES
             safe_abstraction/abstractor
             safe_abstraction/free_domain_transition_graph
-            safe_abstraction/variableAdjuster
             safe_abstraction/refiner
             safe_abstraction/compositor
+            safe_abstraction/operator_index
+            safe_abstraction/hierarchy_cache
         CORE_PLUGIN
 )
 
@@ -132,6 +137,7 @@ fast_downward_plugin(
         utils/language
         utils/logging
         utils/markup
+        utils/mapped_memory
         utils/math
         utils/memory
         utils/rng
@@ -158,6 +164,13 @@ fast_downward_plugin(
         open_lists/best_first_open_list
 )
 
+fast_downward_plugin(
+    NAME BUCKET_OPEN_LIST
+    HELP "Open list that stores entries in an array of buckets indexed by evaluator value"
+    SOURCES
+        open_lists/bucket_open_list
+)
+
 fast_downward_plugin(
     NAME EPSILON_GREEDY_OPEN_LIST
     HELP "Open list that chooses an entry randomly with probability epsilon"
@@ -468,6 +481,14 @@ fast_downward_plugin(
     DEPENDS G_EVALUATOR ORDERED_SET PREF_EVALUATOR SEARCH_COMMON SUCCESSOR_GENERATOR
 )
 
+fast_downward_plugin(
+    NAME HDA_STAR_SEARCH
+    HELP "Hash-distributed A* search"
+    SOURCES
+        search_algorithms/hda_star_search
+    DEPENDS SUCCESSOR_GENERATOR
+)
+
 fast_downward_plugin(
     NAME ITERATED_SEARCH
     HELP "Iterated search"
@@ -630,6 +651,8 @@ fast_downward_plugin(
     NAME SUCCESSOR_GENERATOR
     HELP "Successor generator"
     SOURCES
+        task_utils/bit_parallel_successor_generator
+        task_utils/compiled_successor_generator
         task_utils/successor_generator
         task_utils/successor_generator_factory
         task_utils/successor_generator_internals
@@ -108,10 +108,6 @@ class IntHashSet {
     int num_entries;
     int num_resizes;
 
-    int capacity() const {
-        return buckets.size();
-    }
-
     void rehash(int new_capacity) {
         assert(new_capacity >= 1);
         int num_entries_before = num_entries;
@@ -280,6 +276,11 @@ public:
         return num_entries;
     }
 
+    // Return the number of buckets.
+    int capacity() const {
+        return buckets.size();
+    }
+
     /*
       Insert a key into the hash set.
 
@@ -292,6 +293,24 @@ public:
         return insert(key, hasher(key));
     }
 
+    /*
+      Like insert(key), but with the hash of the key computed by the caller,
+      e.g. to prefetch its bucket in advance.
+    */
+    std::pair<KeyType, bool> insert_with_hash(KeyType key, HashType hash) {
+        assert(key >= 0);
+        return insert(key, hash);
+    }
+
+    // Hint that the ideal bucket for the given hash will be accessed soon.
+    void prefetch(HashType hash) const {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(&buckets[get_bucket(hash)]);
+#else
+        utils::unused_variable(hash);
+#endif
+    }
+
     void dump(utils::LogProxy &log) const {
         int num_buckets = capacity();
         log << "[";
@@ -62,6 +62,19 @@ public:
         Bin &bin = buffer[bin_index];
         bin = (bin & clear_mask) | (value << shift);
     }
+
+    int get_bin_index() const {
+        return bin_index;
+    }
+
+    Bin get_mask() const {
+        return read_mask;
+    }
+
+    Bin get_bits(int value) const {
+        assert(value >= 0 && value < range);
+        return Bin(value) << shift;
+    }
 };
 
 
@@ -81,6 +94,18 @@ void IntPacker::set(Bin *buffer, int var, int value) const {
     var_infos[var].set(buffer, value);
 }
 
+int IntPacker::get_bin_index(int var) const {
+    return var_infos[var].get_bin_index();
+}
+
+IntPacker::Bin IntPacker::get_mask(int var) const {
+    return var_infos[var].get_mask();
+}
+
+IntPacker::Bin IntPacker::get_bits(int var, int value) const {
+    return var_infos[var].get_bits(value);
+}
+
 void IntPacker::pack_bins(const vector<int> &ranges) {
     assert(var_infos.empty());
 
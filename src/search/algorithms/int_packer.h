@@ -42,6 +42,15 @@ public:
     int get(const Bin *buffer, int var) const;
     void set(Bin *buffer, int var, int value) const;
 
+    /*
+      A buffer stores the given value for var iff
+      (buffer[get_bin_index(var)] & get_mask(var)) == get_bits(var, value).
+      This allows testing facts without unpacking the buffer.
+    */
+    int get_bin_index(int var) const;
+    Bin get_mask(int var) const;
+    Bin get_bits(int var, int value) const;
+
     int get_num_bins() const {return num_bins;}
 };
 }
@@ -0,0 +1,121 @@
+#include "concurrent_state_registry.h"
+
+#include "task_utils/task_properties.h"
+#include "utils/logging.h"
+#include "utils/system.h"
+
+using namespace std;
+
+static int get_shard_bits(int num_shards) {
+    int bits = 0;
+    while ((1 << bits) < num_shards)
+        ++bits;
+    return bits;
+}
+
+ConcurrentStateRegistry::ConcurrentStateRegistry(
+    const TaskProxy &task_proxy, int num_shards)
+    : task_proxy(task_proxy),
+      state_packer(task_properties::g_state_packers[task_proxy]),
+      num_bins(state_packer.get_num_bins()),
+      shard_bits(get_shard_bits(num_shards)),
+      pages(new atomic<atomic<PackedStateBin *> *>[NUM_PAGES]),
+      num_blocks(0),
+      num_states(0) {
+    for (int i = 0; i < NUM_PAGES; ++i)
+        pages[i].store(nullptr, memory_order_relaxed);
+    for (int i = 0; i < (1 << shard_bits); ++i)
+        shards.push_back(make_unique<Shard>(*this));
+}
+
+ConcurrentStateRegistry::~ConcurrentStateRegistry() {
+    int blocks = num_blocks.load();
+    for (int block = 0; block < blocks; ++block) {
+        atomic<PackedStateBin *> *page = pages[block >> PAGE_BITS].load();
+        delete[] page[block & (BLOCKS_PER_PAGE - 1)].load();
+    }
+    for (int i = 0; i < NUM_PAGES; ++i)
+        delete[] pages[i].load();
+}
+
+/*
+  Reserves the next block of IDs and allocates its data. The page of the block
+  is created by whichever thread needs it first.
+*/
+int ConcurrentStateRegistry::allocate_block() {
+    int block = num_blocks.fetch_add(1);
+    if (block >= NUM_PAGES * BLOCKS_PER_PAGE) {
+        cerr << "ConcurrentStateRegistry ran out of state IDs." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+    }
+    atomic<atomic<PackedStateBin *> *> &page_entry = pages[block >> PAGE_BITS];
+    atomic<PackedStateBin *> *page = page_entry.load(memory_order_acquire);
+    if (!page) {
+        atomic<PackedStateBin *> *new_page = new atomic<PackedStateBin *>[BLOCKS_PER_PAGE];
+        for (int i = 0; i < BLOCKS_PER_PAGE; ++i)
+            new_page[i].store(nullptr, memory_order_relaxed);
+        if (page_entry.compare_exchange_strong(page, new_page, memory_order_acq_rel)) {
+            page = new_page;
+        } else {
+            delete[] new_page;
+        }
+    }
+    PackedStateBin *data = new PackedStateBin[static_cast<size_t>(IDS_PER_BLOCK) * num_bins];
+    page[block & (BLOCKS_PER_PAGE - 1)].store(data, memory_order_release);
+    return block;
+}
+
+pair<StateID, bool> ConcurrentStateRegistry::insert_state(
+    Arena &arena, const PackedStateBin *buffer) {
+    if (arena.used == IDS_PER_BLOCK) {
+        arena.block = allocate_block();
+        arena.used = 0;
+    }
+    /*
+      Write the data to the next free slot of the arena so that the hash set
+      can compare it to other states. If the state turns out to be a
+      duplicate, the slot is reused by the next insertion of this arena.
+    */
+    int id = (arena.block << BLOCK_BITS) + arena.used;
+    PackedStateBin *slot = const_cast<PackedStateBin *>(get_buffer(id));
+    copy(buffer, buffer + num_bins, slot);
+
+    int_hash_set::HashType hash = StateRegistry::get_packed_state_hash(buffer, num_bins);
+    Shard &shard = *shards[shard_bits == 0 ? 0 : hash >> (32 - shard_bits)];
+    pair<int, bool> result;
+    {
+        lock_guard<mutex> lock(shard.mutex);
+        result = shard.states.insert(id);
+    }
+    if (result.second) {
+        ++arena.used;
+        num_states.fetch_add(1, memory_order_relaxed);
+    }
+    return make_pair(StateID(result.first), result.second);
+}
+
+StateID ConcurrentStateRegistry::insert_initial_state(Arena &arena) {
+    vector<PackedStateBin> buffer(num_bins, 0);
+    State initial_state = task_proxy.get_initial_state();
+    for (size_t i = 0; i < initial_state.size(); ++i) {
+        state_packer.set(buffer.data(), i, initial_state[i].get_value());
+    }
+    return insert_state(arena, buffer.data()).first;
+}
+
+State ConcurrentStateRegistry::lookup_state(StateID id) const {
+    const PackedStateBin *buffer = lookup_buffer(id);
+    int num_variables = task_proxy.get_variables().size();
+    vector<int> values(num_variables);
+    for (int var = 0; var < num_variables; ++var) {
+        values[var] = state_packer.get(buffer, var);
+    }
+    return task_proxy.create_state(move(values));
+}
+
+void ConcurrentStateRegistry::print_statistics(utils::LogProxy &log) const {
+    log << "Number of registered states: " << size() << endl;
+    log << "Number of shards: " << shards.size() << endl;
+    log << "Number of allocated state blocks: " << num_blocks.load()
+        << " (" << IDS_PER_BLOCK << " states each)" << endl;
+}
@@ -0,0 +1,165 @@
+#ifndef CONCURRENT_STATE_REGISTRY_H
+#define CONCURRENT_STATE_REGISTRY_H
+
+#include "state_id.h"
+#include "state_registry.h"
+#include "task_proxy.h"
+
+#include "algorithms/int_hash_set.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace utils {
+class LogProxy;
+}
+
+/*
+  Variant of StateRegistry that can be used by several threads at once, e.g.
+  by parallel searches or parallel precomputations on a shared state space.
+
+  State data is appended to per-thread arenas: every thread registers states
+  through its own Arena, which hands out IDs from blocks of consecutive IDs
+  reserved for it. IDs are stable and lookups are lock-free. Duplicate
+  detection uses one hash set per shard, where the shard of a state is chosen
+  by the top bits of its hash (the hash sets themselves use the low bits).
+  Inserting locks only the shard of the state.
+
+  Unlike StateRegistry, lookup_state returns unregistered states, since
+  PerStateInformation and the other per-state containers are not thread-safe.
+
+  The planner option benchmark_state_registry=N measures the throughput of
+  this class (see concurrent_state_registry_benchmark.h).
+*/
+class ConcurrentStateRegistry {
+    static const int BLOCK_BITS = 10;
+    static const int IDS_PER_BLOCK = 1 << BLOCK_BITS;
+    static const int PAGE_BITS = 10;
+    static const int BLOCKS_PER_PAGE = 1 << PAGE_BITS;
+    static const int NUM_PAGES = 1 << (31 - BLOCK_BITS - PAGE_BITS);
+
+    struct StateIDSemanticHash {
+        const ConcurrentStateRegistry &registry;
+        explicit StateIDSemanticHash(const ConcurrentStateRegistry &registry)
+            : registry(registry) {
+        }
+
+        int_hash_set::HashType operator()(int id) const {
+            return StateRegistry::get_packed_state_hash(
+                registry.get_buffer(id), registry.num_bins);
+        }
+    };
+
+    struct StateIDSemanticEqual {
+        const ConcurrentStateRegistry &registry;
+        explicit StateIDSemanticEqual(const ConcurrentStateRegistry &registry)
+            : registry(registry) {
+        }
+
+        bool operator()(int lhs, int rhs) const {
+            const PackedStateBin *lhs_data = registry.get_buffer(lhs);
+            const PackedStateBin *rhs_data = registry.get_buffer(rhs);
+            return std::equal(lhs_data, lhs_data + registry.num_bins, rhs_data);
+        }
+    };
+
+    using StateIDSet = int_hash_set::IntHashSet<StateIDSemanticHash, StateIDSemanticEqual>;
+
+    struct Shard {
+        std::mutex mutex;
+        StateIDSet states;
+
+        explicit Shard(const ConcurrentStateRegistry &registry)
+            : states(StateIDSemanticHash(registry), StateIDSemanticEqual(registry)) {
+        }
+    };
+
+    TaskProxy task_proxy;
+    const int_packer::IntPacker &state_packer;
+    const int num_bins;
+    const int shard_bits;
+
+    /*
+      Two-level directory from block index to the state data of the block.
+      Pages and blocks are allocated on demand and never move.
+    */
+    std::unique_ptr<std::atomic<std::atomic<PackedStateBin *> *>[]> pages;
+    std::atomic<int> num_blocks;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<int> num_states;
+
+    const PackedStateBin *get_buffer(int id) const {
+        std::atomic<PackedStateBin *> *page =
+            pages[id >> (BLOCK_BITS + PAGE_BITS)].load(std::memory_order_acquire);
+        PackedStateBin *block =
+            page[(id >> BLOCK_BITS) & (BLOCKS_PER_PAGE - 1)].load(std::memory_order_acquire);
+        return block + static_cast<size_t>(id & (IDS_PER_BLOCK - 1)) * num_bins;
+    }
+    int allocate_block();
+
+public:
+    /*
+      Registers states for one thread. An arena must only be used by one
+      thread at a time.
+    */
+    class Arena {
+        friend class ConcurrentStateRegistry;
+        int block = -1;
+        int used = IDS_PER_BLOCK;
+    };
+
+    /*
+      num_shards is rounded up to a power of 2. More shards mean less
+      contention between threads inserting at the same time.
+    */
+    explicit ConcurrentStateRegistry(const TaskProxy &task_proxy, int num_shards = 64);
+    ~ConcurrentStateRegistry();
+
+    ConcurrentStateRegistry(const ConcurrentStateRegistry &) = delete;
+    ConcurrentStateRegistry &operator=(const ConcurrentStateRegistry &) = delete;
+
+    const TaskProxy &get_task_proxy() const {
+        return task_proxy;
+    }
+
+    const int_packer::IntPacker &get_state_packer() const {
+        return state_packer;
+    }
+
+    int get_bins_per_state() const {
+        return num_bins;
+    }
+
+    /*
+      Registers the state with the given packed data if this was not done
+      before. Returns its ID and whether it was new. Thread-safe.
+    */
+    std::pair<StateID, bool> insert_state(Arena &arena, const PackedStateBin *buffer);
+
+    // Registers the initial state (if necessary) and returns its ID. Thread-safe.
+    StateID insert_initial_state(Arena &arena);
+
+    /*
+      Returns the packed data of a registered state. Thread-safe for IDs that
+      were obtained from insert_state (possibly in another thread, as long as
+      the ID was passed on with proper synchronization).
+    */
+    const PackedStateBin *lookup_buffer(StateID id) const {
+        return get_buffer(id.value);
+    }
+
+    // Returns an unregistered copy of the state with the given ID.
+    State lookup_state(StateID id) const;
+
+    size_t size() const {
+        return num_states.load(std::memory_order_relaxed);
+    }
+
+    void print_statistics(utils::LogProxy &log) const;
+};
+
+#endif
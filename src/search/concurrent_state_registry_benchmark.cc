@@ -0,0 +1,132 @@
+#include "concurrent_state_registry_benchmark.h"
+
+#include "concurrent_state_registry.h"
+#include "state_registry.h"
+
+#include "task_utils/successor_generator.h"
+#include "utils/logging.h"
+#include "utils/system.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+namespace concurrent_state_registry_benchmark {
+static const size_t MAX_NUM_SAMPLES = 200000;
+
+using Clock = chrono::steady_clock;
+
+static double get_seconds_since(Clock::time_point start) {
+    return chrono::duration<double>(Clock::now() - start).count();
+}
+
+/*
+  Returns the packed data of about MAX_NUM_SAMPLES states, stored
+  consecutively. The states are registered in breadth-first order, so
+  expanding them in the order of their IDs explores the state space
+  breadth-first.
+*/
+static vector<PackedStateBin> sample_states(
+    const TaskProxy &task_proxy, StateRegistry &registry) {
+    const successor_generator::SuccessorGenerator &successor_generator =
+        successor_generator::g_successor_generators[task_proxy];
+    vector<OperatorID> applicable_ops;
+    vector<State> successors;
+
+    registry.get_initial_state();
+    for (StateRegistry::const_iterator it = registry.begin();
+         it != registry.end() && registry.size() < MAX_NUM_SAMPLES; ++it) {
+        State state = registry.lookup_state(*it);
+        applicable_ops.clear();
+        successor_generator.generate_applicable_ops(state, applicable_ops);
+        successors.clear();
+        registry.get_successor_states(state, applicable_ops, successors);
+    }
+
+    int num_bins = registry.get_state_packer().get_num_bins();
+    vector<PackedStateBin> samples;
+    samples.reserve(registry.size() * num_bins);
+    for (StateID id : registry) {
+        const PackedStateBin *buffer = registry.lookup_state(id).get_buffer();
+        samples.insert(samples.end(), buffer, buffer + num_bins);
+    }
+    return samples;
+}
+
+static void report(
+    utils::LogProxy &log, const string &name, int num_threads,
+    size_t num_states, double seconds) {
+    log << name << " with " << num_threads << " thread(s): "
+        << seconds << "s, "
+        << (seconds > 0 ? num_states / seconds / 1e6 : 0)
+        << " million states/s" << endl;
+}
+
+void run_benchmark(
+    const TaskProxy &task_proxy, int max_threads, utils::LogProxy &log) {
+    StateRegistry sample_registry(task_proxy);
+    vector<PackedStateBin> samples = sample_states(task_proxy, sample_registry);
+    int num_bins = sample_registry.get_state_packer().get_num_bins();
+    size_t num_samples = samples.size() / num_bins;
+    log << "Sampled " << num_samples << " states" << endl;
+
+    {
+        StateRegistry registry(task_proxy);
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < num_samples; ++i)
+            registry.register_state(&samples[i * num_bins]);
+        report(log, "StateRegistry insert", 1, num_samples,
+               get_seconds_since(start));
+        start = Clock::now();
+        for (size_t i = 0; i < num_samples; ++i)
+            registry.register_state(&samples[i * num_bins]);
+        report(log, "StateRegistry lookup", 1, num_samples,
+               get_seconds_since(start));
+    }
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        ConcurrentStateRegistry registry(task_proxy);
+        vector<thread> threads;
+        /*
+          Every thread handles a contiguous slice of the samples. In the
+          lookup phase, it reads the data of the states it looked up, so
+          that the lookups cannot be optimized away.
+        */
+        vector<size_t> checksums(num_threads, 0);
+        auto run_phase = [&](bool lookup) {
+            threads.clear();
+            for (int t = 0; t < num_threads; ++t) {
+                threads.emplace_back([&, t, lookup]() {
+                    ConcurrentStateRegistry::Arena arena;
+                    size_t begin = num_samples * t / num_threads;
+                    size_t end = num_samples * (t + 1) / num_threads;
+                    for (size_t i = begin; i < end; ++i) {
+                        StateID id = registry.insert_state(
+                            arena, &samples[i * num_bins]).first;
+                        if (lookup)
+                            checksums[t] += registry.lookup_buffer(id)[0];
+                    }
+                });
+            }
+            for (thread &worker : threads)
+                worker.join();
+        };
+
+        Clock::time_point start = Clock::now();
+        run_phase(false);
+        report(log, "ConcurrentStateRegistry insert", num_threads,
+               num_samples, get_seconds_since(start));
+        start = Clock::now();
+        run_phase(true);
+        report(log, "ConcurrentStateRegistry lookup", num_threads,
+               num_samples, get_seconds_since(start));
+
+        if (registry.size() != num_samples) {
+            cerr << "ConcurrentStateRegistry registered " << registry.size()
+                 << " of " << num_samples << " distinct states." << endl;
+            utils::exit_with(utils::ExitCode::SEARCH_CRITICAL_ERROR);
+        }
+    }
+}
+}
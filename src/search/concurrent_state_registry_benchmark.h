@@ -0,0 +1,23 @@
+#ifndef CONCURRENT_STATE_REGISTRY_BENCHMARK_H
+#define CONCURRENT_STATE_REGISTRY_BENCHMARK_H
+
+class TaskProxy;
+
+namespace utils {
+class LogProxy;
+}
+
+namespace concurrent_state_registry_benchmark {
+/*
+  Measures the throughput of ConcurrentStateRegistry on states of the given
+  task. The states are sampled by a breadth-first exploration from the
+  initial state. They are inserted into a fresh registry by 1, 2, 4, ... up
+  to max_threads threads ("insert"), and then inserted again and looked up
+  ("lookup"). The throughput of StateRegistry on the same states is
+  reported as a single-threaded baseline.
+*/
+extern void run_benchmark(
+    const TaskProxy &task_proxy, int max_threads, utils::LogProxy &log);
+}
+
+#endif
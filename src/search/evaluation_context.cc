@@ -2,6 +2,7 @@
 
 #include "evaluation_result.h"
 #include "evaluator.h"
+#include "search_profiler.h"
 #include "search_statistics.h"
 
 #include <cassert>
@@ -9,10 +10,10 @@
 using namespace std;
 
 EvaluationContext::EvaluationContext(
-    const EvaluatorCache &cache, const State &state, int g_value,
+    EvaluatorCache &&cache, const State &state, int g_value,
     bool is_preferred, SearchStatistics *statistics,
     bool calculate_preferred)
-    : cache(cache),
+    : cache(move(cache)),
       state(state),
       g_value(g_value),
       preferred(is_preferred),
@@ -24,8 +25,8 @@ EvaluationContext::EvaluationContext(
 EvaluationContext::EvaluationContext(
     const EvaluationContext &other, int g_value,
     bool is_preferred, SearchStatistics *statistics, bool calculate_preferred)
-    : EvaluationContext(other.cache, other.state, g_value, is_preferred,
-                        statistics, calculate_preferred) {
+    : EvaluationContext(EvaluatorCache(other.cache), other.state, g_value,
+                        is_preferred, statistics, calculate_preferred) {
 }
 
 EvaluationContext::EvaluationContext(
@@ -45,7 +46,10 @@ EvaluationContext::EvaluationContext(
 const EvaluationResult &EvaluationContext::get_result(Evaluator *evaluator) {
     EvaluationResult &result = cache[evaluator];
     if (result.is_uninitialized()) {
-        result = evaluator->compute_result(*this);
+        ScopedProfileTimer timer(
+            statistics ? &statistics->get_profiler() : nullptr, evaluator);
+        evaluator->compute_result(*this, result);
+        assert(!result.is_uninitialized());
         if (statistics &&
             evaluator->is_used_for_counting_evaluations() &&
             result.get_count_evaluation()) {
@@ -6,8 +6,6 @@
 #include "operator_id.h"
 #include "task_proxy.h"
 
-#include <unordered_map>
-
 class Evaluator;
 class SearchStatistics;
 
@@ -51,15 +49,16 @@ class EvaluationContext {
     static const int INVALID = -1;
 
     EvaluationContext(
-        const EvaluatorCache &cache, const State &state, int g_value,
+        EvaluatorCache &&cache, const State &state, int g_value,
         bool is_preferred, SearchStatistics *statistics,
         bool calculate_preferred);
 public:
     /*
       Copy existing heuristic cache and use it to look up heuristic values.
-      Used for example by lazy search.
+      Used for example by lazy search. The copy reuses pooled memory (see
+      EvaluatorCache), so this does not allocate in steady state.
 
-      TODO: Can we reuse caches? Can we move them instead of copying them?
+      TODO: Can we move caches instead of copying them?
     */
     EvaluationContext(
         const EvaluationContext &other,
@@ -4,7 +4,9 @@ using namespace std;
 
 const int EvaluationResult::INFTY = numeric_limits<int>::max();
 
-EvaluationResult::EvaluationResult() : evaluator_value(UNINITIALIZED) {
+EvaluationResult::EvaluationResult()
+    : evaluator_value(UNINITIALIZED),
+      count_evaluation(false) {
 }
 
 bool EvaluationResult::is_uninitialized() const {
@@ -32,10 +34,16 @@ void EvaluationResult::set_evaluator_value(int value) {
 }
 
 void EvaluationResult::set_preferred_operators(
-    vector<OperatorID> &&preferred_ops) {
-    preferred_operators = move(preferred_ops);
+    const vector<OperatorID> &preferred_ops) {
+    preferred_operators.assign(preferred_ops.begin(), preferred_ops.end());
 }
 
 void EvaluationResult::set_count_evaluation(bool count_eval) {
     count_evaluation = count_eval;
 }
+
+void EvaluationResult::reset() {
+    evaluator_value = UNINITIALIZED;
+    preferred_operators.clear();
+    count_evaluation = false;
+}
@@ -45,8 +45,16 @@ public:
     const std::vector<OperatorID> &get_preferred_operators() const;
 
     void set_evaluator_value(int value);
-    void set_preferred_operators(std::vector<OperatorID> &&preferred_operators);
+    /*
+      Copy the preferred operators into the buffer of this result, which
+      keeps its memory across calls of reset(). This lets evaluation
+      contexts reuse results without allocating.
+    */
+    void set_preferred_operators(const std::vector<OperatorID> &preferred_operators);
     void set_count_evaluation(bool count_eval);
+
+    // Make this result uninitialized again, keeping the allocated memory.
+    void reset();
 };
 
 #endif
@@ -8,6 +8,16 @@
 
 using namespace std;
 
+static int num_cache_slots = 0;
+static vector<int> free_cache_slots;
+
+static int allocate_cache_slot() {
+    if (free_cache_slots.empty())
+        return num_cache_slots++;
+    int slot = free_cache_slots.back();
+    free_cache_slots.pop_back();
+    return slot;
+}
 
 Evaluator::Evaluator(const plugins::Options &opts,
                      bool use_for_reporting_minima,
@@ -17,9 +27,14 @@ Evaluator::Evaluator(const plugins::Options &opts,
       use_for_reporting_minima(use_for_reporting_minima),
       use_for_boosting(use_for_boosting),
       use_for_counting_evaluations(use_for_counting_evaluations),
+      cache_slot(allocate_cache_slot()),
       log(utils::get_log_from_options(opts)) {
 }
 
+Evaluator::~Evaluator() {
+    free_cache_slots.push_back(cache_slot);
+}
+
 bool Evaluator::dead_ends_are_reliable() const {
     return true;
 }
@@ -62,6 +77,14 @@ bool Evaluator::is_used_for_counting_evaluations() const {
     return use_for_counting_evaluations;
 }
 
+int Evaluator::get_cache_slot() const {
+    return cache_slot;
+}
+
+int Evaluator::get_num_cache_slots() {
+    return num_cache_slots;
+}
+
 bool Evaluator::does_cache_estimates() const {
     return false;
 }
@@ -6,6 +6,7 @@
 #include "utils/logging.h"
 
 #include <set>
+#include <vector>
 
 class EvaluationContext;
 class State;
@@ -19,6 +20,8 @@ class Evaluator {
     const bool use_for_reporting_minima;
     const bool use_for_boosting;
     const bool use_for_counting_evaluations;
+    // Index of the entry for this evaluator in an EvaluatorCache.
+    const int cache_slot;
 protected:
     mutable utils::LogProxy log;
 public:
@@ -27,7 +30,9 @@ public:
         bool use_for_reporting_minima = false,
         bool use_for_boosting = false,
         bool use_for_counting_evaluations = false);
-    virtual ~Evaluator() = default;
+    virtual ~Evaluator();
+    Evaluator(const Evaluator &) = delete;
+    Evaluator &operator=(const Evaluator &) = delete;
 
     /*
       dead_ends_are_reliable should return true if the evaluator is
@@ -60,10 +65,24 @@ public:
         const State & /*state*/) {
     }
 
+    /*
+      evaluate_batch may compute the estimates of several states at once
+      and cache them, so that evaluating these states later is cheap. It
+      returns the number of states for which estimates were computed.
+      Search algorithms call it for states that they are about to
+      evaluate one after the other; the states should be distinct. The
+      default implementation does nothing.
+    */
+    virtual int evaluate_batch(const std::vector<State> & /*states*/) {
+        return 0;
+    }
+
     /*
       compute_result should compute the estimate and possibly
-      preferred operators for the given evaluation context and return
-      them as an EvaluationResult instance.
+      preferred operators for the given evaluation context and store
+      them in the given result, which is uninitialized when passed in.
+      The result is owned by the evaluation context and reused across
+      evaluations, so filling it does not need to allocate memory.
 
       It should not add the result to the evaluation context -- this
       is done automatically elsewhere.
@@ -80,8 +99,8 @@ public:
       EvaluationContext. We need to think of a clean way to achieve
       this.
     */
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) = 0;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) = 0;
 
     void report_value_for_initial_state(const EvaluationResult &result) const;
     void report_new_minimum_value(const EvaluationResult &result) const;
@@ -91,6 +110,14 @@ public:
     bool is_used_for_boosting() const;
     bool is_used_for_counting_evaluations() const;
 
+    /*
+      Cache slots are small indices that are unique among all existing
+      evaluators. Slots of destroyed evaluators are reused, so all slots
+      are smaller than get_num_cache_slots().
+    */
+    int get_cache_slot() const;
+    static int get_num_cache_slots();
+
     virtual bool does_cache_estimates() const;
     virtual bool is_estimate_cached(const State &state) const;
     /*
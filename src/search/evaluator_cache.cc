@@ -1,8 +1,99 @@
 #include "evaluator_cache.h"
 
+#include "evaluator.h"
+
+#include <cassert>
+
 using namespace std;
 
+vector<EvaluatorCache::Buffers> &EvaluatorCache::get_pool() {
+    // One pool per thread, so that parallel searches need no locking.
+    thread_local vector<Buffers> pool;
+    return pool;
+}
+
+void EvaluatorCache::acquire_buffers() {
+    vector<Buffers> &pool = get_pool();
+    if (!pool.empty()) {
+        buffers = move(pool.back());
+        pool.pop_back();
+    }
+    assert(buffers.used_slots.empty());
+}
+
+void EvaluatorCache::release_buffers() {
+    // Moved-from caches have no memory worth keeping.
+    if (buffers.entries.empty())
+        return;
+    for (int slot : buffers.used_slots) {
+        Entry &entry = buffers.entries[slot];
+        entry.evaluator = nullptr;
+        entry.result.reset();
+    }
+    buffers.used_slots.clear();
+    get_pool().push_back(move(buffers));
+    buffers.entries.clear();
+}
+
+void EvaluatorCache::copy_results(const EvaluatorCache &other) {
+    assert(buffers.used_slots.empty());
+    if (buffers.entries.size() < other.buffers.entries.size())
+        buffers.entries.resize(other.buffers.entries.size());
+    for (int slot : other.buffers.used_slots) {
+        buffers.entries[slot] = other.buffers.entries[slot];
+        buffers.used_slots.push_back(slot);
+    }
+}
+
+EvaluatorCache::EvaluatorCache() {
+    acquire_buffers();
+}
+
+EvaluatorCache::EvaluatorCache(const EvaluatorCache &other) {
+    acquire_buffers();
+    copy_results(other);
+}
+
+EvaluatorCache::EvaluatorCache(EvaluatorCache &&other)
+    : buffers(move(other.buffers)) {
+    other.buffers.entries.clear();
+    other.buffers.used_slots.clear();
+}
+
+EvaluatorCache::~EvaluatorCache() {
+    release_buffers();
+}
+
+EvaluatorCache &EvaluatorCache::operator=(const EvaluatorCache &other) {
+    if (this != &other) {
+        release_buffers();
+        acquire_buffers();
+        copy_results(other);
+    }
+    return *this;
+}
+
+EvaluatorCache &EvaluatorCache::operator=(EvaluatorCache &&other) {
+    // Our old buffers go back to the pool when other is destroyed.
+    swap(buffers, other.buffers);
+    return *this;
+}
 
 EvaluationResult &EvaluatorCache::operator[](Evaluator *eval) {
-    return eval_results[eval];
+    int slot = eval->get_cache_slot();
+    if (slot >= static_cast<int>(buffers.entries.size())) {
+        /*
+          Make room for all existing evaluators at once, so that computing
+          the result of an evaluator does not move the entries of the
+          cache by accessing its subevaluators.
+        */
+        buffers.entries.resize(Evaluator::get_num_cache_slots());
+    }
+    Entry &entry = buffers.entries[slot];
+    if (!entry.evaluator) {
+        entry.evaluator = eval;
+        buffers.used_slots.push_back(slot);
+    }
+    assert(entry.evaluator == eval);
+    return entry.result;
 }
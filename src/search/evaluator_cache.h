@@ -3,26 +3,60 @@
 
 #include "evaluation_result.h"
 
-#include <unordered_map>
+#include <vector>
 
 class Evaluator;
 
-using EvaluationResults = std::unordered_map<Evaluator *, EvaluationResult>;
-
 /*
   Store evaluation results for evaluators.
+
+  Results are stored in a flat vector indexed by the cache slots of the
+  evaluators (see Evaluator::get_cache_slot()). The vectors of a cache
+  are taken from a pool when it is created and returned to the pool,
+  together with the memory of the preferred operators of its results,
+  when it is destroyed. Every thread has its own pool. Creating, copying
+  and filling caches therefore does not allocate memory once the search
+  has reached a steady state.
+
+  References returned by operator[] stay valid until the cache is
+  destroyed or reassigned, as long as no new evaluators are created in
+  the meantime.
 */
 class EvaluatorCache {
-    EvaluationResults eval_results;
+    struct Entry {
+        Evaluator *evaluator = nullptr;
+        EvaluationResult result;
+    };
+
+    struct Buffers {
+        std::vector<Entry> entries;
+        // Slots of the entries in use, in order of first access.
+        std::vector<int> used_slots;
+    };
+
+    Buffers buffers;
+
+    static std::vector<Buffers> &get_pool();
+    void acquire_buffers();
+    void release_buffers();
+    void copy_results(const EvaluatorCache &other);
 
 public:
+    EvaluatorCache();
+    EvaluatorCache(const EvaluatorCache &other);
+    EvaluatorCache(EvaluatorCache &&other);
+    ~EvaluatorCache();
+    EvaluatorCache &operator=(const EvaluatorCache &other);
+    EvaluatorCache &operator=(EvaluatorCache &&other);
+
     EvaluationResult &operator[](Evaluator *eval);
 
     template<class Callback>
     void for_each_evaluator_result(const Callback &callback) const {
-        for (const auto &element : eval_results) {
-            const Evaluator *eval = element.first;
-            const EvaluationResult &result = element.second;
+        for (int slot : buffers.used_slots) {
+            const Entry &entry = buffers.entries[slot];
+            const Evaluator *eval = entry.evaluator;
+            const EvaluationResult &result = entry.result;
             callback(eval, result);
         }
     }
@@ -15,6 +15,7 @@ CombiningEvaluator::CombiningEvaluator(const plugins::Options &opts)
     for (const shared_ptr<Evaluator> &subevaluator : subevaluators)
         if (!subevaluator->dead_ends_are_reliable())
             all_dead_ends_are_reliable = false;
+    values.reserve(subevaluators.size());
 }
 
 CombiningEvaluator::~CombiningEvaluator() {
@@ -24,19 +25,17 @@ bool CombiningEvaluator::dead_ends_are_reliable() const {
     return all_dead_ends_are_reliable;
 }
 
-EvaluationResult CombiningEvaluator::compute_result(
-    EvaluationContext &eval_context) {
+void CombiningEvaluator::compute_result(
+    EvaluationContext &eval_context, EvaluationResult &result) {
     // This marks no preferred operators.
-    EvaluationResult result;
-    vector<int> values;
-    values.reserve(subevaluators.size());
+    values.clear();
 
     // Collect component values. Return infinity if any is infinite.
     for (const shared_ptr<Evaluator> &subevaluator : subevaluators) {
         int value = eval_context.get_evaluator_value_or_infinity(subevaluator.get());
         if (value == EvaluationResult::INFTY) {
             result.set_evaluator_value(value);
-            return result;
+            return;
         } else {
             values.push_back(value);
         }
@@ -44,7 +43,6 @@ EvaluationResult CombiningEvaluator::compute_result(
 
     // If we arrived here, all subevaluator values are finite.
     result.set_evaluator_value(combine_values(values));
-    return result;
 }
 
 void CombiningEvaluator::get_path_dependent_evaluators(
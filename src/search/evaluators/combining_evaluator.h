@@ -16,6 +16,8 @@ namespace combining_evaluator {
 class CombiningEvaluator : public Evaluator {
     std::vector<std::shared_ptr<Evaluator>> subevaluators;
     bool all_dead_ends_are_reliable;
+    // Component values of the current evaluation, reused across calls.
+    std::vector<int> values;
 protected:
     virtual int combine_values(const std::vector<int> &values) = 0;
 public:
@@ -36,8 +38,8 @@ public:
     */
 
     virtual bool dead_ends_are_reliable() const override;
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
 
     virtual void get_path_dependent_evaluators(
         std::set<Evaluator *> &evals) override;
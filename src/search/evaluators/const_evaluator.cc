@@ -9,10 +9,9 @@ ConstEvaluator::ConstEvaluator(const plugins::Options &opts)
     : Evaluator(opts), value(opts.get<int>("value")) {
 }
 
-EvaluationResult ConstEvaluator::compute_result(EvaluationContext &) {
-    EvaluationResult result;
+void ConstEvaluator::compute_result(
+    EvaluationContext &, EvaluationResult &result) {
     result.set_evaluator_value(value);
-    return result;
 }
 
 class ConstEvaluatorFeature : public plugins::TypedFeature<Evaluator, ConstEvaluator> {
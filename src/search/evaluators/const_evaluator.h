@@ -12,8 +12,8 @@ class ConstEvaluator : public Evaluator {
     int value;
 
 protected:
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
 
 public:
     explicit ConstEvaluator(const plugins::Options &opts);
@@ -11,10 +11,9 @@ GEvaluator::GEvaluator(const plugins::Options &opts)
     : Evaluator(opts) {
 }
 
-EvaluationResult GEvaluator::compute_result(EvaluationContext &eval_context) {
-    EvaluationResult result;
+void GEvaluator::compute_result(
+    EvaluationContext &eval_context, EvaluationResult &result) {
     result.set_evaluator_value(eval_context.get_g_value());
-    return result;
 }
 
 class GEvaluatorFeature : public plugins::TypedFeature<Evaluator, GEvaluator> {
@@ -9,8 +9,8 @@ public:
     explicit GEvaluator(const plugins::Options &opts);
     virtual ~GEvaluator() override = default;
 
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
 
     virtual void get_path_dependent_evaluators(std::set<Evaluator *> &) override {}
 };
@@ -14,14 +14,12 @@ PrefEvaluator::PrefEvaluator(const plugins::Options &opts)
 PrefEvaluator::~PrefEvaluator() {
 }
 
-EvaluationResult PrefEvaluator::compute_result(
-    EvaluationContext &eval_context) {
-    EvaluationResult result;
+void PrefEvaluator::compute_result(
+    EvaluationContext &eval_context, EvaluationResult &result) {
     if (eval_context.is_preferred())
         result.set_evaluator_value(0);
     else
         result.set_evaluator_value(1);
-    return result;
 }
 
 class PrefEvaluatorFeature : public plugins::TypedFeature<Evaluator, PrefEvaluator> {
@@ -12,8 +12,8 @@ public:
     explicit PrefEvaluator(const plugins::Options &opts);
     virtual ~PrefEvaluator() override;
 
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
     virtual void get_path_dependent_evaluators(std::set<Evaluator *> &) override {}
 };
 }
@@ -23,17 +23,15 @@ bool WeightedEvaluator::dead_ends_are_reliable() const {
     return evaluator->dead_ends_are_reliable();
 }
 
-EvaluationResult WeightedEvaluator::compute_result(
-    EvaluationContext &eval_context) {
+void WeightedEvaluator::compute_result(
+    EvaluationContext &eval_context, EvaluationResult &result) {
     // Note that this produces no preferred operators.
-    EvaluationResult result;
     int value = eval_context.get_evaluator_value_or_infinity(evaluator.get());
     if (value != EvaluationResult::INFTY) {
         // TODO: Check for overflow?
         value *= w;
     }
     result.set_evaluator_value(value);
-    return result;
 }
 
 void WeightedEvaluator::get_path_dependent_evaluators(set<Evaluator *> &evals) {
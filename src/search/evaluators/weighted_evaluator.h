@@ -19,8 +19,8 @@ public:
     virtual ~WeightedEvaluator() override;
 
     virtual bool dead_ends_are_reliable() const override;
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
     virtual void get_path_dependent_evaluators(std::set<Evaluator *> &evals) override;
 };
 }
@@ -33,6 +33,15 @@ State Heuristic::convert_ancestor_state(const State &ancestor_state) const {
     return task_proxy.convert_ancestor_state(ancestor_state);
 }
 
+void Heuristic::compute_heuristics(
+    const vector<State> &ancestor_states, vector<int> &values) {
+    values.clear();
+    for (const State &state : ancestor_states) {
+        values.push_back(compute_heuristic(state));
+        preferred_operators.clear();
+    }
+}
+
 void Heuristic::add_options_to_feature(plugins::Feature &feature) {
     add_evaluator_options_to_feature(feature);
     feature.add_option<shared_ptr<AbstractTask>>(
@@ -43,9 +52,8 @@ void Heuristic::add_options_to_feature(plugins::Feature &feature) {
     feature.add_option<bool>("cache_estimates", "cache heuristic estimates", "true");
 }
 
-EvaluationResult Heuristic::compute_result(EvaluationContext &eval_context) {
-    EvaluationResult result;
-
+void Heuristic::compute_result(
+    EvaluationContext &eval_context, EvaluationResult &result) {
     assert(preferred_operators.empty());
 
     const State &state = eval_context.get_state();
@@ -89,10 +97,30 @@ EvaluationResult Heuristic::compute_result(EvaluationContext &eval_context) {
 #endif
 
     result.set_evaluator_value(heuristic);
-    result.set_preferred_operators(preferred_operators.pop_as_vector());
-    assert(preferred_operators.empty());
+    result.set_preferred_operators(preferred_operators.get_as_vector());
+    preferred_operators.clear();
+}
 
-    return result;
+int Heuristic::evaluate_batch(const vector<State> &states) {
+    if (!cache_evaluator_values)
+        return 0;
+    batch_states.clear();
+    for (const State &state : states) {
+        HEntry &entry = heuristic_cache[state];
+        if (entry.h == NO_VALUE || entry.dirty) {
+            entry = HEntry(BATCH_PENDING, false);
+            batch_states.push_back(state);
+        }
+    }
+    if (batch_states.empty())
+        return 0;
+    compute_heuristics(batch_states, batch_values);
+    assert(batch_values.size() == batch_states.size());
+    for (size_t i = 0; i < batch_states.size(); ++i) {
+        assert(batch_values[i] == DEAD_END || batch_values[i] >= 0);
+        heuristic_cache[batch_states[i]] = HEntry(batch_values[i], false);
+    }
+    return batch_states.size();
 }
 
 bool Heuristic::does_cache_estimates() const {
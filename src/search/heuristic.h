@@ -44,6 +44,15 @@ class Heuristic : public Evaluator {
     */
     ordered_set::OrderedSet<OperatorID> preferred_operators;
 
+    // Buffers for evaluate_batch.
+    std::vector<State> batch_states;
+    /*
+      Value of the cache entries of the states in batch_states until their
+      values are computed, so that duplicates are only queued once.
+    */
+    static const int BATCH_PENDING = -3;
+    std::vector<int> batch_values;
+
 protected:
     /*
       Cache for saving h values
@@ -63,6 +72,15 @@ protected:
 
     virtual int compute_heuristic(const State &ancestor_state) = 0;
 
+    /*
+      Compute the heuristic values of several states and store them in
+      values. The default implementation calls compute_heuristic for each
+      state and discards preferred operators. Heuristics that can share
+      work between states override this.
+    */
+    virtual void compute_heuristics(
+        const std::vector<State> &ancestor_states, std::vector<int> &values);
+
     /*
       Usage note: Marking the same operator as preferred multiple times
       is OK -- it will only appear once in the list of preferred
@@ -82,8 +100,14 @@ public:
 
     static void add_options_to_feature(plugins::Feature &feature);
 
-    virtual EvaluationResult compute_result(
-        EvaluationContext &eval_context) override;
+    virtual void compute_result(
+        EvaluationContext &eval_context, EvaluationResult &result) override;
+
+    /*
+      Compute and cache the estimates of all given states that are not
+      cached yet. This has no effect if estimates are not cached.
+    */
+    virtual int evaluate_batch(const std::vector<State> &states) override;
 
     virtual bool does_cache_estimates() const override;
     virtual bool is_estimate_cached(const State &state) const override;
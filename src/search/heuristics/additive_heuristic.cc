@@ -16,10 +16,28 @@ const int AdditiveHeuristic::MAX_COST_VALUE;
 // construction and destruction
 AdditiveHeuristic::AdditiveHeuristic(const plugins::Options &opts)
     : RelaxationHeuristic(opts),
-      did_write_overflow_warning(false) {
+      did_write_overflow_warning(false),
+      incremental(opts.get<bool>("incremental")) {
     if (log.is_at_least_normal()) {
         log << "Initializing additive heuristic..." << endl;
     }
+    if (incremental) {
+        build_achievers();
+        affected.resize(propositions.size(), false);
+    }
+}
+
+void AdditiveHeuristic::add_options_to_feature(plugins::Feature &feature) {
+    Heuristic::add_options_to_feature(feature);
+    feature.add_option<bool>(
+        "incremental",
+        "compute the heuristic incrementally: keep the costs of the "
+        "previously evaluated state (usually the parent or a sibling) and "
+        "only recompute the costs of propositions that depend on facts in "
+        "which the new state differs. The h^add values do not change, but "
+        "ties between best supporters may be broken differently, which can "
+        "change relaxed plans and preferred operators.",
+        "false");
 }
 
 void AdditiveHeuristic::write_overflow_warning() {
@@ -62,7 +80,7 @@ void AdditiveHeuristic::setup_exploration_queue_state(const State &state) {
     }
 }
 
-void AdditiveHeuristic::relaxed_exploration() {
+void AdditiveHeuristic::relaxed_exploration(bool stop_at_goals) {
     int unsolved_goals = goal_propositions.size();
     while (!queue.empty()) {
         pair<int, PropID> top_pair = queue.pop();
@@ -74,7 +92,7 @@ void AdditiveHeuristic::relaxed_exploration() {
         assert(prop_cost <= distance);
         if (prop_cost < distance)
             continue;
-        if (prop->is_goal && --unsolved_goals == 0)
+        if (stop_at_goals && prop->is_goal && --unsolved_goals == 0)
             return;
         for (OpID op_id : precondition_of_pool.get_slice(
                  prop->precondition_of, prop->num_precondition_occurences)) {
@@ -115,10 +133,165 @@ void AdditiveHeuristic::mark_preferred_operators(
     }
 }
 
+void AdditiveHeuristic::build_achievers() {
+    int num_propositions = propositions.size();
+    achiever_offsets.assign(num_propositions + 1, 0);
+    for (const UnaryOperator &op : unary_operators)
+        ++achiever_offsets[op.effect + 1];
+    for (PropID prop_id = 0; prop_id < num_propositions; ++prop_id)
+        achiever_offsets[prop_id + 1] += achiever_offsets[prop_id];
+    achievers.resize(unary_operators.size());
+    vector<int> next_position(achiever_offsets.begin(), achiever_offsets.end() - 1);
+    int num_unary_ops = unary_operators.size();
+    for (OpID op_id = 0; op_id < num_unary_ops; ++op_id)
+        achievers[next_position[unary_operators[op_id].effect]++] = op_id;
+}
+
+int AdditiveHeuristic::compute_operator_cost(const UnaryOperator &op) {
+    int cost = op.base_cost;
+    for (PropID precond : get_preconditions(get_op_id(op))) {
+        int precond_cost = get_proposition(precond)->cost;
+        if (precond_cost == -1 || affected[precond])
+            return -1;
+        increase_cost(cost, precond_cost);
+    }
+    return cost;
+}
+
+void AdditiveHeuristic::enqueue_if_cheaper(PropID prop_id, int cost, OpID op_id) {
+    Proposition *prop = get_proposition(prop_id);
+    if (cost != -1 && (prop->cost == -1 || cost < prop->cost)) {
+        prop->cost = cost;
+        prop->reached_by = op_id;
+        queue.push(cost, prop_id);
+    }
+}
+
+/*
+  Recompute the costs of the propositions whose best supporters depend on
+  facts that are not true anymore. These propositions are "affected".
+  We reset them and recompute their costs with a Dijkstra-style
+  exploration that starts from their best achievers whose preconditions
+  are not affected. The costs of propositions that are not affected cannot
+  decrease by removing facts, so they are left alone.
+*/
+void AdditiveHeuristic::increase_costs(const vector<int> &values) {
+    affected_props.clear();
+    for (size_t var = 0; var < values.size(); ++var) {
+        if (values[var] != previous_state_values[var]) {
+            PropID prop_id = get_prop_id(var, previous_state_values[var]);
+            affected[prop_id] = true;
+            affected_props.push_back(prop_id);
+        }
+    }
+    // Collect the propositions that are (transitively) supported by them.
+    for (size_t i = 0; i < affected_props.size(); ++i) {
+        const Proposition *prop = get_proposition(affected_props[i]);
+        for (OpID op_id : precondition_of_pool.get_slice(
+                 prop->precondition_of, prop->num_precondition_occurences)) {
+            PropID effect_id = get_operator(op_id)->effect;
+            if (get_proposition(effect_id)->reached_by == op_id &&
+                !affected[effect_id]) {
+                affected[effect_id] = true;
+                affected_props.push_back(effect_id);
+            }
+        }
+    }
+
+    for (PropID prop_id : affected_props) {
+        Proposition *prop = get_proposition(prop_id);
+        prop->cost = -1;
+        prop->reached_by = NO_OP;
+    }
+    queue.clear();
+    for (PropID prop_id : affected_props) {
+        for (int i = achiever_offsets[prop_id]; i < achiever_offsets[prop_id + 1]; ++i) {
+            OpID op_id = achievers[i];
+            enqueue_if_cheaper(
+                prop_id, compute_operator_cost(*get_operator(op_id)), op_id);
+        }
+    }
+
+    while (!queue.empty()) {
+        pair<int, PropID> top_pair = queue.pop();
+        int distance = top_pair.first;
+        PropID prop_id = top_pair.second;
+        Proposition *prop = get_proposition(prop_id);
+        if (prop->cost < distance || !affected[prop_id])
+            continue;
+        affected[prop_id] = false;
+        for (OpID op_id : precondition_of_pool.get_slice(
+                 prop->precondition_of, prop->num_precondition_occurences)) {
+            const UnaryOperator *unary_op = get_operator(op_id);
+            if (affected[unary_op->effect]) {
+                enqueue_if_cheaper(
+                    unary_op->effect, compute_operator_cost(*unary_op), op_id);
+            }
+        }
+    }
+    // Unreachable propositions stay affected until here.
+    for (PropID prop_id : affected_props)
+        affected[prop_id] = false;
+}
+
+/*
+  Propagate the cost decreases caused by facts that became true.
+  Propositions are only updated if their cost strictly decreases, so the
+  best supporters stay acyclic.
+*/
+void AdditiveHeuristic::decrease_costs(const vector<int> &values) {
+    queue.clear();
+    for (size_t var = 0; var < values.size(); ++var) {
+        if (values[var] != previous_state_values[var]) {
+            PropID prop_id = get_prop_id(var, values[var]);
+            Proposition *prop = get_proposition(prop_id);
+            prop->reached_by = NO_OP;
+            if (prop->cost != 0) {
+                prop->cost = 0;
+                queue.push(0, prop_id);
+            }
+        }
+    }
+
+    while (!queue.empty()) {
+        pair<int, PropID> top_pair = queue.pop();
+        int distance = top_pair.first;
+        PropID prop_id = top_pair.second;
+        Proposition *prop = get_proposition(prop_id);
+        if (prop->cost < distance)
+            continue;
+        for (OpID op_id : precondition_of_pool.get_slice(
+                 prop->precondition_of, prop->num_precondition_occurences)) {
+            const UnaryOperator *unary_op = get_operator(op_id);
+            enqueue_if_cheaper(
+                unary_op->effect, compute_operator_cost(*unary_op), op_id);
+        }
+    }
+}
+
+void AdditiveHeuristic::update_exploration(const State &state) {
+    const vector<int> &values = state.get_unpacked_values();
+    if (previous_state_values.empty()) {
+        setup_exploration_queue();
+        setup_exploration_queue_state(state);
+        relaxed_exploration(false);
+    } else {
+        for (Proposition &prop : propositions)
+            prop.marked = false;
+        increase_costs(values);
+        decrease_costs(values);
+    }
+    previous_state_values = values;
+}
+
 int AdditiveHeuristic::compute_add_and_ff(const State &state) {
-    setup_exploration_queue();
-    setup_exploration_queue_state(state);
-    relaxed_exploration();
+    if (incremental) {
+        update_exploration(state);
+    } else {
+        setup_exploration_queue();
+        setup_exploration_queue_state(state);
+        relaxed_exploration(true);
+    }
 
     int total_cost = 0;
     for (PropID goal_id : goal_propositions) {
@@ -141,6 +314,11 @@ int AdditiveHeuristic::compute_heuristic(const State &ancestor_state) {
     return h;
 }
 
+void AdditiveHeuristic::compute_heuristics(
+    const vector<State> &ancestor_states, vector<int> &values) {
+    compute_batch_values(ancestor_states, values, true, MAX_COST_VALUE);
+}
+
 void AdditiveHeuristic::compute_heuristic_for_cegar(const State &state) {
     compute_heuristic(state);
 }
@@ -150,7 +328,7 @@ public:
     AdditiveHeuristicFeature() : TypedFeature("add") {
         document_title("Additive heuristic");
 
-        Heuristic::add_options_to_feature(*this);
+        AdditiveHeuristic::add_options_to_feature(*this);
 
         document_language_support("action costs", "supported");
         document_language_support("conditional effects", "supported");
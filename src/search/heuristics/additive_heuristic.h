@@ -7,6 +7,7 @@
 #include "../utils/collections.h"
 
 #include <cassert>
+#include <vector>
 
 class State;
 
@@ -32,9 +33,36 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
     priority_queues::AdaptiveQueue<PropID> queue;
     bool did_write_overflow_warning;
 
+    /*
+      In incremental mode, the proposition costs and best supporters
+      (reached_by) of the previously evaluated state are kept, and only
+      the propositions affected by the facts in which the new state
+      differs are recomputed. For this, all reachable propositions are
+      explored, not only those up to the last goal.
+    */
+    const bool incremental;
+    // Values of the state whose costs are stored (empty if none).
+    std::vector<int> previous_state_values;
+    // achievers[achiever_offsets[p]...achiever_offsets[p+1]-1] achieve p.
+    std::vector<int> achiever_offsets;
+    std::vector<OpID> achievers;
+    std::vector<bool> affected;
+    std::vector<PropID> affected_props;
+
     void setup_exploration_queue();
     void setup_exploration_queue_state(const State &state);
-    void relaxed_exploration();
+    void relaxed_exploration(bool stop_at_goals);
+
+    void build_achievers();
+    /*
+      Return the cost of the operator given the current costs of its
+      preconditions, or -1 if one of them is unreachable or affected.
+    */
+    int compute_operator_cost(const UnaryOperator &op);
+    void enqueue_if_cheaper(PropID prop_id, int cost, OpID op_id);
+    void increase_costs(const std::vector<int> &values);
+    void decrease_costs(const std::vector<int> &values);
+    void update_exploration(const State &state);
     void mark_preferred_operators(const State &state, PropID goal_id);
 
     void enqueue_if_necessary(PropID prop_id, int cost, OpID op_id) {
@@ -61,12 +89,17 @@ class AdditiveHeuristic : public relaxation_heuristic::RelaxationHeuristic {
     void write_overflow_warning();
 protected:
     virtual int compute_heuristic(const State &ancestor_state) override;
+    virtual void compute_heuristics(
+        const std::vector<State> &ancestor_states,
+        std::vector<int> &values) override;
 
     // Common part of h^add and h^ff computation.
     int compute_add_and_ff(const State &state);
 public:
     explicit AdditiveHeuristic(const plugins::Options &opts);
 
+    static void add_options_to_feature(plugins::Feature &feature);
+
     /*
       TODO: The two methods below are temporarily needed for the CEGAR
       heuristic. In the long run it might be better to split the
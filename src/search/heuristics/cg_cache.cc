@@ -1,29 +1,101 @@
 #include "cg_cache.h"
 
+#include "../abstract_task.h"
 #include "../task_proxy.h"
 
 #include "../task_utils/causal_graph.h"
-#include "../utils/collections.h"
+#include "../utils/hash.h"
 #include "../utils/logging.h"
 #include "../utils/math.h"
+#include "../utils/system.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <sstream>
 #include <vector>
 
 using namespace std;
 
 namespace cg_heuristic {
+string g_cg_cache_directory;
+
+const int CGCache::PAGE_SIZE;
+const int CGCache::NO_PAGE;
 const int CGCache::NOT_COMPUTED;
+const int CGCache::NO_TRANSITION;
+
+// Bump whenever the layout of the cache files changes.
+static const int32_t FORMAT_VERSION = 1;
+static const char MAGIC[4] = {'C', 'G', 'C', 'C'};
+
+static void write_int(ostream &out, int32_t value) {
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static bool read_int(istream &in, int32_t &value) {
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+}
+
+static void feed_facts(utils::HashState &hash_state, const ConditionsProxy &facts) {
+    utils::feed(hash_state, static_cast<int>(facts.size()));
+    for (FactProxy fact : facts)
+        utils::feed(hash_state, fact.get_pair());
+}
+
+template<typename OperatorsOrAxioms>
+static void feed_operators(utils::HashState &hash_state, const OperatorsOrAxioms &ops) {
+    utils::feed(hash_state, static_cast<int>(ops.size()));
+    for (OperatorProxy op : ops) {
+        utils::feed(hash_state, op.get_cost());
+        feed_facts(hash_state, op.get_preconditions());
+        EffectsProxy effects = op.get_effects();
+        utils::feed(hash_state, static_cast<int>(effects.size()));
+        for (EffectProxy eff : effects) {
+            feed_facts(hash_state, eff.get_conditions());
+            utils::feed(hash_state, eff.get_fact().get_pair());
+        }
+    }
+}
+
+static uint64_t compute_task_hash(const TaskProxy &task_proxy, int max_cache_size) {
+    /*
+      The cached costs depend on the domains of the variables and on the
+      operators and axioms (including their costs), but not on the
+      initial state and the goals.
+    */
+    utils::HashState hash_state;
+    utils::feed(hash_state, max_cache_size);
+    VariablesProxy variables = task_proxy.get_variables();
+    utils::feed(hash_state, static_cast<int>(variables.size()));
+    for (VariableProxy var : variables)
+        utils::feed(hash_state, var.get_domain_size());
+    feed_operators(hash_state, task_proxy.get_operators());
+    feed_operators(hash_state, task_proxy.get_axioms());
+    return hash_state.get_hash64();
+}
 
-CGCache::CGCache(const TaskProxy &task_proxy, int max_cache_size, utils::LogProxy &log)
-    : task_proxy(task_proxy) {
+CGCache::CGCache(const TaskProxy &task_proxy, const vector<int> &num_labels,
+                 int max_cache_size, int max_memory, utils::LogProxy &log)
+    : num_labels(num_labels),
+      max_pages(numeric_limits<int>::max()),
+      clock_hand(0),
+      num_evictions(0),
+      task_hash(0) {
     if (log.is_at_least_normal()) {
         log << "Initializing heuristic cache... " << flush;
     }
 
     int var_count = task_proxy.get_variables().size();
+    domain_sizes.reserve(var_count);
+    for (VariableProxy var : task_proxy.get_variables())
+        domain_sizes.push_back(var.get_domain_size());
     const causal_graph::CausalGraph &cg = task_proxy.get_causal_graph();
 
     // Compute inverted causal graph.
@@ -54,26 +126,80 @@ CGCache::CGCache(const TaskProxy &task_proxy, int max_cache_size, utils::LogProx
                               depends_on[var].end());
     }
 
-    cache.resize(var_count);
-    helpful_transition_cache.resize(var_count);
+    cache_sizes.resize(var_count, 0);
+    page_indices.resize(var_count);
 
     for (int var = 0; var < var_count; ++var) {
         int required_cache_size = compute_required_cache_size(
             var, depends_on[var], max_cache_size);
         if (required_cache_size != -1) {
-            cache[var].resize(required_cache_size, NOT_COMPUTED);
-            helpful_transition_cache[var].resize(required_cache_size, nullptr);
+            cache_sizes[var] = required_cache_size;
+            int num_pages = (required_cache_size + PAGE_SIZE - 1) / PAGE_SIZE;
+            page_indices[var].resize(num_pages, NO_PAGE);
         }
     }
 
+    if (max_memory > 0) {
+        // Each entry stores a cost and a helpful transition.
+        int64_t page_bytes = PAGE_SIZE * 2 * sizeof(int);
+        int64_t max_memory_bytes = static_cast<int64_t>(max_memory) << 20;
+        max_pages = max<int64_t>(
+            1, min<int64_t>(max_memory_bytes / page_bytes,
+                            numeric_limits<int>::max() / PAGE_SIZE));
+        costs.reserve(static_cast<size_t>(max_pages) * PAGE_SIZE);
+        helpful_transitions.reserve(static_cast<size_t>(max_pages) * PAGE_SIZE);
+    }
+
     if (log.is_at_least_normal()) {
         log << "done!" << endl;
     }
+
+    if (!g_cg_cache_directory.empty()) {
+        task_hash = compute_task_hash(task_proxy, max_cache_size);
+        ostringstream file_name;
+        file_name << hex << setw(16) << setfill('0') << task_hash << ".cgcache";
+        snapshot_path = g_cg_cache_directory;
+        if (snapshot_path.back() != '/')
+            snapshot_path += '/';
+        snapshot_path += file_name.str();
+        if (load(log) && log.is_at_least_normal()) {
+            log << "Loaded " << pages.size() << " pages of the heuristic cache from "
+                << snapshot_path << endl;
+        }
+    }
 }
 
 CGCache::~CGCache() {
 }
 
+shared_ptr<CGCache> CGCache::get_shared_cache(
+    const shared_ptr<AbstractTask> &task, const vector<int> &num_labels,
+    int max_cache_size, int max_memory, utils::LogProxy &log) {
+    struct SharedCache {
+        // Keeps the task alive, so its address cannot be reused.
+        shared_ptr<AbstractTask> task;
+        int max_cache_size;
+        int max_memory;
+        shared_ptr<CGCache> cache;
+    };
+    static vector<SharedCache> shared_caches;
+
+    for (const SharedCache &shared_cache : shared_caches) {
+        if (shared_cache.task == task &&
+            shared_cache.max_cache_size == max_cache_size &&
+            shared_cache.max_memory == max_memory) {
+            if (log.is_at_least_normal()) {
+                log << "Using shared heuristic cache." << endl;
+            }
+            return shared_cache.cache;
+        }
+    }
+    shared_ptr<CGCache> cache = make_shared<CGCache>(
+        TaskProxy(*task), num_labels, max_cache_size, max_memory, log);
+    shared_caches.push_back({task, max_cache_size, max_memory, cache});
+    return cache;
+}
+
 int CGCache::compute_required_cache_size(
     int var_id, const vector<int> &depends_on, int max_cache_size) const {
     /*
@@ -84,8 +210,7 @@ int CGCache::compute_required_cache_size(
       too large.
     */
 
-    VariablesProxy variables = task_proxy.get_variables();
-    int var_domain = variables[var_id].get_domain_size();
+    int var_domain = domain_sizes[var_id];
     if (!utils::is_product_within_limit(var_domain, var_domain - 1,
                                         max_cache_size))
         return -1;
@@ -93,7 +218,7 @@ int CGCache::compute_required_cache_size(
     int required_size = var_domain * (var_domain - 1);
 
     for (int depend_var_id : depends_on) {
-        int depend_var_domain = variables[depend_var_id].get_domain_size();
+        int depend_var_domain = domain_sizes[depend_var_id];
 
         /*
           If var depends on a variable var_i that is not cached, then
@@ -102,7 +227,7 @@ int CGCache::compute_required_cache_size(
           contributes quadratically to its own cache size but only
           linearly to the cache size of var.
         */
-        if (cache[depend_var_id].empty())
+        if (!is_cached(depend_var_id))
             return -1;
 
         if (!utils::is_product_within_limit(required_size, depend_var_domain,
@@ -119,16 +244,203 @@ int CGCache::get_index(int var, const State &state,
                        int from_val, int to_val) const {
     assert(is_cached(var));
     assert(from_val != to_val);
-    int index = from_val;
-    int multiplier = task_proxy.get_variables()[var].get_domain_size();
+    /*
+      The entries with the same context and start value form a row, so
+      that the entries that are stored together are on the same page.
+    */
+    int domain_size = domain_sizes[var];
+    int context = 0;
+    int multiplier = 1;
     for (int dep_var : depends_on[var]) {
-        index += state[dep_var].get_value() * multiplier;
-        multiplier *= task_proxy.get_variables()[dep_var].get_domain_size();
+        context += state[dep_var].get_value() * multiplier;
+        multiplier *= domain_sizes[dep_var];
     }
     if (to_val > from_val)
         --to_val;
-    index += to_val * multiplier;
-    assert(utils::in_bounds(index, cache[var]));
+    int index = (context * domain_size + from_val) * (domain_size - 1) + to_val;
+    assert(index >= 0 && index < cache_sizes[var]);
     return index;
 }
+
+int CGCache::allocate_page(int var, int page_id) {
+    int page;
+    if (static_cast<int>(pages.size()) < max_pages) {
+        page = pages.size();
+        pages.push_back({var, page_id, true});
+        costs.resize(costs.size() + PAGE_SIZE, NOT_COMPUTED);
+        helpful_transitions.resize(
+            helpful_transitions.size() + PAGE_SIZE, NO_TRANSITION);
+    } else {
+        // Evict the next page whose reference bit is not set.
+        while (pages[clock_hand].referenced) {
+            pages[clock_hand].referenced = false;
+            clock_hand = (clock_hand + 1) % pages.size();
+        }
+        page = clock_hand;
+        clock_hand = (clock_hand + 1) % pages.size();
+        Page &evicted = pages[page];
+        page_indices[evicted.var][evicted.page_id] = NO_PAGE;
+        ++num_evictions;
+        evicted = {var, page_id, true};
+        fill_n(costs.begin() + page * PAGE_SIZE, PAGE_SIZE, NOT_COMPUTED);
+        fill_n(helpful_transitions.begin() + page * PAGE_SIZE, PAGE_SIZE,
+               NO_TRANSITION);
+    }
+    page_indices[var][page_id] = page;
+    return page;
+}
+
+void CGCache::store(int var, const State &state, int from_val, int to_val,
+                    int cost, int helpful_transition) {
+    int index = get_index(var, state, from_val, to_val);
+    int position = get_position(var, index);
+    if (position == -1) {
+        int page = allocate_page(var, index / PAGE_SIZE);
+        position = page * PAGE_SIZE + index % PAGE_SIZE;
+    }
+    costs[position] = cost;
+    helpful_transitions[position] = helpful_transition;
+}
+
+void CGCache::clear() {
+    for (vector<int> &indices : page_indices)
+        fill(indices.begin(), indices.end(), NO_PAGE);
+    pages.clear();
+    costs.clear();
+    helpful_transitions.clear();
+    clock_hand = 0;
+}
+
+bool CGCache::is_valid_page(int var, const vector<int> &page_costs,
+                            const vector<int> &page_transitions) const {
+    /*
+      An entry is either not computed or has a cost. Entries with a finite
+      cost have a helpful transition, the others have none.
+    */
+    for (int i = 0; i < PAGE_SIZE; ++i) {
+        int cost = page_costs[i];
+        int label_id = page_transitions[i];
+        if (cost == NOT_COMPUTED || cost == numeric_limits<int>::max()) {
+            if (label_id != NO_TRANSITION)
+                return false;
+        } else if (cost < 0 || label_id < 0 || label_id >= num_labels[var]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CGCache::load(utils::LogProxy &log) {
+    ifstream in(snapshot_path, ios::binary);
+    if (!in)
+        return false;
+
+    char magic[4];
+    int32_t version;
+    uint64_t hash;
+    int32_t num_vars;
+    if (!in.read(magic, 4) || memcmp(magic, MAGIC, 4) != 0 ||
+        !read_int(in, version) || version != FORMAT_VERSION ||
+        !in.read(reinterpret_cast<char *>(&hash), sizeof(hash)) ||
+        hash != task_hash ||
+        !read_int(in, num_vars) ||
+        num_vars != static_cast<int>(cache_sizes.size())) {
+        // An outdated format or another task that hashes to the same file.
+        if (log.is_warning()) {
+            log << "WARNING: ignoring heuristic cache " << snapshot_path << endl;
+        }
+        return false;
+    }
+    for (int var = 0; var < num_vars; ++var) {
+        int32_t cache_size;
+        if (!read_int(in, cache_size) || cache_size != cache_sizes[var])
+            return false;
+    }
+
+    int32_t num_pages;
+    if (!read_int(in, num_pages) || num_pages < 0)
+        return false;
+    // Pages that do not fit into the memory limit are skipped.
+    num_pages = min(num_pages, max_pages);
+    vector<int> page_costs(PAGE_SIZE);
+    vector<int> page_transitions(PAGE_SIZE);
+    for (int i = 0; i < num_pages; ++i) {
+        int32_t var, page_id;
+        if (!read_int(in, var) || !read_int(in, page_id) ||
+            var < 0 || var >= num_vars || page_id < 0 ||
+            page_id >= static_cast<int>(page_indices[var].size()) ||
+            page_indices[var][page_id] != NO_PAGE ||
+            !in.read(reinterpret_cast<char *>(page_costs.data()),
+                     PAGE_SIZE * sizeof(int)) ||
+            !in.read(reinterpret_cast<char *>(page_transitions.data()),
+                     PAGE_SIZE * sizeof(int)) ||
+            !is_valid_page(var, page_costs, page_transitions)) {
+            // A corrupted file: drop the pages that were loaded so far.
+            clear();
+            if (log.is_warning()) {
+                log << "WARNING: ignoring corrupted heuristic cache "
+                    << snapshot_path << endl;
+            }
+            return false;
+        }
+        int page = allocate_page(var, page_id);
+        pages[page].referenced = false;
+        copy(page_costs.begin(), page_costs.end(),
+             costs.begin() + page * PAGE_SIZE);
+        copy(page_transitions.begin(), page_transitions.end(),
+             helpful_transitions.begin() + page * PAGE_SIZE);
+    }
+    return true;
+}
+
+void CGCache::save(utils::LogProxy &log) const {
+    if (log.is_at_least_normal()) {
+        log << "Heuristic cache: " << pages.size() << " pages, "
+            << num_evictions << " evictions" << endl;
+    }
+    if (snapshot_path.empty())
+        return;
+
+    // Write to a temporary file first, so that concurrent runs never
+    // read a partially written cache.
+    string temporary_path =
+        snapshot_path + "." + to_string(utils::get_process_id()) + ".tmp";
+    {
+        ofstream out(temporary_path, ios::binary | ios::trunc);
+        out.write(MAGIC, 4);
+        write_int(out, FORMAT_VERSION);
+        out.write(reinterpret_cast<const char *>(&task_hash), sizeof(task_hash));
+        write_int(out, cache_sizes.size());
+        for (int cache_size : cache_sizes)
+            write_int(out, cache_size);
+        write_int(out, pages.size());
+        for (size_t page = 0; page < pages.size(); ++page) {
+            write_int(out, pages[page].var);
+            write_int(out, pages[page].page_id);
+            out.write(reinterpret_cast<const char *>(&costs[page * PAGE_SIZE]),
+                      PAGE_SIZE * sizeof(int));
+            out.write(reinterpret_cast<const char *>(
+                          &helpful_transitions[page * PAGE_SIZE]),
+                      PAGE_SIZE * sizeof(int));
+        }
+        if (!out) {
+            if (log.is_warning()) {
+                log << "WARNING: could not write heuristic cache to "
+                    << snapshot_path << endl;
+            }
+            remove(temporary_path.c_str());
+            return;
+        }
+    }
+    if (rename(temporary_path.c_str(), snapshot_path.c_str()) != 0) {
+        if (log.is_warning()) {
+            log << "WARNING: could not write heuristic cache to "
+                << snapshot_path << endl;
+        }
+        return;
+    }
+    if (log.is_at_least_normal()) {
+        log << "Saved heuristic cache to " << snapshot_path << endl;
+    }
+}
 }
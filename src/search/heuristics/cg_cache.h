@@ -3,57 +3,138 @@
 
 #include "../task_proxy.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
 #include <vector>
 
-namespace domain_transition_graph {
-struct ValueTransitionLabel;
-}
+class AbstractTask;
 
 namespace utils {
 class LogProxy;
 }
 
 namespace cg_heuristic {
+/*
+  Directory in which the caches of the CG heuristic are stored between runs
+  (see CGCache). If empty (the default), caches are not stored.
+*/
+extern std::string g_cg_cache_directory;
+
+/*
+  CGCache stores the transition costs computed by the CG heuristic and the
+  first helpful transition of the corresponding paths.
+
+  The cache of a variable has one row of entries for each combination of a
+  start value and an assignment to the variables it depends on ("context"),
+  with one entry per goal value. Rows are stored in pages of PAGE_SIZE
+  entries, which are allocated when the first entry in them is stored. If
+  the number of pages reaches the memory limit, a page is evicted with the
+  clock algorithm, an approximation of least-recently-used eviction: each
+  page has a reference bit that is set when the page is accessed, and the
+  clock hand cycles over the pages, clearing set bits, until it finds a
+  page whose bit is not set.
+
+  Helpful transitions are stored as indices into the labels of the domain
+  transition graphs (see CGHeuristic), so the cache does not refer to the
+  data structures of a particular heuristic. It can therefore be shared by
+  heuristics on the same task (see get_shared_cache) and stored on disk
+  (see g_cg_cache_directory). A stored cache is loaded when a cache for a
+  task with the same operators, variables and max_cache_size is created,
+  and it is saved with save().
+*/
 class CGCache {
-    TaskProxy task_proxy;
-    std::vector<std::vector<int>> cache;
-    std::vector<std::vector<domain_transition_graph::ValueTransitionLabel *>> helpful_transition_cache;
+    static const int PAGE_SIZE = 64;
+    static const int NO_PAGE = -1;
+
+    struct Page {
+        int var;
+        int page_id;
+        bool referenced;
+    };
+
+    std::vector<int> domain_sizes;
+    // Number of transition labels of each variable (see CGHeuristic).
+    std::vector<int> num_labels;
     std::vector<std::vector<int>> depends_on;
+    // Number of entries of the cache of each variable (0 if not cached).
+    std::vector<int> cache_sizes;
+    // page_indices[var][page_id]: index of the page in pages or NO_PAGE
+    std::vector<std::vector<int>> page_indices;
+    std::vector<Page> pages;
+    // Entries of the page with index i start at i * PAGE_SIZE.
+    std::vector<int> costs;
+    std::vector<int> helpful_transitions;
+    int max_pages;
+    int clock_hand;
+    int64_t num_evictions;
+
+    uint64_t task_hash;
+    std::string snapshot_path;
 
     int get_index(int var, const State &state, int from_val, int to_val) const;
     int compute_required_cache_size(
         int var_id, const std::vector<int> &depends_on, int max_cache_size) const;
+    int allocate_page(int var, int page_id);
+    int get_position(int var, int index) {
+        int page = page_indices[var][index / PAGE_SIZE];
+        if (page == NO_PAGE)
+            return -1;
+        pages[page].referenced = true;
+        return page * PAGE_SIZE + index % PAGE_SIZE;
+    }
+    void clear();
+    bool is_valid_page(int var, const std::vector<int> &page_costs,
+                       const std::vector<int> &page_transitions) const;
+    bool load(utils::LogProxy &log);
 public:
     static const int NOT_COMPUTED = -2;
+    static const int NO_TRANSITION = -1;
 
-    CGCache(const TaskProxy &task_proxy, int max_cache_size, utils::LogProxy &log);
+    /*
+      Create a cache that stores at most max_cache_size entries per
+      variable and uses at most max_memory MiB in total (0 means no limit).
+      num_labels[var] is the number of transition labels of var, which
+      bounds the indices of its helpful transitions.
+    */
+    CGCache(const TaskProxy &task_proxy, const std::vector<int> &num_labels,
+            int max_cache_size, int max_memory, utils::LogProxy &log);
     ~CGCache();
 
+    /*
+      Return the cache for the given task and parameters that is shared by
+      all heuristics which ask for it. Shared caches are kept until the
+      planner exits, so that later phases of iterated searches reuse them.
+      Neither the shared caches nor their registry are synchronized, so
+      they must only be used from one thread. A shared cache is saved by
+      the last heuristic that releases it.
+    */
+    static std::shared_ptr<CGCache> get_shared_cache(
+        const std::shared_ptr<AbstractTask> &task,
+        const std::vector<int> &num_labels, int max_cache_size,
+        int max_memory, utils::LogProxy &log);
+
     bool is_cached(int var) const {
-        return !cache[var].empty();
+        return cache_sizes[var] != 0;
     }
 
-    int lookup(int var, const State &state, int from_val, int to_val) const {
-        return cache[var][get_index(var, state, from_val, to_val)];
+    int lookup(int var, const State &state, int from_val, int to_val) {
+        int position = get_position(var, get_index(var, state, from_val, to_val));
+        return position == -1 ? NOT_COMPUTED : costs[position];
     }
 
-    void store(int var, const State &state,
-               int from_val, int to_val, int cost) {
-        cache[var][get_index(var, state, from_val, to_val)] = cost;
+    // Return the index of the label of the helpful transition of an entry.
+    int lookup_helpful_transition(
+        int var, const State &state, int from_val, int to_val) {
+        int position = get_position(var, get_index(var, state, from_val, to_val));
+        return position == -1 ? NO_TRANSITION : helpful_transitions[position];
     }
 
-    domain_transition_graph::ValueTransitionLabel *lookup_helpful_transition(
-        int var, const State &state, int from_val, int to_val) const {
-        int index = get_index(var, state, from_val, to_val);
-        return helpful_transition_cache[var][index];
-    }
+    void store(int var, const State &state, int from_val, int to_val,
+               int cost, int helpful_transition);
 
-    void store_helpful_transition(
-        int var, const State &state, int from_val, int to_val,
-        domain_transition_graph::ValueTransitionLabel *helpful_transition) {
-        int index = get_index(var, state, from_val, to_val);
-        helpful_transition_cache[var][index] = helpful_transition;
-    }
+    // Write the cache to g_cg_cache_directory (if set).
+    void save(utils::LogProxy &log) const;
 };
 }
 
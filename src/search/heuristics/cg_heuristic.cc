@@ -18,6 +18,7 @@ using namespace domain_transition_graph;
 namespace cg_heuristic {
 CGHeuristic::CGHeuristic(const plugins::Options &opts)
     : Heuristic(opts),
+      uses_shared_cache(opts.get<bool>("shared_cache")),
       cache_hits(0),
       cache_misses(0),
       helpful_transition_extraction_counter(0),
@@ -26,10 +27,6 @@ CGHeuristic::CGHeuristic(const plugins::Options &opts)
         log << "Initializing causal graph heuristic..." << endl;
     }
 
-    int max_cache_size = opts.get<int>("max_cache_size");
-    if (max_cache_size > 0)
-        cache = utils::make_unique_ptr<CGCache>(task_proxy, max_cache_size, log);
-
     unsigned int num_vars = task_proxy.get_variables().size();
     prio_queues.reserve(num_vars);
     for (size_t i = 0; i < num_vars; ++i)
@@ -39,9 +36,42 @@ CGHeuristic::CGHeuristic(const plugins::Options &opts)
         [](int dtg_var, int cond_var) {return dtg_var <= cond_var;};
     DTGFactory factory(task_proxy, false, pruning_condition);
     transition_graphs = factory.build_dtgs();
+
+    transition_labels.resize(num_vars);
+    for (size_t var = 0; var < num_vars; ++var) {
+        for (ValueNode &node : transition_graphs[var]->nodes) {
+            for (ValueTransition &transition : node.transitions) {
+                for (ValueTransitionLabel &label : transition.labels) {
+                    label_ids[&label] = transition_labels[var].size();
+                    transition_labels[var].push_back(&label);
+                }
+            }
+        }
+    }
+
+    int max_cache_size = opts.get<int>("max_cache_size");
+    int max_cache_memory = opts.get<int>("max_cache_memory");
+    if (max_cache_size > 0) {
+        vector<int> num_labels;
+        num_labels.reserve(num_vars);
+        for (const auto &labels : transition_labels)
+            num_labels.push_back(labels.size());
+        if (uses_shared_cache)
+            cache = CGCache::get_shared_cache(
+                task, num_labels, max_cache_size, max_cache_memory, log);
+        else
+            cache = make_shared<CGCache>(
+                task_proxy, num_labels, max_cache_size, max_cache_memory, log);
+    }
 }
 
 CGHeuristic::~CGHeuristic() {
+    /*
+      A shared cache is also held by the registry of shared caches, so it
+      is saved by the last heuristic that releases it.
+    */
+    if (cache && (!uses_shared_cache || cache.use_count() == 2))
+        cache->save(log);
 }
 
 bool CGHeuristic::dead_ends_are_reliable() const {
@@ -212,9 +242,8 @@ int CGHeuristic::get_transition_cost(const State &state,
             ValueTransitionLabel *helpful = start->helpful_transitions[val];
             // We should have a helpful transition iff distance is infinite.
             assert((distance == numeric_limits<int>::max()) == !helpful);
-            cache->store(var_no, state, start_val, val, distance);
-            cache->store_helpful_transition(
-                var_no, state, start_val, val, helpful);
+            cache->store(var_no, state, start_val, val, distance,
+                         helpful ? label_ids.at(helpful) : CGCache::NO_TRANSITION);
         }
     }
 
@@ -253,14 +282,23 @@ void CGHeuristic::mark_helpful_transitions(const State &state,
         helpful_transition_extraction_counter;
 
     ValueTransitionLabel *helpful;
-    int cost;
+    int cost = CGCache::NOT_COMPUTED;
     // Check cache.
-    if (cache && cache->is_cached(var_no)) {
-        helpful = cache->lookup_helpful_transition(var_no, state, from, to);
+    if (cache && cache->is_cached(var_no))
         cost = cache->lookup(var_no, state, from, to);
-        assert(helpful);
+    if (cost != CGCache::NOT_COMPUTED) {
+        int label_id = cache->lookup_helpful_transition(var_no, state, from, to);
+        assert(label_id != CGCache::NO_TRANSITION);
+        helpful = transition_labels[var_no][label_id];
     } else {
         ValueNode *start_node = &dtg->nodes[from];
+        if (start_node->distances.empty()) {
+            /*
+              The cost was looked up in the cache in this evaluation, but
+              the entry has been evicted since then.
+            */
+            get_transition_cost(state, dtg, from, to);
+        }
         assert(!start_node->helpful_transitions.empty());
         helpful = start_node->helpful_transitions[to];
         cost = start_node->distances[to];
@@ -295,7 +333,29 @@ public:
             "maximum number of cached entries per variable (set to 0 to disable cache)",
             "1000000",
             plugins::Bounds("0", "infinity"));
+        add_option<int>(
+            "max_cache_memory",
+            "maximum memory used by the cache in MiB (0 means no limit). "
+            "If the limit is reached, the least recently used parts of the "
+            "cache are evicted (approximately, with the clock algorithm).",
+            "0",
+            plugins::Bounds("0", "infinity"));
+        add_option<bool>(
+            "shared_cache",
+            "share the cache with all other cg heuristics on the same task "
+            "that use a shared cache with the same limits. The cache is kept "
+            "until the planner exits, so later phases of iterated searches "
+            "reuse it. The shared cache is not synchronized, so it must not "
+            "be used by the evaluators of hdastar, which run in parallel "
+            "threads.",
+            "false");
         Heuristic::add_options_to_feature(*this);
+        document_note(
+            "Storing the cache on disk",
+            "With the planner option cg_cache=DIR (e.g., "
+            "--search --none,cg_cache=DIR ...), caches are stored in DIR when "
+            "the heuristic is destroyed and loaded by later runs on the same "
+            "task.");
 
         document_language_support("action costs", "supported");
         document_language_support("conditional effects", "supported");
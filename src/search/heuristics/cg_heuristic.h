@@ -4,6 +4,7 @@
 #include "../heuristic.h"
 
 #include "../algorithms/priority_queues.h"
+#include "../utils/hash.h"
 
 #include <memory>
 #include <string>
@@ -12,6 +13,7 @@
 namespace domain_transition_graph {
 class DomainTransitionGraph;
 struct ValueNode;
+struct ValueTransitionLabel;
 }
 
 namespace cg_heuristic {
@@ -22,7 +24,16 @@ class CGHeuristic : public Heuristic {
     std::vector<std::unique_ptr<ValueNodeQueue>> prio_queues;
     std::vector<std::unique_ptr<domain_transition_graph::DomainTransitionGraph>> transition_graphs;
 
-    std::unique_ptr<CGCache> cache;
+    /*
+      The labels of the transitions of each domain transition graph,
+      numbered in the order of the nodes and transitions. The cache
+      refers to helpful transitions by these numbers.
+    */
+    std::vector<std::vector<domain_transition_graph::ValueTransitionLabel *>> transition_labels;
+    utils::HashMap<const domain_transition_graph::ValueTransitionLabel *, int> label_ids;
+
+    std::shared_ptr<CGCache> cache;
+    bool uses_shared_cache;
     int cache_hits;
     int cache_misses;
 
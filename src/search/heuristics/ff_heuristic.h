@@ -31,6 +31,12 @@ class FFHeuristic : public additive_heuristic::AdditiveHeuristic {
         const State &state, PropID goal_id);
 protected:
     virtual int compute_heuristic(const State &ancestor_state) override;
+    // The batch evaluation of the additive heuristic does not apply to FF.
+    virtual void compute_heuristics(
+        const std::vector<State> &ancestor_states,
+        std::vector<int> &values) override {
+        Heuristic::compute_heuristics(ancestor_states, values);
+    }
 public:
     explicit FFHeuristic(const plugins::Options &opts);
 };
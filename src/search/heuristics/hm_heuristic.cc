@@ -3,27 +3,124 @@
 #include "../plugins/plugin.h"
 
 #include "../task_utils/task_properties.h"
+#include "../utils/collections.h"
 #include "../utils/logging.h"
+#include "../utils/system.h"
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <limits>
-#include <set>
 
 using namespace std;
 
 namespace hm_heuristic {
+template<typename Callback>
+static void for_each_subset_aux(
+    const vector<int> &facts, int max_size, vector<int> &subset,
+    size_t start, const Callback &callback) {
+    callback(subset);
+    if (static_cast<int>(subset.size()) == max_size)
+        return;
+    for (size_t i = start; i < facts.size(); ++i) {
+        subset.push_back(facts[i]);
+        for_each_subset_aux(facts, max_size, subset, i + 1, callback);
+        subset.pop_back();
+    }
+}
+
+/*
+  Call callback for each subset of facts (which must be sorted) with at
+  most max_size elements, including the empty subset. The subsets are
+  passed as sorted tuples, which are built in the given buffer.
+*/
+template<typename Callback>
+static void for_each_subset(
+    const vector<int> &facts, int max_size, vector<int> &buffer,
+    const Callback &callback) {
+    buffer.clear();
+    for_each_subset_aux(facts, max_size, buffer, 0, callback);
+}
+
+static void merge_sorted(
+    const vector<int> &tuple1, const vector<int> &tuple2,
+    vector<int> &result) {
+    result.clear();
+    merge(tuple1.begin(), tuple1.end(), tuple2.begin(), tuple2.end(),
+          back_inserter(result));
+}
+
 HMHeuristic::HMHeuristic(const plugins::Options &opts)
     : Heuristic(opts),
       m(opts.get<int>("m")),
       has_cond_effects(task_properties::has_conditional_effects(task_proxy)),
-      goals(task_properties::get_fact_pairs(task_proxy.get_goals())) {
+      was_updated(false) {
     if (log.is_at_least_normal()) {
         log << "Using h^" << m << "." << endl;
-        log << "The implementation of the h^m heuristic is preliminary." << endl
-            << "It is SLOOOOOOOOOOOW." << endl
-            << "Please do not use this for comparison!" << endl;
     }
-    generate_all_tuples();
+
+    VariablesProxy variables = task_proxy.get_variables();
+    int num_facts = 0;
+    for (VariableProxy var : variables) {
+        fact_offsets.push_back(num_facts);
+        for (int value = 0; value < var.get_domain_size(); ++value)
+            fact_vars.push_back(var.get_id());
+        num_facts += var.get_domain_size();
+    }
+
+    auto get_fact_id = [&](const FactProxy &fact) {
+        return fact_offsets[fact.get_variable().get_id()] + fact.get_value();
+    };
+
+    for (FactProxy goal : task_proxy.get_goals())
+        goals.push_back(get_fact_id(goal));
+    sort(goals.begin(), goals.end());
+
+    for (OperatorProxy op : task_proxy.get_operators()) {
+        HMOperator hm_op;
+        for (FactProxy pre : op.get_preconditions())
+            hm_op.preconditions.push_back(get_fact_id(pre));
+        sort(hm_op.preconditions.begin(), hm_op.preconditions.end());
+        for (EffectProxy eff : op.get_effects())
+            hm_op.effects.push_back(get_fact_id(eff.get_fact()));
+        utils::sort_unique(hm_op.effects);
+        hm_op.cost = op.get_cost();
+        operators.push_back(move(hm_op));
+    }
+
+    /*
+      Compute binomial coefficients with saturation, so that table sizes
+      that do not fit into memory are detected below.
+    */
+    const int64_t MAX_TABLE_SIZE = numeric_limits<int32_t>::max();
+    binomials.assign((m + 1) * (num_facts + 1), 0);
+    for (int n = 0; n <= num_facts; ++n) {
+        binomials[n] = 1;
+        for (int k = 1; k <= m && k <= n; ++k) {
+            binomials[k * (num_facts + 1) + n] = min(
+                get_binomial(n - 1, k - 1) + get_binomial(n - 1, k),
+                MAX_TABLE_SIZE);
+        }
+    }
+    size_offsets.assign(m + 2, 0);
+    for (int k = 1; k <= m; ++k) {
+        size_offsets[k + 1] = min(
+            size_offsets[k] + get_binomial(num_facts, k), MAX_TABLE_SIZE);
+    }
+    if (size_offsets[m + 1] >= MAX_TABLE_SIZE) {
+        log << "The h^" << m << " table is too large." << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_OUT_OF_MEMORY);
+    }
+    hm_table.resize(size_offsets[m + 1]);
+    if (log.is_at_least_normal()) {
+        log << "Number of entries in the h^" << m << " table: "
+            << hm_table.size() << endl;
+    }
+
+    fact_changed_in_previous_sweep.resize(num_facts, false);
+    fact_changed_in_current_sweep.resize(num_facts, false);
+    var_status.resize(variables.size(), FREE);
+    precondition_costs.resize(operators.size());
 }
 
 
@@ -37,9 +134,13 @@ int HMHeuristic::compute_heuristic(const State &ancestor_state) {
     if (task_properties::is_goal_state(task_proxy, state)) {
         return 0;
     } else {
-        Tuple s_tup = task_properties::get_fact_pairs(state);
+        Tuple state_facts;
+        for (FactProxy fact : state) {
+            state_facts.push_back(
+                fact_offsets[fact.get_variable().get_id()] + fact.get_value());
+        }
 
-        init_hm_table(s_tup);
+        init_hm_table(state_facts);
         update_hm_table();
 
         int h = eval(goals);
@@ -51,214 +152,267 @@ int HMHeuristic::compute_heuristic(const State &ancestor_state) {
 }
 
 
-void HMHeuristic::init_hm_table(const Tuple &t) {
-    for (auto &hm_ent : hm_table) {
-        const Tuple &tuple = hm_ent.first;
-        int h_val = check_tuple_in_tuple(tuple, t);
-        hm_table[tuple] = h_val;
-    }
-}
-
-
-void HMHeuristic::update_hm_table() {
-    int round = 0;
-    do {
-        ++round;
-        was_updated = false;
-
-        for (OperatorProxy op : task_proxy.get_operators()) {
-            Tuple pre = get_operator_pre(op);
-
-            int c1 = eval(pre);
-            if (c1 != numeric_limits<int>::max()) {
-                Tuple eff = get_operator_eff(op);
-                vector<Tuple> partial_effs;
-                generate_all_partial_tuples(eff, partial_effs);
-                for (Tuple &partial_eff : partial_effs) {
-                    update_hm_entry(partial_eff, c1 + op.get_cost());
-
-                    int eff_size = partial_eff.size();
-                    if (eff_size < m) {
-                        extend_tuple(partial_eff, op);
-                    }
-                }
-            }
-        }
-    } while (was_updated);
+int64_t HMHeuristic::get_index(const Tuple &tuple) const {
+    assert(!tuple.empty() && static_cast<int>(tuple.size()) <= m);
+    assert(is_sorted(tuple.begin(), tuple.end()));
+    int64_t index = size_offsets[tuple.size()];
+    for (size_t i = 0; i < tuple.size(); ++i)
+        index += get_binomial(tuple[i], i + 1);
+    return index;
 }
 
 
-void HMHeuristic::extend_tuple(const Tuple &t, const OperatorProxy &op) {
-    for (auto &hm_ent : hm_table) {
-        const Tuple &tuple = hm_ent.first;
-        bool contradict = false;
-        for (const FactPair &fact : tuple) {
-            if (contradict_effect_of(op, fact.var, fact.value)) {
-                contradict = true;
-                break;
-            }
-        }
-        if (!contradict && (tuple.size() > t.size()) && (check_tuple_in_tuple(t, tuple) == 0)) {
-            Tuple pre = get_operator_pre(op);
-
-            Tuple others;
-            for (const FactPair &fact : tuple) {
-                if (find(t.begin(), t.end(), fact) == t.end()) {
-                    others.push_back(fact);
-                    if (find(pre.begin(), pre.end(), fact) == pre.end()) {
-                        pre.push_back(fact);
-                    }
-                }
-            }
-
-            sort(pre.begin(), pre.end());
-
-            set<int> vars;
-            bool is_valid = true;
-            for (const FactPair &fact : pre) {
-                if (vars.count(fact.var) != 0) {
-                    is_valid = false;
-                    break;
-                }
-                vars.insert(fact.var);
-            }
-
-            if (is_valid) {
-                int c2 = eval(pre);
-                if (c2 != numeric_limits<int>::max()) {
-                    update_hm_entry(tuple, c2 + op.get_cost());
-                }
-            }
-        }
+bool HMHeuristic::is_valid_tuple(const Tuple &tuple) const {
+    // Facts of the same variable are adjacent in sorted tuples.
+    for (size_t i = 1; i < tuple.size(); ++i) {
+        if (fact_vars[tuple[i - 1]] == fact_vars[tuple[i]])
+            return false;
     }
+    return true;
 }
 
 
-int HMHeuristic::eval(const Tuple &t) const {
-    vector<Tuple> partial;
-    generate_all_partial_tuples(t, partial);
-    int max = 0;
-    for (Tuple &tuple : partial) {
-        assert(hm_table.count(tuple) == 1);
-
-        int h = hm_table.at(tuple);
-        if (h > max) {
-            max = h;
-        }
-    }
-    return max;
+void HMHeuristic::init_hm_table(const Tuple &state_facts) {
+    fill(hm_table.begin(), hm_table.end(), numeric_limits<int>::max());
+    for_each_subset(
+        state_facts, m, merged_tuple,
+        [&](const Tuple &tuple) {
+            if (!tuple.empty())
+                hm_table[get_index(tuple)] = 0;
+        });
+
+    for (int fact : changed_facts_in_previous_sweep)
+        fact_changed_in_previous_sweep[fact] = false;
+    for (int fact : changed_facts_in_current_sweep)
+        fact_changed_in_current_sweep[fact] = false;
+    changed_facts_in_previous_sweep.clear();
+    changed_facts_in_current_sweep.clear();
 }
 
 
-int HMHeuristic::update_hm_entry(const Tuple &t, int val) {
-    assert(hm_table.count(t) == 1);
-    if (hm_table[t] > val) {
-        hm_table[t] = val;
-        was_updated = true;
+void HMHeuristic::start_sweep() {
+    for (int fact : changed_facts_in_previous_sweep)
+        fact_changed_in_previous_sweep[fact] = false;
+    changed_facts_in_previous_sweep.swap(changed_facts_in_current_sweep);
+    changed_facts_in_current_sweep.clear();
+    for (int fact : changed_facts_in_previous_sweep) {
+        fact_changed_in_previous_sweep[fact] = true;
+        fact_changed_in_current_sweep[fact] = false;
     }
-    return val;
 }
 
 
-int HMHeuristic::check_tuple_in_tuple(
-    const Tuple &tuple, const Tuple &big_tuple) const {
-    for (const FactPair &fact0 : tuple) {
-        bool found = false;
-        for (auto &fact1 : big_tuple) {
-            if (fact0 == fact1) {
-                found = true;
-                break;
-            }
-        }
-        if (!found) {
-            return numeric_limits<int>::max();
+void HMHeuristic::update_hm_table() {
+    int num_operators = operators.size();
+    bool first_sweep = true;
+    do {
+        start_sweep();
+        was_updated = false;
+
+        for (int op_id = 0; op_id < num_operators; ++op_id) {
+            const HMOperator &op = operators[op_id];
+            bool full = first_sweep;
+            for (size_t i = 0; !full && i < op.preconditions.size(); ++i)
+                full = has_changed(op.preconditions[i]);
+            if (full || !changed_facts_in_previous_sweep.empty() ||
+                !changed_facts_in_current_sweep.empty())
+                process_operator(op_id, full);
         }
-    }
-    return 0;
+        first_sweep = false;
+    } while (was_updated);
 }
 
 
-HMHeuristic::Tuple HMHeuristic::get_operator_pre(const OperatorProxy &op) const {
-    Tuple preconditions = task_properties::get_fact_pairs(op.get_preconditions());
-    sort(preconditions.begin(), preconditions.end());
-    return preconditions;
+void HMHeuristic::process_operator(int op_id, bool full) {
+    /*
+      If no tuple over the preconditions changed since the operator was
+      last processed, the cost of its preconditions and of its effects
+      did not change either. Then only extensions of the effects by
+      facts that occur in changed tuples need to be considered.
+    */
+    const HMOperator &op = operators[op_id];
+    if (full)
+        precondition_costs[op_id] = eval(op.preconditions);
+    int pre_cost = precondition_costs[op_id];
+    if (pre_cost == numeric_limits<int>::max())
+        return;
+
+    for (int pre : op.preconditions)
+        var_status[fact_vars[pre]] = pre - fact_offsets[fact_vars[pre]];
+    for (int eff : op.effects)
+        var_status[fact_vars[eff]] = AFFECTED;
+
+    for_each_subset(
+        op.effects, m, effect_subset,
+        [&](const Tuple &subset) {
+            if (subset.empty() || !is_valid_tuple(subset))
+                return;
+            if (full)
+                update_hm_entry(subset, pre_cost + op.cost);
+            if (static_cast<int>(subset.size()) < m)
+                extend_effect_subset(op, pre_cost, full);
+        });
+
+    for (int pre : op.preconditions)
+        var_status[fact_vars[pre]] = FREE;
+    for (int eff : op.effects)
+        var_status[fact_vars[eff]] = FREE;
 }
 
 
-HMHeuristic::Tuple HMHeuristic::get_operator_eff(const OperatorProxy &op) const {
-    Tuple effects;
-    for (EffectProxy eff : op.get_effects()) {
-        effects.push_back(eff.get_fact().get_pair());
-    }
-    sort(effects.begin(), effects.end());
-    return effects;
+bool HMHeuristic::is_extension_candidate(int fact) const {
+    int var = fact_vars[fact];
+    int status = var_status[var];
+    if (status == FREE)
+        return true;
+    return status == fact - fact_offsets[var];
 }
 
 
-bool HMHeuristic::contradict_effect_of(
-    const OperatorProxy &op, int var, int val) const {
-    for (EffectProxy eff : op.get_effects()) {
-        FactProxy fact = eff.get_fact();
-        if (fact.get_variable().get_id() == var && fact.get_value() != val) {
+bool HMHeuristic::contradicts_effects(const HMOperator &op, int fact) const {
+    for (int eff : op.effects) {
+        if (fact_vars[eff] == fact_vars[fact] && eff != fact)
             return true;
-        }
     }
     return false;
 }
 
 
-void HMHeuristic::generate_all_tuples() {
-    Tuple t;
-    generate_all_tuples_aux(0, m, t);
+void HMHeuristic::extend_effect_subset(
+    const HMOperator &op, int pre_cost, bool full) {
+    /*
+      Tuples that contain a fact of a variable for which the operator has
+      effects with different values (due to conditional effects) are not
+      extended.
+    */
+    for (int fact : effect_subset) {
+        if (contradicts_effects(op, fact))
+            return;
+    }
+
+    int max_size = m - effect_subset.size();
+    extension.clear();
+    if (full) {
+        add_extension_facts(op, pre_cost, 0, max_size);
+    } else {
+        /*
+          At least one fact of the extension must occur in a changed
+          tuple. The list of changed facts can grow while we iterate.
+        */
+        for (int round = 0; round < 2; ++round) {
+            const vector<int> &changed_facts = (round == 0) ?
+                changed_facts_in_previous_sweep : changed_facts_in_current_sweep;
+            for (size_t i = 0; i < changed_facts.size(); ++i) {
+                int fact = changed_facts[i];
+                if (!is_extension_candidate(fact))
+                    continue;
+                extension.push_back(fact);
+                add_extension_facts(op, pre_cost, 0, max_size - 1);
+                extension.pop_back();
+            }
+        }
+    }
 }
 
 
-void HMHeuristic::generate_all_tuples_aux(int var, int sz, const Tuple &base) {
-    int num_variables = task_proxy.get_variables().size();
-    for (int i = var; i < num_variables; ++i) {
-        int domain_size = task_proxy.get_variables()[i].get_domain_size();
-        for (int j = 0; j < domain_size; ++j) {
-            Tuple tuple(base);
-            tuple.emplace_back(i, j);
-            hm_table[tuple] = 0;
-            if (sz > 1) {
-                generate_all_tuples_aux(i + 1, sz - 1, tuple);
-            }
+void HMHeuristic::add_extension_facts(
+    const HMOperator &op, int pre_cost, int start_fact, int max_size) {
+    if (!extension.empty()) {
+        int cost = eval_extension(op, pre_cost);
+        if (cost != numeric_limits<int>::max()) {
+            updated_tuple.assign(effect_subset.begin(), effect_subset.end());
+            updated_tuple.insert(
+                updated_tuple.end(), extension.begin(), extension.end());
+            sort(updated_tuple.begin(), updated_tuple.end());
+            update_hm_entry(updated_tuple, cost + op.cost);
         }
     }
+    if (max_size == 0)
+        return;
+    int num_facts = fact_vars.size();
+    for (int fact = start_fact; fact < num_facts; ++fact) {
+        if (!is_extension_candidate(fact))
+            continue;
+        bool var_is_used = false;
+        for (int other : extension) {
+            if (fact_vars[other] == fact_vars[fact])
+                var_is_used = true;
+        }
+        if (var_is_used)
+            continue;
+        extension.push_back(fact);
+        add_extension_facts(op, pre_cost, fact + 1, max_size - 1);
+        extension.pop_back();
+    }
 }
 
 
-void HMHeuristic::generate_all_partial_tuples(
-    const Tuple &base_tuple, vector<Tuple> &res) const {
-    Tuple t;
-    generate_all_partial_tuples_aux(base_tuple, t, 0, m, res);
+int HMHeuristic::eval(const Tuple &tuple) {
+    int result = 0;
+    for_each_subset(
+        tuple, m, precondition_subset,
+        [&](const Tuple &subset) {
+            if (!subset.empty())
+                result = max(result, get_value(subset));
+        });
+    return result;
 }
 
 
-void HMHeuristic::generate_all_partial_tuples_aux(
-    const Tuple &base_tuple, const Tuple &t, int index, int sz, vector<Tuple> &res) const {
-    if (sz == 1) {
-        for (size_t i = index; i < base_tuple.size(); ++i) {
-            Tuple tuple(t);
-            tuple.push_back(base_tuple[i]);
-            res.push_back(tuple);
-        }
-    } else {
-        for (size_t i = index; i < base_tuple.size(); ++i) {
-            Tuple tuple(t);
-            tuple.push_back(base_tuple[i]);
-            res.push_back(tuple);
-            generate_all_partial_tuples_aux(base_tuple, tuple, i + 1, sz - 1, res);
+int HMHeuristic::eval_extension(const HMOperator &op, int pre_cost) {
+    /*
+      Compute the cost of the union of the preconditions and the
+      extension. The cost of the tuples over the preconditions alone is
+      pre_cost, so we only need to look at tuples that contain facts of
+      the extension that are no preconditions.
+    */
+    new_extension_facts.clear();
+    for (int fact : extension) {
+        if (var_status[fact_vars[fact]] == FREE)
+            new_extension_facts.push_back(fact);
+    }
+
+    int result = pre_cost;
+    if (m == 2 && new_extension_facts.size() == 1) {
+        // Special case for the extensions of h^2 (with one new fact).
+        int fact = new_extension_facts[0];
+        result = max(result, hm_table[fact]);
+        for (int pre : op.preconditions) {
+            if (result == numeric_limits<int>::max())
+                break;
+            result = max(result, hm_table[get_pair_index(pre, fact)]);
         }
+        return result;
     }
+    sort(new_extension_facts.begin(), new_extension_facts.end());
+    for_each_subset(
+        new_extension_facts, m, extension_subset,
+        [&](const Tuple &extension_facts) {
+            if (extension_facts.empty())
+                return;
+            for_each_subset(
+                op.preconditions, m - extension_facts.size(),
+                precondition_subset,
+                [&](const Tuple &pre_facts) {
+                    merge_sorted(extension_facts, pre_facts, merged_tuple);
+                    result = max(result, get_value(merged_tuple));
+                });
+        });
+    return result;
 }
 
 
-void HMHeuristic::dump_table() const {
-    if (log.is_at_least_debug()) {
-        for (auto &hm_ent : hm_table) {
-            log << "h(" << hm_ent.first << ") = " << hm_ent.second << endl;
+void HMHeuristic::update_hm_entry(const Tuple &tuple, int val) {
+    assert(is_valid_tuple(tuple));
+    int &entry = hm_table[get_index(tuple)];
+    if (entry > val) {
+        entry = val;
+        was_updated = true;
+        for (int fact : tuple) {
+            if (!fact_changed_in_current_sweep[fact]) {
+                fact_changed_in_current_sweep[fact] = true;
+                changed_facts_in_current_sweep.push_back(fact);
+            }
         }
     }
 }
@@ -3,10 +3,8 @@
 
 #include "../heuristic.h"
 
-#include <algorithm>
-#include <iostream>
-#include <map>
-#include <string>
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 namespace plugins {
@@ -17,45 +15,107 @@ namespace hm_heuristic {
 /*
   Haslum's h^m heuristic family ("critical path heuristics").
 
-  This is a very slow implementation and should not be used for
-  speed benchmarks.
+  Facts are numbered consecutively and a tuple is a sorted sequence of
+  at most m fact IDs of different variables. The h^m values of all tuples
+  are stored in a flat table, in which the index of a tuple is its rank
+  in the combinatorial number system. (The table also has unused entries
+  for sequences with several facts of the same variable.)
+
+  The table is computed with a fixpoint iteration over the operators
+  that sweeps until no value changes. After the first sweep, an operator
+  is only reconsidered for tuples whose cost may have changed: if the
+  cost of a tuple over its preconditions changed, all of its effects are
+  updated; otherwise only tuples that extend its effects by facts that
+  occur in a changed tuple are updated.
 */
-
 class HMHeuristic : public Heuristic {
-    using Tuple = std::vector<FactPair>;
+    using Tuple = std::vector<int>;
+
+    struct HMOperator {
+        Tuple preconditions;
+        // Effect facts of all effects (conditions of effects are ignored).
+        Tuple effects;
+        int cost;
+    };
+
     // parameters
     const int m;
     const bool has_cond_effects;
 
-    const Tuple goals;
+    Tuple goals;
+    std::vector<HMOperator> operators;
+
+    // fact_offsets[var]: ID of the first fact of variable var
+    std::vector<int> fact_offsets;
+    std::vector<int> fact_vars;
+    // (n choose k) for k <= m and n <= number of facts, see get_binomial
+    std::vector<int64_t> binomials;
+    // size_offsets[k]: index of the first tuple with k facts
+    std::vector<int64_t> size_offsets;
 
     // h^m table
-    std::map<Tuple, int> hm_table;
+    std::vector<int> hm_table;
     bool was_updated;
 
+    /*
+      Facts that occur in a tuple whose value changed in the previous
+      or the current sweep.
+    */
+    std::vector<bool> fact_changed_in_previous_sweep;
+    std::vector<bool> fact_changed_in_current_sweep;
+    std::vector<int> changed_facts_in_previous_sweep;
+    std::vector<int> changed_facts_in_current_sweep;
+
+    /*
+      Status of the variables for the operator that is currently
+      processed: AFFECTED, FREE or the value required by a precondition.
+    */
+    enum {AFFECTED = -1, FREE = -2};
+    std::vector<int> var_status;
+
+    // Buffers used while processing an operator.
+    Tuple effect_subset;
+    Tuple extension;
+    Tuple new_extension_facts;
+    Tuple extension_subset;
+    Tuple precondition_subset;
+    Tuple merged_tuple;
+    Tuple updated_tuple;
+    // Cost of the preconditions of each operator in the current sweep.
+    std::vector<int> precondition_costs;
+
+    int64_t get_binomial(int n, int k) const {
+        return binomials[k * fact_vars.size() + k + n];
+    }
+    int64_t get_index(const Tuple &tuple) const;
+    // Index of the tuple of the two given facts of different variables.
+    int64_t get_pair_index(int fact1, int fact2) const {
+        if (fact1 > fact2)
+            std::swap(fact1, fact2);
+        return size_offsets[2] + fact1 + get_binomial(fact2, 2);
+    }
+    int get_value(const Tuple &tuple) const {
+        return hm_table[get_index(tuple)];
+    }
+    bool is_valid_tuple(const Tuple &tuple) const;
+    bool has_changed(int fact) const {
+        return fact_changed_in_previous_sweep[fact] ||
+               fact_changed_in_current_sweep[fact];
+    }
+
     // auxiliary methods
-    void init_hm_table(const Tuple &t);
+    void init_hm_table(const Tuple &state_facts);
     void update_hm_table();
-    int eval(const Tuple &t) const;
-    int update_hm_entry(const Tuple &t, int val);
-    void extend_tuple(const Tuple &t, const OperatorProxy &op);
-
-    int check_tuple_in_tuple(const Tuple &tuple, const Tuple &big_tuple) const;
-
-    int get_operator_pre_value(const OperatorProxy &op, int var) const;
-    Tuple get_operator_pre(const OperatorProxy &op) const;
-    Tuple get_operator_eff(const OperatorProxy &op) const;
-    bool contradict_effect_of(const OperatorProxy &op, int var, int val) const;
-
-    void generate_all_tuples();
-    void generate_all_tuples_aux(int var, int sz, const Tuple &base);
-
-    void generate_all_partial_tuples(const Tuple &base_tuple,
-                                     std::vector<Tuple> &res) const;
-    void generate_all_partial_tuples_aux(const Tuple &base_tuple, const Tuple &t, int index,
-                                         int sz, std::vector<Tuple> &res) const;
-
-    void dump_table() const;
+    void update_hm_entry(const Tuple &tuple, int val);
+    void start_sweep();
+    int eval(const Tuple &tuple);
+    int eval_extension(const HMOperator &op, int pre_cost);
+    bool is_extension_candidate(int fact) const;
+    bool contradicts_effects(const HMOperator &op, int fact) const;
+    void process_operator(int op_id, bool full);
+    void extend_effect_subset(const HMOperator &op, int pre_cost, bool full);
+    void add_extension_facts(
+        const HMOperator &op, int pre_cost, int start_fact, int max_size);
 
 protected:
     virtual int compute_heuristic(const State &ancestor_state) override;
@@ -9,6 +9,7 @@
 #include "../utils/logging.h"
 #include "../utils/memory.h"
 
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -16,7 +17,9 @@ using namespace std;
 namespace lm_cut_heuristic {
 LandmarkCutHeuristic::LandmarkCutHeuristic(const plugins::Options &opts)
     : Heuristic(opts),
-      landmark_generator(utils::make_unique_ptr<LandmarkCutLandmarks>(task_proxy)) {
+      landmark_generator(utils::make_unique_ptr<LandmarkCutLandmarks>(task_proxy)),
+      incremental(opts.get<bool>("incremental")),
+      transition_op_id(-1) {
     if (log.is_at_least_normal()) {
         log << "Initializing landmark cut heuristic..." << endl;
     }
@@ -25,25 +28,109 @@ LandmarkCutHeuristic::LandmarkCutHeuristic(const plugins::Options &opts)
 LandmarkCutHeuristic::~LandmarkCutHeuristic() {
 }
 
+bool LandmarkCutHeuristic::is_transition_successor(
+    const State &ancestor_state) const {
+    return transition_successor &&
+           transition_successor->get_registry() == ancestor_state.get_registry() &&
+           transition_successor->get_id() == ancestor_state.get_id();
+}
+
+void LandmarkCutHeuristic::collect_inherited_landmarks() {
+    inherited_landmarks.clear();
+    const vector<int> &parent_landmarks = state_landmarks[*transition_parent];
+    for (size_t pos = 0; pos < parent_landmarks.size();) {
+        int size = parent_landmarks[pos];
+        auto begin = parent_landmarks.begin() + pos + 1;
+        auto end = begin + size;
+        if (find(begin, end, transition_op_id) == end)
+            inherited_landmarks.insert(
+                inherited_landmarks.end(), begin - 1, end);
+        pos += size + 1;
+    }
+}
+
 int LandmarkCutHeuristic::compute_heuristic(const State &ancestor_state) {
     State state = convert_ancestor_state(ancestor_state);
     int total_cost = 0;
-    bool dead_end = landmark_generator->compute_landmarks(
-        state,
-        [&total_cost](int cut_cost) {total_cost += cut_cost;},
-        nullptr);
+    bool dead_end;
+    if (incremental && ancestor_state.get_registry()) {
+        const vector<int> *initial_landmarks = nullptr;
+        if (is_transition_successor(ancestor_state)) {
+            collect_inherited_landmarks();
+            initial_landmarks = &inherited_landmarks;
+        }
+        vector<int> &landmarks = state_landmarks[ancestor_state];
+        landmarks.clear();
+        dead_end = landmark_generator->compute_landmarks(
+            state,
+            [&total_cost](int cut_cost) {total_cost += cut_cost;},
+            [&landmarks](const vector<int> &op_ids, int /*cost*/) {
+                landmarks.push_back(op_ids.size());
+                landmarks.insert(landmarks.end(), op_ids.begin(), op_ids.end());
+            },
+            initial_landmarks);
+        if (dead_end)
+            vector<int>().swap(landmarks);
+    } else {
+        dead_end = landmark_generator->compute_landmarks(
+            state,
+            [&total_cost](int cut_cost) {total_cost += cut_cost;},
+            nullptr);
+    }
 
     if (dead_end)
         return DEAD_END;
     return total_cost;
 }
 
+void LandmarkCutHeuristic::get_path_dependent_evaluators(
+    set<Evaluator *> &evals) {
+    if (incremental)
+        evals.insert(this);
+}
+
+void LandmarkCutHeuristic::notify_initial_state(const State &) {
+    transition_parent.reset();
+    transition_successor.reset();
+}
+
+void LandmarkCutHeuristic::notify_state_transition(
+    const State &parent_state, OperatorID op_id, const State &state) {
+    if (!transition_parent ||
+        transition_parent->get_registry() != parent_state.get_registry() ||
+        transition_parent->get_id() != parent_state.get_id()) {
+        /*
+          In eager search, the previous parent has been expanded, so its
+          landmarks are not needed anymore (unless it is reopened, in which
+          case its successors are evaluated from scratch). In lazy search,
+          its remaining successors are evaluated from scratch.
+        */
+        if (transition_parent)
+            vector<int>().swap(state_landmarks[*transition_parent]);
+        transition_parent.emplace(parent_state);
+    }
+    transition_op_id = op_id.get_index();
+    transition_successor.emplace(state);
+}
+
 class LandmarkCutHeuristicFeature : public plugins::TypedFeature<Evaluator, LandmarkCutHeuristic> {
 public:
     LandmarkCutHeuristicFeature() : TypedFeature("lmcut") {
         document_title("Landmark-cut heuristic");
 
         Heuristic::add_options_to_feature(*this);
+        add_option<bool>(
+            "incremental",
+            "reuse the landmarks of the parent state that do not contain "
+            "the operator leading to the evaluated state before computing "
+            "new cuts (incremental LM-cut). This requires storing the "
+            "landmarks of all evaluated states that have not been expanded "
+            "yet. Only the successors of the parent of the most recently "
+            "reported transition profit, so this pays off in eager search, "
+            "but hardly in lazy search, which interleaves the successors of "
+            "different parents. The heuristic values can differ from those "
+            "of the regular LM-cut heuristic, but they are still admissible.",
+            "false");
 
         document_language_support("action costs", "supported");
         document_language_support("conditional effects", "not supported");
@@ -2,8 +2,11 @@
 #define HEURISTICS_LM_CUT_HEURISTIC_H
 
 #include "../heuristic.h"
+#include "../per_state_information.h"
 
 #include <memory>
+#include <optional>
+#include <vector>
 
 namespace plugins {
 class Options;
@@ -15,10 +18,47 @@ class LandmarkCutLandmarks;
 class LandmarkCutHeuristic : public Heuristic {
     std::unique_ptr<LandmarkCutLandmarks> landmark_generator;
 
+    /*
+      In incremental mode, the landmarks of each evaluated state are
+      stored until a transition from it has been reported and then a
+      transition from another parent is reported. A landmark of the parent
+      that does not contain the operator of the transition is also a
+      landmark of the successor, so these landmarks are used as a warm
+      start when the successor is evaluated right after the transition
+      has been reported (as in eager search without batch evaluation).
+      Otherwise, the landmarks are computed from scratch.
+
+      In eager search, the transitions of a parent are reported together
+      when it is expanded, so its landmarks are kept exactly as long as
+      they are useful. Lazy search reports the transitions of different
+      parents interleaved, so the landmarks of a parent are usually
+      discarded before most of its successors are evaluated, and lazy
+      search gains little or nothing from incremental mode.
+
+      Each stored landmark is represented by its number of operators
+      followed by the operator IDs (see LandmarkCutLandmarks).
+    */
+    const bool incremental;
+    PerStateInformation<std::vector<int>> state_landmarks;
+    std::optional<State> transition_parent;
+    int transition_op_id;
+    std::optional<State> transition_successor;
+    std::vector<int> inherited_landmarks;
+
+    bool is_transition_successor(const State &ancestor_state) const;
+    void collect_inherited_landmarks();
+
     virtual int compute_heuristic(const State &ancestor_state) override;
 public:
     explicit LandmarkCutHeuristic(const plugins::Options &opts);
     virtual ~LandmarkCutHeuristic() override;
+
+    virtual void get_path_dependent_evaluators(
+        std::set<Evaluator *> &evals) override;
+    virtual void notify_initial_state(const State &initial_state) override;
+    virtual void notify_state_transition(
+        const State &parent_state, OperatorID op_id,
+        const State &state) override;
 };
 }
 
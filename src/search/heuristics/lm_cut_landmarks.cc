@@ -15,136 +15,152 @@ LandmarkCutLandmarks::LandmarkCutLandmarks(const TaskProxy &task_proxy) {
     task_properties::verify_no_conditional_effects(task_proxy);
 
     // Build propositions.
-    num_propositions = 2; // artificial goal and artificial precondition
     VariablesProxy variables = task_proxy.get_variables();
-    propositions.resize(variables.size());
-    for (FactProxy fact : variables.get_facts()) {
-        int var_id = fact.get_variable().get_id();
-        propositions[var_id].push_back(RelaxedProposition());
-        ++num_propositions;
+    proposition_offsets.reserve(variables.size());
+    PropID next_prop_id = 0;
+    for (VariableProxy var : variables) {
+        proposition_offsets.push_back(next_prop_id);
+        next_prop_id += var.get_domain_size();
     }
+    artificial_precondition = next_prop_id++;
+    artificial_goal = next_prop_id++;
+    num_propositions = next_prop_id;
+    propositions.resize(num_propositions);
 
-    // Build relaxed operators for operators and axioms.
-    for (OperatorProxy op : task_proxy.get_operators())
-        build_relaxed_operator(op);
-
-    // Simplify relaxed operators.
-    // simplify();
-    /* TODO: Put this back in and test if it makes sense,
-       but only after trying out whether and how much the change to
-       unary operators hurts. */
-
-    // Build artificial goal proposition and operator.
-    vector<RelaxedProposition *> goal_op_pre, goal_op_eff;
-    for (FactProxy goal : task_proxy.get_goals()) {
-        goal_op_pre.push_back(get_proposition(goal));
+    /*
+      Build relaxed operators for operators. The index of a relaxed
+      operator is the ID of its original operator.
+    */
+    OperatorsProxy operators = task_proxy.get_operators();
+    relaxed_operators.reserve(operators.size() + 1);
+    vector<PropID> precondition;
+    vector<PropID> effects;
+    for (OperatorProxy op : operators) {
+        precondition.clear();
+        effects.clear();
+        for (FactProxy pre : op.get_preconditions())
+            precondition.push_back(get_prop_id(pre));
+        for (EffectProxy eff : op.get_effects())
+            effects.push_back(get_prop_id(eff.get_fact()));
+        add_relaxed_operator(
+            move(precondition), effects, op.get_id(), op.get_cost());
     }
-    goal_op_eff.push_back(&artificial_goal);
+
+    // Build artificial goal operator.
+    precondition.clear();
+    for (FactProxy goal : task_proxy.get_goals())
+        precondition.push_back(get_prop_id(goal));
+    effects.assign(1, artificial_goal);
     /* Use the invalid operator ID -1 so accessing
        the artificial operator will generate an error. */
-    add_relaxed_operator(move(goal_op_pre), move(goal_op_eff), -1, 0);
+    add_relaxed_operator(move(precondition), effects, -1, 0);
 
     // Cross-reference relaxed operators.
-    for (RelaxedOperator &op : relaxed_operators) {
-        for (RelaxedProposition *pre : op.preconditions)
-            pre->precondition_of.push_back(&op);
-        for (RelaxedProposition *eff : op.effects)
-            eff->effect_of.push_back(&op);
+    vector<vector<OpID>> precondition_of(num_propositions);
+    vector<vector<OpID>> effect_of(num_propositions);
+    for (OpID op_id = 0; op_id < static_cast<int>(relaxed_operators.size());
+         ++op_id) {
+        const RelaxedOperator &op = relaxed_operators[op_id];
+        for (PropID pre : get_preconditions(op))
+            precondition_of[pre].push_back(op_id);
+        for (PropID eff : get_effects(op))
+            effect_of[eff].push_back(op_id);
+    }
+    for (PropID prop_id = 0; prop_id < num_propositions; ++prop_id) {
+        RelaxedProposition &prop = propositions[prop_id];
+        prop.num_precondition_of = precondition_of[prop_id].size();
+        prop.precondition_of =
+            proposition_operators_pool.append(precondition_of[prop_id]);
+        prop.num_effect_of = effect_of[prop_id].size();
+        prop.effect_of = proposition_operators_pool.append(effect_of[prop_id]);
     }
 }
 
 LandmarkCutLandmarks::~LandmarkCutLandmarks() {
 }
 
-void LandmarkCutLandmarks::build_relaxed_operator(const OperatorProxy &op) {
-    vector<RelaxedProposition *> precondition;
-    vector<RelaxedProposition *> effects;
-    for (FactProxy pre : op.get_preconditions()) {
-        precondition.push_back(get_proposition(pre));
-    }
-    for (EffectProxy eff : op.get_effects()) {
-        effects.push_back(get_proposition(eff.get_fact()));
-    }
-    add_relaxed_operator(
-        move(precondition), move(effects), op.get_id(), op.get_cost());
-}
-
 void LandmarkCutLandmarks::add_relaxed_operator(
-    vector<RelaxedProposition *> &&precondition,
-    vector<RelaxedProposition *> &&effects,
+    vector<PropID> &&precondition, const vector<PropID> &effects,
     int op_id, int base_cost) {
-    RelaxedOperator relaxed_op(
-        move(precondition), move(effects), op_id, base_cost);
-    if (relaxed_op.preconditions.empty())
-        relaxed_op.preconditions.push_back(&artificial_precondition);
-    relaxed_operators.push_back(relaxed_op);
+    if (precondition.empty())
+        precondition.push_back(artificial_precondition);
+    array_pool::ArrayPoolIndex pre_index =
+        operator_propositions_pool.append(precondition);
+    array_pool::ArrayPoolIndex eff_index =
+        operator_propositions_pool.append(effects);
+    relaxed_operators.emplace_back(
+        op_id, base_cost, precondition.size(), pre_index,
+        effects.size(), eff_index);
 }
 
-RelaxedProposition *LandmarkCutLandmarks::get_proposition(
-    const FactProxy &fact) {
-    int var_id = fact.get_variable().get_id();
-    int val = fact.get_value();
-    return &propositions[var_id][val];
+PropID LandmarkCutLandmarks::get_prop_id(const FactProxy &fact) const {
+    return proposition_offsets[fact.get_variable().get_id()] + fact.get_value();
 }
 
 // heuristic computation
 void LandmarkCutLandmarks::setup_exploration_queue() {
     priority_queue.clear();
 
-    for (auto &var_props : propositions) {
-        for (RelaxedProposition &prop : var_props) {
-            prop.status = UNREACHED;
-        }
-    }
-
-    artificial_goal.status = UNREACHED;
-    artificial_precondition.status = UNREACHED;
+    for (RelaxedProposition &prop : propositions)
+        prop.status = UNREACHED;
 
     for (RelaxedOperator &op : relaxed_operators) {
-        op.unsatisfied_preconditions = op.preconditions.size();
-        op.h_max_supporter = 0;
+        op.unsatisfied_preconditions = op.num_preconditions;
+        op.h_max_supporter = NO_PROPOSITION;
         op.h_max_supporter_cost = numeric_limits<int>::max();
     }
 }
 
-void LandmarkCutLandmarks::setup_exploration_queue_state(const State &state) {
-    for (FactProxy init_fact : state) {
-        enqueue_if_necessary(get_proposition(init_fact), 0);
-    }
-    enqueue_if_necessary(&artificial_precondition, 0);
+void LandmarkCutLandmarks::setup_exploration_queue_state() {
+    for (PropID init_prop : initial_propositions)
+        enqueue_if_necessary(init_prop, 0);
+    enqueue_if_necessary(artificial_precondition, 0);
 }
 
-void LandmarkCutLandmarks::first_exploration(const State &state) {
+void LandmarkCutLandmarks::first_exploration() {
     assert(priority_queue.empty());
     setup_exploration_queue();
-    setup_exploration_queue_state(state);
+    setup_exploration_queue_state();
     while (!priority_queue.empty()) {
-        pair<int, RelaxedProposition *> top_pair = priority_queue.pop();
+        pair<int, PropID> top_pair = priority_queue.pop();
         int popped_cost = top_pair.first;
-        RelaxedProposition *prop = top_pair.second;
-        int prop_cost = prop->h_max_cost;
+        PropID prop_id = top_pair.second;
+        const RelaxedProposition &prop = propositions[prop_id];
+        int prop_cost = prop.h_max_cost;
         assert(prop_cost <= popped_cost);
         if (prop_cost < popped_cost)
             continue;
-        const vector<RelaxedOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (RelaxedOperator *relaxed_op : triggered_operators) {
-            --relaxed_op->unsatisfied_preconditions;
-            assert(relaxed_op->unsatisfied_preconditions >= 0);
-            if (relaxed_op->unsatisfied_preconditions == 0) {
-                relaxed_op->h_max_supporter = prop;
-                relaxed_op->h_max_supporter_cost = prop_cost;
-                int target_cost = prop_cost + relaxed_op->cost;
-                for (RelaxedProposition *effect : relaxed_op->effects) {
+        for (OpID op_id : get_precondition_of(prop)) {
+            RelaxedOperator &relaxed_op = relaxed_operators[op_id];
+            --relaxed_op.unsatisfied_preconditions;
+            assert(relaxed_op.unsatisfied_preconditions >= 0);
+            if (relaxed_op.unsatisfied_preconditions == 0) {
+                relaxed_op.h_max_supporter = prop_id;
+                relaxed_op.h_max_supporter_cost = prop_cost;
+                int target_cost = prop_cost + relaxed_op.cost;
+                for (PropID effect : get_effects(relaxed_op))
                     enqueue_if_necessary(effect, target_cost);
-                }
             }
         }
     }
 }
 
-void LandmarkCutLandmarks::first_exploration_incremental(
-    vector<RelaxedOperator *> &cut) {
+void LandmarkCutLandmarks::update_h_max_supporter(RelaxedOperator &op) {
+    assert(!op.unsatisfied_preconditions);
+    PropID supporter = op.h_max_supporter;
+    int supporter_cost = propositions[supporter].h_max_cost;
+    for (PropID pre : get_preconditions(op)) {
+        int pre_cost = propositions[pre].h_max_cost;
+        if (pre_cost > supporter_cost) {
+            supporter = pre;
+            supporter_cost = pre_cost;
+        }
+    }
+    op.h_max_supporter = supporter;
+    op.h_max_supporter_cost = supporter_cost;
+}
+
+void LandmarkCutLandmarks::first_exploration_incremental() {
     assert(priority_queue.empty());
     /* We pretend that this queue has had as many pushes already as we
        have propositions to avoid switching from bucket-based to
@@ -152,32 +168,33 @@ void LandmarkCutLandmarks::first_exploration_incremental(
        to heap-based in problems where action costs are at most 1.
     */
     priority_queue.add_virtual_pushes(num_propositions);
-    for (RelaxedOperator *relaxed_op : cut) {
-        int cost = relaxed_op->h_max_supporter_cost + relaxed_op->cost;
-        for (RelaxedProposition *effect : relaxed_op->effects)
+    for (OpID op_id : cut) {
+        const RelaxedOperator &relaxed_op = relaxed_operators[op_id];
+        int cost = relaxed_op.h_max_supporter_cost + relaxed_op.cost;
+        for (PropID effect : get_effects(relaxed_op))
             enqueue_if_necessary(effect, cost);
     }
     while (!priority_queue.empty()) {
-        pair<int, RelaxedProposition *> top_pair = priority_queue.pop();
+        pair<int, PropID> top_pair = priority_queue.pop();
         int popped_cost = top_pair.first;
-        RelaxedProposition *prop = top_pair.second;
-        int prop_cost = prop->h_max_cost;
+        PropID prop_id = top_pair.second;
+        const RelaxedProposition &prop = propositions[prop_id];
+        int prop_cost = prop.h_max_cost;
         assert(prop_cost <= popped_cost);
         if (prop_cost < popped_cost)
             continue;
-        const vector<RelaxedOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (RelaxedOperator *relaxed_op : triggered_operators) {
-            if (relaxed_op->h_max_supporter == prop) {
-                int old_supp_cost = relaxed_op->h_max_supporter_cost;
+        for (OpID op_id : get_precondition_of(prop)) {
+            RelaxedOperator &relaxed_op = relaxed_operators[op_id];
+            if (relaxed_op.h_max_supporter == prop_id) {
+                int old_supp_cost = relaxed_op.h_max_supporter_cost;
                 if (old_supp_cost > prop_cost) {
-                    relaxed_op->update_h_max_supporter();
-                    int new_supp_cost = relaxed_op->h_max_supporter_cost;
+                    update_h_max_supporter(relaxed_op);
+                    int new_supp_cost = relaxed_op.h_max_supporter_cost;
                     if (new_supp_cost != old_supp_cost) {
                         // This operator has become cheaper.
                         assert(new_supp_cost < old_supp_cost);
-                        int target_cost = new_supp_cost + relaxed_op->cost;
-                        for (RelaxedProposition *effect : relaxed_op->effects)
+                        int target_cost = new_supp_cost + relaxed_op.cost;
+                        for (PropID effect : get_effects(relaxed_op))
                             enqueue_if_necessary(effect, target_cost);
                     }
                 }
@@ -186,42 +203,38 @@ void LandmarkCutLandmarks::first_exploration_incremental(
     }
 }
 
-void LandmarkCutLandmarks::second_exploration(
-    const State &state, vector<RelaxedProposition *> &second_exploration_queue,
-    vector<RelaxedOperator *> &cut) {
+void LandmarkCutLandmarks::second_exploration() {
     assert(second_exploration_queue.empty());
     assert(cut.empty());
 
-    artificial_precondition.status = BEFORE_GOAL_ZONE;
-    second_exploration_queue.push_back(&artificial_precondition);
+    set_zone_status(artificial_precondition, BEFORE_GOAL_ZONE);
+    second_exploration_queue.push_back(artificial_precondition);
 
-    for (FactProxy init_fact : state) {
-        RelaxedProposition *init_prop = get_proposition(init_fact);
-        init_prop->status = BEFORE_GOAL_ZONE;
+    for (PropID init_prop : initial_propositions) {
+        set_zone_status(init_prop, BEFORE_GOAL_ZONE);
         second_exploration_queue.push_back(init_prop);
     }
 
     while (!second_exploration_queue.empty()) {
-        RelaxedProposition *prop = second_exploration_queue.back();
+        PropID prop_id = second_exploration_queue.back();
         second_exploration_queue.pop_back();
-        const vector<RelaxedOperator *> &triggered_operators =
-            prop->precondition_of;
-        for (RelaxedOperator *relaxed_op : triggered_operators) {
-            if (relaxed_op->h_max_supporter == prop) {
+        for (OpID op_id : get_precondition_of(propositions[prop_id])) {
+            const RelaxedOperator &relaxed_op = relaxed_operators[op_id];
+            if (relaxed_op.h_max_supporter == prop_id) {
                 bool reached_goal_zone = false;
-                for (RelaxedProposition *effect : relaxed_op->effects) {
-                    if (effect->status == GOAL_ZONE) {
-                        assert(relaxed_op->cost > 0);
+                for (PropID effect : get_effects(relaxed_op)) {
+                    if (propositions[effect].status == GOAL_ZONE) {
+                        assert(relaxed_op.cost > 0);
                         reached_goal_zone = true;
-                        cut.push_back(relaxed_op);
+                        cut.push_back(op_id);
                         break;
                     }
                 }
                 if (!reached_goal_zone) {
-                    for (RelaxedProposition *effect : relaxed_op->effects) {
-                        if (effect->status != BEFORE_GOAL_ZONE) {
-                            assert(effect->status == REACHED);
-                            effect->status = BEFORE_GOAL_ZONE;
+                    for (PropID effect : get_effects(relaxed_op)) {
+                        if (propositions[effect].status != BEFORE_GOAL_ZONE) {
+                            assert(propositions[effect].status == REACHED);
+                            set_zone_status(effect, BEFORE_GOAL_ZONE);
                             second_exploration_queue.push_back(effect);
                         }
                     }
@@ -231,16 +244,25 @@ void LandmarkCutLandmarks::second_exploration(
     }
 }
 
-void LandmarkCutLandmarks::mark_goal_plateau(RelaxedProposition *subgoal) {
-    // NOTE: subgoal can be null if we got here via recursion through
-    // a zero-cost action that is relaxed unreachable. (This can only
+void LandmarkCutLandmarks::mark_goal_plateau(PropID subgoal) {
+    // NOTE: A supporter can be NO_PROPOSITION if we got here via a
+    // zero-cost action that is relaxed unreachable. (This can only
     // happen in domains which have zero-cost actions to start with.)
     // For example, this happens in pegsol-strips #01.
-    if (subgoal && subgoal->status != GOAL_ZONE) {
-        subgoal->status = GOAL_ZONE;
-        for (RelaxedOperator *achiever : subgoal->effect_of)
-            if (achiever->cost == 0)
-                mark_goal_plateau(achiever->h_max_supporter);
+    assert(goal_plateau_stack.empty());
+    goal_plateau_stack.push_back(subgoal);
+    while (!goal_plateau_stack.empty()) {
+        PropID prop_id = goal_plateau_stack.back();
+        goal_plateau_stack.pop_back();
+        if (prop_id == NO_PROPOSITION ||
+            propositions[prop_id].status == GOAL_ZONE)
+            continue;
+        set_zone_status(prop_id, GOAL_ZONE);
+        for (OpID achiever_id : get_effect_of(propositions[prop_id])) {
+            const RelaxedOperator &achiever = relaxed_operators[achiever_id];
+            if (achiever.cost == 0)
+                goal_plateau_stack.push_back(achiever.h_max_supporter);
+        }
     }
 }
 
@@ -252,87 +274,112 @@ void LandmarkCutLandmarks::validate_h_max() const {
     for (const RelaxedOperator &op : relaxed_operators) {
         if (op.unsatisfied_preconditions) {
             bool reachable = true;
-            for (RelaxedProposition *pre : op.preconditions) {
-                if (pre->status == UNREACHED) {
+            for (PropID pre : get_preconditions(op)) {
+                if (propositions[pre].status == UNREACHED) {
                     reachable = false;
                     break;
                 }
             }
             assert(!reachable);
-            assert(!op.h_max_supporter);
+            assert(op.h_max_supporter == NO_PROPOSITION);
         } else {
-            assert(op.h_max_supporter);
+            assert(op.h_max_supporter != NO_PROPOSITION);
             int h_max_cost = op.h_max_supporter_cost;
-            assert(h_max_cost == op.h_max_supporter->h_max_cost);
-            for (RelaxedProposition *pre : op.preconditions) {
-                assert(pre->status != UNREACHED);
-                assert(pre->h_max_cost <= h_max_cost);
+            assert(h_max_cost == propositions[op.h_max_supporter].h_max_cost);
+            for (PropID pre : get_preconditions(op)) {
+                assert(propositions[pre].status != UNREACHED);
+                assert(propositions[pre].h_max_cost <= h_max_cost);
             }
         }
     }
 #endif
 }
 
+void LandmarkCutLandmarks::apply_initial_landmarks(
+    const vector<int> &initial_landmarks) {
+    initial_landmark_costs.clear();
+    for (size_t pos = 0; pos < initial_landmarks.size();) {
+        int size = initial_landmarks[pos++];
+        auto begin = initial_landmarks.begin() + pos;
+        auto end = begin + size;
+        pos += size;
+        int landmark_cost = numeric_limits<int>::max();
+        for (auto it = begin; it != end; ++it)
+            landmark_cost = min(landmark_cost, relaxed_operators[*it].cost);
+        assert(size > 0);
+        for (auto it = begin; it != end; ++it)
+            relaxed_operators[*it].cost -= landmark_cost;
+        initial_landmark_costs.push_back(landmark_cost);
+    }
+}
+
 bool LandmarkCutLandmarks::compute_landmarks(
     const State &state, CostCallback cost_callback,
-    LandmarkCallback landmark_callback) {
+    LandmarkCallback landmark_callback,
+    const vector<int> *initial_landmarks) {
     for (RelaxedOperator &op : relaxed_operators) {
         op.cost = op.base_cost;
     }
-    // The following three variables could be declared inside the loop
-    // ("second_exploration_queue" even inside second_exploration),
-    // but having them here saves reallocations and hence provides a
-    // measurable speed boost.
-    vector<RelaxedOperator *> cut;
-    Landmark landmark;
-    vector<RelaxedProposition *> second_exploration_queue;
-    first_exploration(state);
+    initial_propositions.clear();
+    for (FactProxy init_fact : state)
+        initial_propositions.push_back(get_prop_id(init_fact));
+
+    if (initial_landmarks)
+        apply_initial_landmarks(*initial_landmarks);
+
+    first_exploration();
     // validate_h_max();  // too expensive to use even in regular debug mode
-    if (artificial_goal.status == UNREACHED)
+    if (propositions[artificial_goal].status == UNREACHED)
         return true;
 
-    int num_iterations = 0;
-    while (artificial_goal.h_max_cost != 0) {
-        ++num_iterations;
-        mark_goal_plateau(&artificial_goal);
+    if (initial_landmarks) {
+        size_t pos = 0;
+        for (int landmark_cost : initial_landmark_costs) {
+            int size = (*initial_landmarks)[pos++];
+            if (landmark_cost > 0) {
+                if (cost_callback) {
+                    cost_callback(landmark_cost);
+                }
+                if (landmark_callback) {
+                    auto begin = initial_landmarks->begin() + pos;
+                    landmark.assign(begin, begin + size);
+                    landmark_callback(landmark, landmark_cost);
+                }
+            }
+            pos += size;
+        }
+    }
+
+    while (propositions[artificial_goal].h_max_cost != 0) {
+        mark_goal_plateau(artificial_goal);
         assert(cut.empty());
-        second_exploration(state, second_exploration_queue, cut);
+        second_exploration();
         assert(!cut.empty());
         int cut_cost = numeric_limits<int>::max();
-        for (RelaxedOperator *op : cut)
-            cut_cost = min(cut_cost, op->cost);
-        for (RelaxedOperator *op : cut)
-            op->cost -= cut_cost;
+        for (OpID op_id : cut)
+            cut_cost = min(cut_cost, relaxed_operators[op_id].cost);
+        for (OpID op_id : cut)
+            relaxed_operators[op_id].cost -= cut_cost;
 
         if (cost_callback) {
             cost_callback(cut_cost);
         }
         if (landmark_callback) {
             landmark.clear();
-            for (RelaxedOperator *op : cut) {
-                landmark.push_back(op->original_op_id);
+            for (OpID op_id : cut) {
+                landmark.push_back(relaxed_operators[op_id].original_op_id);
             }
             landmark_callback(landmark, cut_cost);
         }
 
-        first_exploration_incremental(cut);
+        first_exploration_incremental();
         // validate_h_max();  // too expensive to use even in regular debug mode
         cut.clear();
 
-        /*
-          Note: This could perhaps be made more efficient, for example by
-          using a round-dependent counter for GOAL_ZONE and BEFORE_GOAL_ZONE,
-          or something based on total_cost, so that we don't need a per-round
-          reinitialization.
-        */
-        for (auto &var_props : propositions) {
-            for (RelaxedProposition &prop : var_props) {
-                if (prop.status == GOAL_ZONE || prop.status == BEFORE_GOAL_ZONE)
-                    prop.status = REACHED;
-            }
-        }
-        artificial_goal.status = REACHED;
-        artificial_precondition.status = REACHED;
+        // Only reset the propositions whose status was changed in this round.
+        for (PropID prop_id : zone_propositions)
+            propositions[prop_id].status = REACHED;
+        zone_propositions.clear();
     }
     return false;
 }
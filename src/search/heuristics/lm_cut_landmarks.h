@@ -1,6 +1,8 @@
 #ifndef HEURISTICS_LM_CUT_LANDMARKS_H
 #define HEURISTICS_LM_CUT_LANDMARKS_H
 
+#include "array_pool.h"
+
 #include "../task_proxy.h"
 
 #include "../algorithms/priority_queues.h"
@@ -12,7 +14,10 @@
 
 namespace lm_cut_heuristic {
 // TODO: Fix duplication with the other relaxation heuristics.
-struct RelaxedProposition;
+using PropID = int;
+using OpID = int;
+
+const PropID NO_PROPOSITION = -1;
 
 enum PropositionStatus {
     UNREACHED = 0,
@@ -21,66 +26,123 @@ enum PropositionStatus {
     BEFORE_GOAL_ZONE = 3
 };
 
+/*
+  Operators and propositions refer to each other by their indices. The
+  lists of preconditions, effects, achievers and operators with a given
+  precondition are stored consecutively in array pools.
+*/
 struct RelaxedOperator {
     int original_op_id;
-    std::vector<RelaxedProposition *> preconditions;
-    std::vector<RelaxedProposition *> effects;
     int base_cost; // 0 for axioms, 1 for regular operators
 
     int cost;
     int unsatisfied_preconditions;
     int h_max_supporter_cost; // h_max_cost of h_max_supporter
-    RelaxedProposition *h_max_supporter;
-    RelaxedOperator(std::vector<RelaxedProposition *> &&pre,
-                    std::vector<RelaxedProposition *> &&eff,
-                    int op_id, int base)
-        : original_op_id(op_id), preconditions(pre), effects(eff), base_cost(base),
+    PropID h_max_supporter;
+
+    int num_preconditions;
+    int num_effects;
+    array_pool::ArrayPoolIndex preconditions;
+    array_pool::ArrayPoolIndex effects;
+
+    RelaxedOperator(int op_id, int base,
+                    int num_preconditions, array_pool::ArrayPoolIndex pre,
+                    int num_effects, array_pool::ArrayPoolIndex eff)
+        : original_op_id(op_id), base_cost(base),
           cost(-1), unsatisfied_preconditions(-1), h_max_supporter_cost(-1),
-          h_max_supporter(nullptr) {
+          h_max_supporter(NO_PROPOSITION),
+          num_preconditions(num_preconditions), num_effects(num_effects),
+          preconditions(pre), effects(eff) {
     }
-
-    inline void update_h_max_supporter();
 };
 
 struct RelaxedProposition {
-    std::vector<RelaxedOperator *> precondition_of;
-    std::vector<RelaxedOperator *> effect_of;
-
     PropositionStatus status;
     int h_max_cost;
+
+    int num_precondition_of;
+    int num_effect_of;
+    array_pool::ArrayPoolIndex precondition_of;
+    array_pool::ArrayPoolIndex effect_of;
+
+    RelaxedProposition()
+        : status(UNREACHED), h_max_cost(-1),
+          num_precondition_of(0), num_effect_of(0) {
+    }
 };
 
 class LandmarkCutLandmarks {
     std::vector<RelaxedOperator> relaxed_operators;
-    std::vector<std::vector<RelaxedProposition>> propositions;
-    RelaxedProposition artificial_precondition;
-    RelaxedProposition artificial_goal;
+    std::vector<RelaxedProposition> propositions;
+    // proposition_offsets[var]: PropID of the first fact of variable var
+    std::vector<PropID> proposition_offsets;
+    PropID artificial_precondition;
+    PropID artificial_goal;
     int num_propositions;
-    priority_queues::AdaptiveQueue<RelaxedProposition *> priority_queue;
+    priority_queues::AdaptiveQueue<PropID> priority_queue;
+
+    array_pool::ArrayPool operator_propositions_pool;
+    array_pool::ArrayPool proposition_operators_pool;
+
+    /*
+      Buffers that are reused between rounds and calls to avoid
+      reallocations.
+    */
+    std::vector<PropID> initial_propositions;
+    std::vector<OpID> cut;
+    std::vector<PropID> second_exploration_queue;
+    std::vector<PropID> goal_plateau_stack;
+    // Propositions whose status was set to GOAL_ZONE or BEFORE_GOAL_ZONE.
+    std::vector<PropID> zone_propositions;
+    std::vector<int> landmark;
+    std::vector<int> initial_landmark_costs;
+
+    array_pool::ArrayPoolSlice get_preconditions(const RelaxedOperator &op) const {
+        return operator_propositions_pool.get_slice(
+            op.preconditions, op.num_preconditions);
+    }
+    array_pool::ArrayPoolSlice get_effects(const RelaxedOperator &op) const {
+        return operator_propositions_pool.get_slice(op.effects, op.num_effects);
+    }
+    array_pool::ArrayPoolSlice get_precondition_of(
+        const RelaxedProposition &prop) const {
+        return proposition_operators_pool.get_slice(
+            prop.precondition_of, prop.num_precondition_of);
+    }
+    array_pool::ArrayPoolSlice get_effect_of(
+        const RelaxedProposition &prop) const {
+        return proposition_operators_pool.get_slice(
+            prop.effect_of, prop.num_effect_of);
+    }
 
-    void build_relaxed_operator(const OperatorProxy &op);
-    void add_relaxed_operator(std::vector<RelaxedProposition *> &&precondition,
-                              std::vector<RelaxedProposition *> &&effects,
+    void add_relaxed_operator(std::vector<PropID> &&precondition,
+                              const std::vector<PropID> &effects,
                               int op_id, int base_cost);
-    RelaxedProposition *get_proposition(const FactProxy &fact);
+    PropID get_prop_id(const FactProxy &fact) const;
     void setup_exploration_queue();
-    void setup_exploration_queue_state(const State &state);
-    void first_exploration(const State &state);
-    void first_exploration_incremental(std::vector<RelaxedOperator *> &cut);
-    void second_exploration(const State &state,
-                            std::vector<RelaxedProposition *> &second_exploration_queue,
-                            std::vector<RelaxedOperator *> &cut);
-
-    void enqueue_if_necessary(RelaxedProposition *prop, int cost) {
+    void setup_exploration_queue_state();
+    void first_exploration();
+    void first_exploration_incremental();
+    void second_exploration();
+    void update_h_max_supporter(RelaxedOperator &op);
+    void apply_initial_landmarks(const std::vector<int> &initial_landmarks);
+
+    void enqueue_if_necessary(PropID prop_id, int cost) {
         assert(cost >= 0);
-        if (prop->status == UNREACHED || prop->h_max_cost > cost) {
-            prop->status = REACHED;
-            prop->h_max_cost = cost;
-            priority_queue.push(cost, prop);
+        RelaxedProposition &prop = propositions[prop_id];
+        if (prop.status == UNREACHED || prop.h_max_cost > cost) {
+            prop.status = REACHED;
+            prop.h_max_cost = cost;
+            priority_queue.push(cost, prop_id);
         }
     }
 
-    void mark_goal_plateau(RelaxedProposition *subgoal);
+    void set_zone_status(PropID prop_id, PropositionStatus status) {
+        propositions[prop_id].status = status;
+        zone_propositions.push_back(prop_id);
+    }
+
+    void mark_goal_plateau(PropID subgoal);
     void validate_h_max() const;
 public:
     using Landmark = std::vector<int>;
@@ -101,19 +163,19 @@ public:
       making a copy of the landmark, so cost_callback should be used if only the
       cost of the landmark is needed.
 
+      If initial_landmarks is not nullptr, it must contain landmarks for the
+      given state, each stored as its number of operators followed by the
+      operator indices. They are used before computing any cuts: each of
+      them gets the minimal cost of its operators, which is subtracted
+      from the cost of its operators. The callbacks are called for these
+      landmarks like for the discovered ones if their cost is positive.
+
       Returns true iff state is detected as a dead end.
     */
     bool compute_landmarks(const State &state, CostCallback cost_callback,
-                           LandmarkCallback landmark_callback);
+                           LandmarkCallback landmark_callback,
+                           const std::vector<int> *initial_landmarks = nullptr);
 };
-
-inline void RelaxedOperator::update_h_max_supporter() {
-    assert(!unsatisfied_preconditions);
-    for (size_t i = 0; i < preconditions.size(); ++i)
-        if (preconditions[i]->h_max_cost > h_max_supporter->h_max_cost)
-            h_max_supporter = preconditions[i];
-    h_max_supporter_cost = h_max_supporter->h_max_cost;
-}
 }
 
 #endif
@@ -98,6 +98,11 @@ int HSPMaxHeuristic::compute_heuristic(const State &ancestor_state) {
     return total_cost;
 }
 
+void HSPMaxHeuristic::compute_heuristics(
+    const vector<State> &ancestor_states, vector<int> &values) {
+    compute_batch_values(ancestor_states, values, false, 0);
+}
+
 class HSPMaxHeuristicFeature : public plugins::TypedFeature<Evaluator, HSPMaxHeuristic> {
 public:
     HSPMaxHeuristicFeature() : TypedFeature("hmax") {
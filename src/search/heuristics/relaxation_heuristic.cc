@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <limits>
 #include <unordered_map>
 #include <vector>
 
@@ -301,4 +302,180 @@ void RelaxationHeuristic::simplify() {
         log << " done! [" << unary_operators.size() << " unary operators]" << endl;
     }
 }
+
+void RelaxationHeuristic::build_batch_operators() {
+    /*
+      Compute the depth of each unary operator in the relaxed planning
+      graph of the initial state: operators whose preconditions are all
+      reached in layer i are in layer i and reach their effects in layer
+      i + 1. Unreachable operators are put last.
+    */
+    int num_ops = unary_operators.size();
+    const int UNREACHED = numeric_limits<int>::max();
+    vector<int> prop_layer(propositions.size(), UNREACHED);
+    vector<int> op_layer(num_ops, UNREACHED);
+    for (FactProxy fact : task_proxy.get_initial_state())
+        prop_layer[get_prop_id(fact)] = 0;
+    for (int layer = 0;; ++layer) {
+        vector<PropID> new_props;
+        for (OpID op_id = 0; op_id < num_ops; ++op_id) {
+            if (op_layer[op_id] != UNREACHED)
+                continue;
+            bool applicable = true;
+            for (PropID precondition : get_preconditions(op_id)) {
+                if (prop_layer[precondition] > layer) {
+                    applicable = false;
+                    break;
+                }
+            }
+            if (applicable) {
+                op_layer[op_id] = layer;
+                new_props.push_back(unary_operators[op_id].effect);
+            }
+        }
+        if (new_props.empty())
+            break;
+        for (PropID prop_id : new_props)
+            prop_layer[prop_id] = min(prop_layer[prop_id], layer + 1);
+    }
+
+    vector<OpID> order(num_ops);
+    for (OpID op_id = 0; op_id < num_ops; ++op_id)
+        order[op_id] = op_id;
+    stable_sort(order.begin(), order.end(),
+                [&](OpID op1, OpID op2) {
+                    return op_layer[op1] < op_layer[op2];
+                });
+
+    batch_precondition_offsets.reserve(num_ops + 1);
+    batch_effects.reserve(num_ops);
+    batch_base_costs.reserve(num_ops);
+    batch_precondition_offsets.push_back(0);
+    for (OpID op_id : order) {
+        const UnaryOperator &op = unary_operators[op_id];
+        for (PropID precondition : get_preconditions(op_id))
+            batch_preconditions.push_back(precondition);
+        batch_precondition_offsets.push_back(batch_preconditions.size());
+        batch_effects.push_back(op.effect);
+        batch_base_costs.push_back(op.base_cost);
+    }
+
+    vector<vector<int>> precondition_of(propositions.size());
+    for (int i = 0; i < num_ops; ++i) {
+        for (int j = batch_precondition_offsets[i];
+             j < batch_precondition_offsets[i + 1]; ++j)
+            precondition_of[batch_preconditions[j]].push_back(i);
+    }
+    batch_precondition_of_offsets.reserve(propositions.size() + 1);
+    batch_precondition_of_offsets.push_back(0);
+    for (const vector<int> &ops : precondition_of) {
+        batch_precondition_of.insert(
+            batch_precondition_of.end(), ops.begin(), ops.end());
+        batch_precondition_of_offsets.push_back(batch_precondition_of.size());
+    }
+    batch_pending.resize(num_ops);
+}
+
+void RelaxationHeuristic::mark_batch_successors_pending(PropID prop_id) {
+    for (int k = batch_precondition_of_offsets[prop_id];
+         k < batch_precondition_of_offsets[prop_id + 1]; ++k)
+        batch_pending[batch_precondition_of[k]] = true;
+}
+
+template<bool add_costs>
+void RelaxationHeuristic::compute_batch_costs(
+    const vector<State> &states, int begin, int end, int max_cost,
+    vector<int> &values) {
+    const int INFINITE = numeric_limits<int>::max() / 2;
+    batch_costs.assign(propositions.size() * BATCH_SIZE, INFINITE);
+    for (int lane = 0; lane < end - begin; ++lane) {
+        State state = convert_ancestor_state(states[begin + lane]);
+        for (FactProxy fact : state) {
+            PropID prop_id = get_prop_id(fact);
+            batch_costs[prop_id * BATCH_SIZE + lane] = 0;
+            mark_batch_successors_pending(prop_id);
+        }
+    }
+
+    int num_ops = batch_effects.size();
+    for (int i = 0; i < num_ops; ++i) {
+        if (batch_precondition_offsets[i] == batch_precondition_offsets[i + 1])
+            batch_pending[i] = true;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < num_ops; ++i) {
+            if (!batch_pending[i])
+                continue;
+            batch_pending[i] = false;
+            int op_costs[BATCH_SIZE] = {};
+            for (int j = batch_precondition_offsets[i];
+                 j < batch_precondition_offsets[i + 1]; ++j) {
+                const int *precondition_costs =
+                    &batch_costs[batch_preconditions[j] * BATCH_SIZE];
+                for (int lane = 0; lane < BATCH_SIZE; ++lane) {
+                    if (add_costs)
+                        op_costs[lane] = min(op_costs[lane] + precondition_costs[lane], INFINITE);
+                    else
+                        op_costs[lane] = max(op_costs[lane], precondition_costs[lane]);
+                }
+            }
+            int base_cost = batch_base_costs[i];
+            PropID effect = batch_effects[i];
+            int *effect_costs = &batch_costs[effect * BATCH_SIZE];
+            int changed_bits = 0;
+            for (int lane = 0; lane < BATCH_SIZE; ++lane) {
+                int cost = min(op_costs[lane] + base_cost, INFINITE);
+                if (add_costs)
+                    cost = (cost == INFINITE) ? INFINITE : min(cost, max_cost);
+                int old_cost = effect_costs[lane];
+                int new_cost = min(old_cost, cost);
+                changed_bits |= old_cost ^ new_cost;
+                effect_costs[lane] = new_cost;
+            }
+            if (changed_bits) {
+                mark_batch_successors_pending(effect);
+                // Operators before i are only evaluated in the next sweep.
+                if (batch_precondition_of_offsets[effect] <
+                    batch_precondition_of_offsets[effect + 1] &&
+                    batch_precondition_of[batch_precondition_of_offsets[effect]] <= i)
+                    changed = true;
+            }
+        }
+    }
+
+    for (int lane = 0; lane < end - begin; ++lane) {
+        int value = 0;
+        for (PropID goal_id : goal_propositions) {
+            int goal_cost = batch_costs[goal_id * BATCH_SIZE + lane];
+            if (goal_cost == INFINITE) {
+                value = DEAD_END;
+                break;
+            }
+            if (add_costs)
+                value = min(value + goal_cost, max_cost);
+            else
+                value = max(value, goal_cost);
+        }
+        values[begin + lane] = value;
+    }
+}
+
+void RelaxationHeuristic::compute_batch_values(
+    const vector<State> &states, vector<int> &values,
+    bool add_costs, int max_cost) {
+    if (batch_precondition_offsets.empty())
+        build_batch_operators();
+    int num_states = states.size();
+    values.resize(num_states);
+    for (int begin = 0; begin < num_states; begin += BATCH_SIZE) {
+        int end = min(begin + BATCH_SIZE, num_states);
+        if (add_costs)
+            compute_batch_costs<true>(states, begin, end, max_cost, values);
+        else
+            compute_batch_costs<false>(states, begin, end, max_cost, values);
+    }
+}
 }
@@ -60,6 +60,32 @@ class RelaxationHeuristic : public Heuristic {
 
     // proposition_offsets[var_no]: first PropID related to variable var_no
     std::vector<PropID> proposition_offsets;
+
+    static const int BATCH_SIZE = 16;
+    /*
+      Unary operators in sweep order for batch evaluation. They are built
+      on the first batch evaluation. The preconditions of the i-th operator
+      are batch_preconditions[batch_precondition_offsets[i]] up to
+      batch_preconditions[batch_precondition_offsets[i + 1] - 1].
+    */
+    std::vector<int> batch_precondition_offsets;
+    std::vector<PropID> batch_preconditions;
+    std::vector<PropID> batch_effects;
+    std::vector<int> batch_base_costs;
+    // Indices of the operators in sweep order that have p as precondition.
+    std::vector<int> batch_precondition_of_offsets;
+    std::vector<int> batch_precondition_of;
+    std::vector<int> batch_costs;
+    // Operators whose preconditions changed since they were last swept.
+    std::vector<bool> batch_pending;
+
+    void mark_batch_successors_pending(PropID prop_id);
+
+    void build_batch_operators();
+    template<bool add_costs>
+    void compute_batch_costs(
+        const std::vector<State> &states, int begin, int end, int max_cost,
+        std::vector<int> &values);
 protected:
     std::vector<UnaryOperator> unary_operators;
     std::vector<Proposition> propositions;
@@ -109,6 +135,28 @@ protected:
     const Proposition *get_proposition(int var, int value) const;
     Proposition *get_proposition(int var, int value);
     Proposition *get_proposition(const FactProxy &fact);
+
+    /*
+      Batch evaluation: compute h^max (add_costs == false) or h^add
+      (add_costs == true) for several states at once and store the
+      heuristic values (or DEAD_END) in values. h^add costs are clamped to
+      max_cost like in the additive heuristic.
+
+      Up to BATCH_SIZE states are explored simultaneously. Their costs
+      are stored as a structure of arrays with one lane per state
+      (batch_costs[prop_id * BATCH_SIZE + lane]), so the inner loops
+      process all lanes together and are vectorized by the compiler.
+      Since a priority queue does not vectorize, the costs are computed
+      by sweeping over the unary operators until nothing changes. A sweep
+      only evaluates operators with a precondition whose cost changed
+      since they were last evaluated. The operators are sorted by their
+      depth in the relaxed planning graph of the initial state, so that
+      most of them are evaluated after their preconditions and the
+      sweeps converge quickly.
+    */
+    void compute_batch_values(
+        const std::vector<State> &states, std::vector<int> &values,
+        bool add_costs, int max_cost);
 public:
     explicit RelaxationHeuristic(const plugins::Options &options);
 
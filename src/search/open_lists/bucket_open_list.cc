@@ -0,0 +1,314 @@
+#include "bucket_open_list.h"
+
+#include "../evaluator.h"
+#include "../open_list.h"
+
+#include "../plugins/plugin.h"
+#include "../utils/memory.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+namespace bucket_open_list {
+static const int MAX_EVALUATORS = 3;
+/*
+  Entries whose first key is in [0, NUM_DENSE_KEYS) are stored in an array
+  of buckets, all other entries (e.g., with infinite or very large keys) in
+  a map of buckets.
+*/
+static const int NUM_DENSE_KEYS = 1 << 16;
+
+// Keys are stored inline. Unused components are 0.
+using Key = array<int, MAX_EVALUATORS>;
+
+/*
+  Bucket for a single evaluator. Entries are removed in FIFO order from a
+  vector. Its removed prefix is discarded when the bucket runs empty or the
+  prefix makes up half of the vector.
+*/
+template<class Entry>
+class FifoBucket {
+    vector<Entry> entries;
+    size_t first;
+public:
+    FifoBucket()
+        : first(0) {
+    }
+
+    bool empty() const {
+        return first == entries.size();
+    }
+
+    void push(const Key &, const Entry &entry) {
+        entries.push_back(entry);
+    }
+
+    Entry pop() {
+        assert(!empty());
+        Entry result = entries[first++];
+        if (first == entries.size()) {
+            entries.clear();
+            first = 0;
+        } else if (first >= 64 && 2 * first >= entries.size()) {
+            entries.erase(entries.begin(), entries.begin() + first);
+            first = 0;
+        }
+        return result;
+    }
+
+    void clear() {
+        entries.clear();
+        first = 0;
+    }
+};
+
+/*
+  Bucket for several evaluators. All entries of a bucket share the first key.
+  They are kept in FIFO buckets for the distinct values of the remaining keys,
+  sorted by these values. There are usually few distinct values per bucket,
+  so a sorted vector is cheaper than a map or a heap.
+*/
+template<class Entry>
+class TieBreakingBucket {
+    using SubBucket = pair<Key, FifoBucket<Entry>>;
+    vector<SubBucket> sub_buckets;
+public:
+    bool empty() const {
+        return sub_buckets.empty();
+    }
+
+    void push(const Key &key, const Entry &entry) {
+        auto it = lower_bound(
+            sub_buckets.begin(), sub_buckets.end(), key,
+            [](const SubBucket &sub_bucket, const Key &key) {
+                return sub_bucket.first < key;
+            });
+        if (it == sub_buckets.end() || it->first != key)
+            it = sub_buckets.emplace(it, key, FifoBucket<Entry>());
+        it->second.push(key, entry);
+    }
+
+    Entry pop() {
+        assert(!empty());
+        FifoBucket<Entry> &sub_bucket = sub_buckets.front().second;
+        Entry result = sub_bucket.pop();
+        if (sub_bucket.empty())
+            sub_buckets.erase(sub_buckets.begin());
+        return result;
+    }
+
+    void clear() {
+        sub_buckets.clear();
+    }
+};
+
+template<class Entry, class Bucket>
+class BucketOpenList : public OpenList<Entry> {
+    vector<Bucket> dense_buckets;
+    // No dense bucket with a smaller index is non-empty.
+    int min_dense_key;
+    map<int, Bucket> sparse_buckets;
+    int size;
+
+    vector<shared_ptr<Evaluator>> evaluators;
+    /*
+      If allow_unsafe_pruning is true, we ignore (don't insert) states
+      which the first evaluator considers a dead end, even if it is
+      not a safe heuristic.
+    */
+    bool allow_unsafe_pruning;
+
+protected:
+    virtual void do_insertion(EvaluationContext &eval_context,
+                              const Entry &entry) override;
+
+public:
+    explicit BucketOpenList(const plugins::Options &opts);
+    virtual ~BucketOpenList() override = default;
+
+    virtual Entry remove_min() override;
+    virtual bool empty() const override;
+    virtual void clear() override;
+    virtual void get_path_dependent_evaluators(set<Evaluator *> &evals) override;
+    virtual bool is_dead_end(
+        EvaluationContext &eval_context) const override;
+    virtual bool is_reliable_dead_end(
+        EvaluationContext &eval_context) const override;
+};
+
+
+template<class Entry, class Bucket>
+BucketOpenList<Entry, Bucket>::BucketOpenList(const plugins::Options &opts)
+    : OpenList<Entry>(opts.get<bool>("pref_only")),
+      min_dense_key(numeric_limits<int>::max()),
+      size(0),
+      evaluators(opts.get_list<shared_ptr<Evaluator>>("evals")),
+      allow_unsafe_pruning(opts.get<bool>("unsafe_pruning")) {
+    assert(!evaluators.empty() &&
+           static_cast<int>(evaluators.size()) <= MAX_EVALUATORS);
+}
+
+template<class Entry, class Bucket>
+void BucketOpenList<Entry, Bucket>::do_insertion(
+    EvaluationContext &eval_context, const Entry &entry) {
+    Key key {};
+    for (size_t i = 0; i < evaluators.size(); ++i)
+        key[i] = eval_context.get_evaluator_value_or_infinity(evaluators[i].get());
+
+    int first_key = key[0];
+    if (first_key >= 0 && first_key < NUM_DENSE_KEYS) {
+        if (first_key >= static_cast<int>(dense_buckets.size()))
+            dense_buckets.resize(first_key + 1);
+        dense_buckets[first_key].push(key, entry);
+        min_dense_key = min(min_dense_key, first_key);
+    } else {
+        sparse_buckets[first_key].push(key, entry);
+    }
+    ++size;
+}
+
+template<class Entry, class Bucket>
+Entry BucketOpenList<Entry, Bucket>::remove_min() {
+    assert(size > 0);
+    --size;
+    int num_dense_buckets = dense_buckets.size();
+    while (min_dense_key < num_dense_buckets &&
+           dense_buckets[min_dense_key].empty())
+        ++min_dense_key;
+    /*
+      Negative keys are stored in the sparse buckets, so the sparse buckets
+      come first if they contain one.
+    */
+    if (min_dense_key < num_dense_buckets &&
+        (sparse_buckets.empty() || sparse_buckets.begin()->first >= 0)) {
+        return dense_buckets[min_dense_key].pop();
+    }
+    auto it = sparse_buckets.begin();
+    assert(it != sparse_buckets.end());
+    Entry result = it->second.pop();
+    if (it->second.empty())
+        sparse_buckets.erase(it);
+    return result;
+}
+
+template<class Entry, class Bucket>
+bool BucketOpenList<Entry, Bucket>::empty() const {
+    return size == 0;
+}
+
+template<class Entry, class Bucket>
+void BucketOpenList<Entry, Bucket>::clear() {
+    // Keep the dense buckets to reuse their memory.
+    for (Bucket &bucket : dense_buckets)
+        bucket.clear();
+    min_dense_key = numeric_limits<int>::max();
+    sparse_buckets.clear();
+    size = 0;
+}
+
+template<class Entry, class Bucket>
+void BucketOpenList<Entry, Bucket>::get_path_dependent_evaluators(
+    set<Evaluator *> &evals) {
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        evaluator->get_path_dependent_evaluators(evals);
+}
+
+template<class Entry, class Bucket>
+bool BucketOpenList<Entry, Bucket>::is_dead_end(
+    EvaluationContext &eval_context) const {
+    // Same behaviour as the tie-breaking open list.
+    if (is_reliable_dead_end(eval_context))
+        return true;
+    if (allow_unsafe_pruning &&
+        eval_context.is_evaluator_value_infinite(evaluators[0].get()))
+        return true;
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        if (!eval_context.is_evaluator_value_infinite(evaluator.get()))
+            return false;
+    return true;
+}
+
+template<class Entry, class Bucket>
+bool BucketOpenList<Entry, Bucket>::is_reliable_dead_end(
+    EvaluationContext &eval_context) const {
+    for (const shared_ptr<Evaluator> &evaluator : evaluators)
+        if (eval_context.is_evaluator_value_infinite(evaluator.get()) &&
+            evaluator->dead_ends_are_reliable())
+            return true;
+    return false;
+}
+
+template<class Entry>
+static unique_ptr<OpenList<Entry>> create_bucket_open_list(const plugins::Options &options) {
+    if (options.get_list<shared_ptr<Evaluator>>("evals").size() == 1) {
+        return utils::make_unique_ptr<BucketOpenList<Entry, FifoBucket<Entry>>>(options);
+    } else {
+        return utils::make_unique_ptr<BucketOpenList<Entry, TieBreakingBucket<Entry>>>(options);
+    }
+}
+
+BucketOpenListFactory::BucketOpenListFactory(const plugins::Options &options)
+    : options(options) {
+}
+
+unique_ptr<StateOpenList>
+BucketOpenListFactory::create_state_open_list() {
+    return create_bucket_open_list<StateOpenListEntry>(options);
+}
+
+unique_ptr<EdgeOpenList>
+BucketOpenListFactory::create_edge_open_list() {
+    return create_bucket_open_list<EdgeOpenListEntry>(options);
+}
+
+class BucketOpenListFeature : public plugins::TypedFeature<OpenListFactory, BucketOpenListFactory> {
+public:
+    BucketOpenListFeature() : TypedFeature("bucket") {
+        document_title("Bucket open list");
+        document_synopsis(
+            "Open list that orders entries lexicographically by the values of "
+            "up to three evaluators and breaks remaining ties in FIFO order. "
+            "With one evaluator, entries are expanded in the same order as with "
+            "the open list 'single', with several evaluators in the same order "
+            "as with 'tiebreaking'.");
+
+        add_list_option<shared_ptr<Evaluator>>("evals", "evaluators (at most three)");
+        add_option<bool>(
+            "pref_only",
+            "insert only nodes generated by preferred operators", "false");
+        add_option<bool>(
+            "unsafe_pruning",
+            "allow unsafe pruning when the main evaluator regards a state a dead end",
+            "true");
+
+        document_note(
+            "Implementation Notes",
+            "Entries are stored in buckets that are kept in an array indexed by "
+            "the value of the first evaluator. Values below 0 or of at least 2^16 "
+            "are stored in a map of buckets instead. With one evaluator, a bucket "
+            "is a FIFO queue, otherwise a sorted vector of FIFO queues, one for "
+            "each combination of values of the remaining evaluators. Inserting "
+            "and removing an entry therefore takes amortized constant time with "
+            "one evaluator and time O(k) with several evaluators, where k is the "
+            "number of distinct values of the remaining evaluators in the bucket, "
+            "plus the time for skipping empty buckets when the minimum value "
+            "grows.");
+    }
+
+    virtual shared_ptr<BucketOpenListFactory> create_component(const plugins::Options &options, const utils::Context &context) const override {
+        plugins::verify_list_non_empty<shared_ptr<Evaluator>>(context, options, "evals");
+        if (options.get_list<shared_ptr<Evaluator>>("evals").size() > MAX_EVALUATORS) {
+            context.error("The bucket open list supports at most three evaluators.");
+        }
+        return make_shared<BucketOpenListFactory>(options);
+    }
+};
+
+static plugins::FeaturePlugin<BucketOpenListFeature> _plugin;
+}
@@ -0,0 +1,27 @@
+#ifndef OPEN_LISTS_BUCKET_OPEN_LIST_H
+#define OPEN_LISTS_BUCKET_OPEN_LIST_H
+
+#include "../open_list_factory.h"
+
+#include "../plugins/options.h"
+
+/*
+  Open list indexed by one to three ints, ordered lexicographically with FIFO
+  tie-breaking. It orders entries like the best-first open list (one
+  evaluator) and the tie-breaking open list (several evaluators), but stores
+  them in an array of buckets indexed by the first key instead of a map.
+*/
+
+namespace bucket_open_list {
+class BucketOpenListFactory : public OpenListFactory {
+    plugins::Options options;
+public:
+    explicit BucketOpenListFactory(const plugins::Options &options);
+    virtual ~BucketOpenListFactory() override = default;
+
+    virtual std::unique_ptr<StateOpenList> create_state_open_list() override;
+    virtual std::unique_ptr<EdgeOpenList> create_edge_open_list() override;
+};
+}
+
+#endif
@@ -1,21 +1,44 @@
 #include "command_line.h"
+#include "concurrent_state_registry_benchmark.h"
 #include "search_algorithm.h"
 
+#include "heuristics/cg_cache.h"
 #include "tasks/root_task.h"
 #include "tasks/simplified_task.h"
+#include "task_utils/successor_generator.h"
 #include "task_utils/task_properties.h"
 #include "utils/logging.h"
+#include "utils/mapped_memory.h"
 #include "utils/system.h"
 #include "utils/timer.h"
 #include "safe_abstraction/compositor.h"
 #include "safe_abstraction/abstractor.h"
 #include "safe_abstraction/refiner.h"
+#include "safe_abstraction/hierarchy_cache.h"
 
+#include <charconv>
 #include <iostream>
+#include <sstream>
+#include <memory>
 
 using namespace std;
 using utils::ExitCode;
 
+// Returns the positive number that follows the given prefix of a safe abstraction option.
+static int parsePositiveOption(const string &option, const string &prefix)
+{
+    const char *begin = option.data() + prefix.size();
+    const char *end = option.data() + option.size();
+    int value = 0;
+    auto [rest, error] = from_chars(begin, end, value);
+    if (error != errc() || rest != end || value < 1)
+    {
+        cerr << "Invalid safe abstraction option: " << option << endl;
+        utils::exit_with(ExitCode::SEARCH_INPUT_ERROR);
+    }
+    return value;
+}
+
 int main(int argc, const char **argv) {
     utils::register_event_handlers();
 
@@ -30,19 +53,13 @@ int main(int argc, const char **argv) {
       simplified task to a plan for the original task.
     */
     shared_ptr<AbstractTask> original_task;
+    // The task as it was read. The refined plan refers to its operators.
+    shared_ptr<AbstractTask> input_task;
 
     vector<pair<abstractor, compositor>> abstraction_hirarchy;
+    bool costOptimalRefinement = false;
 
     if (static_cast<string>(argv[1]) != "--help") {
-        utils::g_log << "reading input..." << endl;
-        tasks::read_root_task(cin);
-        utils::g_log << "done reading input!" << endl;
-        TaskProxy task_proxy(*tasks::g_root_task);
-        unit_cost = task_properties::is_unit_cost(task_proxy);
-        original_task = tasks::g_root_task;
-
-        std::cout << std::endl << "============================ SAFE ABSTRACTION ==========================" << std::endl;
-
         /*
         Remo: Assume that the first of the arguments passed to the search
         component (the one after '--search') encodes the info we need.
@@ -53,6 +70,112 @@ int main(int argc, const char **argv) {
         // --abstraction - no composition
         // --composition - Irrelevant
         // --none
+        // The mode can be followed by comma separated options, e.g. --all,threads=8
+        //   threads=N - number of threads used to search for compositable variable pairs (default 1)
+        //   refinement=length|cost - insert the shortest (default) or the cheapest free paths when refining the plan
+        //   cache=DIR - directory in which the abstraction hierarchy is stored and from which it is reused by later runs
+        //   external_memory=DIR - directory in which the search keeps its per-state data in memory-mapped files instead of RAM
+        //   cg_cache=DIR - directory in which the caches of the CG heuristic are stored and from which they are reused by later runs
+        //   successor_generator=tree|compiled|bit_parallel - compute applicable operators with a tree of nodes (default), with the tree compiled into a flat program or by testing all preconditions on the packed states
+        //   benchmark_state_registry=N - only measure the throughput of the concurrent state registry with up to N threads on states of the input task
+        int numCompositionThreads = 1;
+        int numBenchmarkThreads = 0;
+        string cacheDirectory;
+        size_t optionStart = myargstring.find(',');
+        if (optionStart != string::npos)
+        {
+            string options = myargstring.substr(optionStart + 1);
+            myargstring = myargstring.substr(0, optionStart);
+            stringstream optionStream(options);
+            string option;
+            while (getline(optionStream, option, ','))
+            {
+                if (option.rfind("threads=", 0) == 0)
+                {
+                    numCompositionThreads = parsePositiveOption(option, "threads=");
+                }
+                else if (option == "refinement=length") { costOptimalRefinement = false; }
+                else if (option == "refinement=cost") { costOptimalRefinement = true; }
+                else if (option.rfind("cache=", 0) == 0)
+                {
+                    cacheDirectory = option.substr(string("cache=").size());
+                }
+                else if (option.rfind("external_memory=", 0) == 0)
+                {
+                    utils::g_external_memory_directory = option.substr(string("external_memory=").size());
+                }
+                else if (option.rfind("cg_cache=", 0) == 0)
+                {
+                    cg_heuristic::g_cg_cache_directory = option.substr(string("cg_cache=").size());
+                }
+                else if (option.rfind("benchmark_state_registry=", 0) == 0)
+                {
+                    numBenchmarkThreads = parsePositiveOption(option, "benchmark_state_registry=");
+                }
+                else if (option == "successor_generator=tree")
+                {
+                    successor_generator::g_successor_generator_type = successor_generator::SuccessorGeneratorType::TREE;
+                }
+                else if (option == "successor_generator=compiled")
+                {
+                    successor_generator::g_successor_generator_type = successor_generator::SuccessorGeneratorType::COMPILED;
+                }
+                else if (option == "successor_generator=bit_parallel")
+                {
+                    successor_generator::g_successor_generator_type = successor_generator::SuccessorGeneratorType::BIT_PARALLEL;
+                }
+                else
+                {
+                    cerr << "Unknown safe abstraction option: " << option << endl;
+                    utils::exit_with(ExitCode::SEARCH_INPUT_ERROR);
+                }
+            }
+        }
+        utils::g_log << "reading input..." << endl;
+        //The cache is keyed by the input, so the input has to be kept around as text to hash it
+        string inputText;
+        if (!cacheDirectory.empty())
+        {
+            stringstream inputStream;
+            inputStream << cin.rdbuf();
+            inputText = inputStream.str();
+            istringstream in(inputText);
+            tasks::read_root_task(in);
+        }
+        else
+        {
+            tasks::read_root_task(cin);
+        }
+        utils::g_log << "done reading input!" << endl;
+        TaskProxy task_proxy(*tasks::g_root_task);
+        if (numBenchmarkThreads > 0)
+        {
+            concurrent_state_registry_benchmark::run_benchmark(task_proxy, numBenchmarkThreads, utils::g_log);
+            return static_cast<int>(ExitCode::SUCCESS);
+        }
+        unit_cost = task_properties::is_unit_cost(task_proxy);
+        original_task = tasks::g_root_task;
+        input_task = tasks::g_root_task;
+
+        std::cout << std::endl << "============================ SAFE ABSTRACTION ==========================" << std::endl;
+
+        /*
+        With a cache directory the decisions of every step are stored on disk and replayed
+        by later runs on the same input (and mode) instead of searching for them again.
+        */
+        std::unique_ptr<hierarchyCache> cache;
+        vector<hierarchyCache::Step> cachedSteps;
+        bool replayCache = false;
+        if (!cacheDirectory.empty())
+        {
+            cache = std::make_unique<hierarchyCache>(cacheDirectory, inputText, myargstring);
+            replayCache = cache->load(cachedSteps);
+            if (replayCache) { cout << "Loaded abstraction hierarchy from " << cache->getPath() << endl; }
+        }
+        bool savedStepsAreComplete = replayCache;
+        vector<hierarchyCache::Step> executedSteps;
+        size_t numReplayedSteps = 0;
+
         bool doAbstraction = false;
         bool doComposition = false;
         // How often should we perform a composition without a new abstraction before giving up? (-1 means no limit)
@@ -86,6 +209,12 @@ int main(int argc, const char **argv) {
         utils::Timer abstraction_timer(false);
       	utils::Timer composition_timer(false);
 
+        /*
+        The abstractor of the next step is derived from the one of the current step,
+        so that free DTGs of untouched variables are reused instead of rebuilt.
+        */
+        std::unique_ptr<abstractor> nextAbstractor = std::make_unique<abstractor>(tasks::g_root_task);
+
         while (continiueAbstraction)
         {
         	cout << endl;
@@ -93,10 +222,27 @@ int main(int argc, const char **argv) {
 
             // = ABSTRACTOR =
             original_task = tasks::g_root_task;
-            abstractor abstractor(original_task);
-            std::list<int> safe_variables;
             abstraction_timer.resume();
-            if (doAbstraction){ safe_variables = abstractor.find_safe_variables(); }
+            abstractor abstractor = *nextAbstractor;
+            if (replayCache && numReplayedSteps == cachedSteps.size())
+            {
+                cout << "Stored abstraction hierarchy ended early, continuing without it" << endl;
+                replayCache = false;
+                savedStepsAreComplete = false;
+            }
+            if (replayCache && !hierarchyCache::isValidAbstraction(cachedSteps[numReplayedSteps], *original_task))
+            {
+                cout << "Stored abstraction hierarchy does not fit the task, continuing without it" << endl;
+                replayCache = false;
+                savedStepsAreComplete = false;
+            }
+            std::list<int> safe_variables;
+            if (replayCache)
+            {
+                safe_variables = cachedSteps[numReplayedSteps].safeVariables;
+                if (doAbstraction) { abstractor.ensureFreeDTGs(); }
+            }
+            else if (doAbstraction){ safe_variables = abstractor.find_safe_variables(); }
 
             if (!safe_variables.empty())
             {
@@ -118,8 +264,8 @@ int main(int argc, const char **argv) {
             }
 
             shared_ptr<tasks::RootTask> original_root_task = dynamic_pointer_cast<tasks::RootTask>(original_task);
-            shared_ptr<tasks::SimplifiedTask> simplified_task = make_shared<tasks::SimplifiedTask>(original_root_task, safe_variables);
-            tasks::g_root_task = simplified_task;
+            shared_ptr<tasks::SimplifiedTask> abstracted_task = make_shared<tasks::SimplifiedTask>(original_root_task, safe_variables);
+            tasks::g_root_task = abstracted_task;
             abstraction_timer.stop();
 
             // = COMPOSITOR ==
@@ -130,7 +276,17 @@ int main(int argc, const char **argv) {
                 doComposition = false;
             }
             composition_timer.resume();
-            compositor compositor(original_task, maxSequenceLength, doHarshComposition, doComposition);
+            if (replayCache && !hierarchyCache::isValidComposition(cachedSteps[numReplayedSteps], *original_task))
+            {
+                cout << "Stored abstraction hierarchy does not fit the task, continuing without it" << endl;
+                replayCache = false;
+                savedStepsAreComplete = false;
+            }
+            compositor compositor = replayCache
+                ? ::compositor(original_task, cachedSteps[numReplayedSteps].compositedOperatorIDs, cachedSteps[numReplayedSteps].compositeOperators, cachedSteps[numReplayedSteps].decompositOperations)
+                : ::compositor(original_task, maxSequenceLength, doHarshComposition, doComposition, numCompositionThreads);
+            executedSteps.push_back({safe_variables, compositor.compositedOperatorIDs, compositor.compositeOperators, compositor.getDecompositOperationIDs()});
+            if (replayCache) { numReplayedSteps++; }
             if (!compositor.compositeOperators.empty())
             {
             	numCompositeOperators += compositor.compositeOperators.size();
@@ -145,7 +301,8 @@ int main(int argc, const char **argv) {
             }
 
             original_root_task = dynamic_pointer_cast<tasks::RootTask>(original_task);
-            simplified_task = make_shared<tasks::SimplifiedTask>(original_root_task, compositor);
+            shared_ptr<tasks::SimplifiedTask> simplified_task = make_shared<tasks::SimplifiedTask>(original_root_task, compositor);
+            compositor.setCompositedTask(simplified_task);
             tasks::g_root_task = simplified_task;
             composition_timer.stop();
 
@@ -159,6 +316,16 @@ int main(int argc, const char **argv) {
             {
             	step++;
                 abstraction_hirarchy.push_back(make_pair(abstractor, compositor));
+                abstraction_timer.resume();
+                //Operator of the task of this step every operator of the simplified task stems from (-1 for composite operators)
+                vector<int> operatorOrigins(simplified_task->get_num_operators());
+                for (int op = 0; op < simplified_task->get_num_operators(); ++op)
+                {
+                    int abstractedOp = simplified_task->get_parent_operator_id(op);
+                    operatorOrigins[op] = abstractedOp < simplified_task->get_num_parent_operators() ? abstracted_task->get_parent_operator_id(abstractedOp) : -1;
+                }
+                *nextAbstractor = abstractor.next(tasks::g_root_task, safe_variables, operatorOrigins);
+                abstraction_timer.stop();
             }
             task_proxy = TaskProxy(*tasks::g_root_task);
 
@@ -174,6 +341,8 @@ int main(int argc, const char **argv) {
             }
         }
 
+        if (cache && !savedStepsAreComplete) { cache->save(executedSteps); }
+
         float abstractionPercentage = (float)numSafeVariables / numOriginalVariables;
 
 		int abstractedAtoms = numOriginalAtoms;
@@ -189,6 +358,7 @@ int main(int argc, const char **argv) {
         cout << "Abstracted " << abstractionPercentageAtoms*100 << "% of atoms" << endl;
         cout << "Created " << numCompositeOperators << " composite operators." << endl;
         cout << "Original task had: " << numOperatorsInOriginalTask << " operators" << endl;
+        cout << "Simplified task has: " << task_proxy.get_operators().size() << " operators" << endl;
         cout << endl;
       	cout << "Abstraction time: " << abstraction_timer << endl;
         cout << "Composition time: " << composition_timer << endl;
@@ -225,13 +395,17 @@ int main(int argc, const char **argv) {
       {
         cout << endl;
         utils::Timer refinement_timer;
-        Plan refinedPlan = refiner::refine_plan(search_algorithm->get_plan(), abstraction_hirarchy);
+        Plan refinedPlan = refiner::refine_plan(search_algorithm->get_plan(), abstraction_hirarchy, costOptimalRefinement);
         refinement_timer.stop();
         cout << "Refinement time: " << refinement_timer << endl;
         search_algorithm->set_plan(refinedPlan);
       }
       cout << endl;
-      search_algorithm->save_plan_if_necessary();
+      if (search_algorithm->found_solution())
+      {
+        // The refined plan refers to the operators of the input task, not the simplified one the search ran on.
+        search_algorithm->get_plan_manager().save_plan(search_algorithm->get_plan(), TaskProxy(*input_task));
+      }
       search_algorithm->print_statistics();
 
       utils::g_log << "Search time: " << search_timer << endl;
@@ -250,12 +424,12 @@ int main(int argc, const char **argv) {
       Plan emptyPlan;
       cout << endl;
       utils::Timer refinement_timer;
-      Plan refinedPlan = refiner::refine_plan(emptyPlan, abstraction_hirarchy);
+      Plan refinedPlan = refiner::refine_plan(emptyPlan, abstraction_hirarchy, costOptimalRefinement);
       refinement_timer.stop();
       cout << "Refinement time: " << refinement_timer << endl;
       cout << endl;
       PlanManager plan_manager;
-      plan_manager.save_plan(refinedPlan, task_proxy);
+      plan_manager.save_plan(refinedPlan, TaskProxy(*input_task));
       utils::g_timer.stop();
       utils::g_log << "Search time: 0.0s" << endl;
       utils::g_log << "Total time: " << utils::g_timer << endl;
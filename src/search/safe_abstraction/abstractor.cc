@@ -5,6 +5,8 @@
 #include "free_domain_transition_graph.h"
 #include "../tasks/root_task.h"
 
+#include <cassert>
+
 std::list<int> abstractor::find_safe_variables()
 {
   cout << "> Running Abstractor" << endl;
@@ -18,7 +20,7 @@ std::list<int> abstractor::find_safe_variables()
   At the same time it collects information about which values per variable are externally required and externally caused.
    */
 
-  create_free_domain_transition_graphs();
+  ensureFreeDTGs();
 
   for (auto &free_dtg : freeDTGs)
   {
@@ -115,84 +117,213 @@ std::list<int> abstractor::find_safe_variables()
 
 void abstractor::create_free_domain_transition_graphs()
 {
+    std::vector<int> initialValues = abstractTask->get_initial_state_values();
+    operatorsByVariable.assign(taskProxy.get_variables().size(), std::vector<int>());
     for (VariableProxy variable : taskProxy.get_variables())
     {
 		freeDTG free_dtg(variable.get_id(), variable.get_domain_size());
         //Adding initial value as externallyCaused
-    	free_dtg.externallyCaused(abstractTask->get_initial_state_values()[variable.get_id()]);;
+    	free_dtg.externallyCaused(initialValues[variable.get_id()]);
         freeDTGs.push_back(free_dtg);
     }
 
     for (auto op : taskProxy.get_operators())
     {
-    	std::vector<std::pair<int, int>> precon_facts;
-    	for (auto precondition : op.get_preconditions())
+        std::set<int> mentionedVariables;
+    	for (auto precondition : op.get_preconditions()) { mentionedVariables.insert(precondition.get_variable().get_id()); }
+        for (auto postcondition : op.get_effects()) { mentionedVariables.insert(postcondition.get_fact().get_variable().get_id()); }
+        for (int var : mentionedVariables) { operatorsByVariable[var].push_back(op.get_id()); }
+
+        addOperator(op);
+    }
+    for (auto &free_dtg : freeDTGs) { free_dtg.finalize(); }
+}
+
+/*
+Builds the free DTGs of a task from the free DTGs of the previous abstraction step instead of rescanning every operator.
+
+Between two steps only the removed variables (which shifts the ids of the remaining ones) and the removed/added
+(composite) operators (which shifts the ids of the remaining operators) change the task. The free DTG of a variable only depends on the operators that mention it,
+so all free DTGs whose operators were left untouched are copied over with their new variable and operator ids and only the
+affected variables are rebuilt from their operator list.
+ */
+abstractor::abstractor(std::shared_ptr<AbstractTask> abstractTask, const abstractor &previous, const std::list<int> &removedVariables, const std::vector<int> &operatorOrigins)
+    : abstractTask(abstractTask), taskProxy(*abstractTask)
+{
+    //The previous step never needed its free DTGs, so there is nothing to reuse. They will be built on demand.
+    if (previous.freeDTGs.empty()) { return; }
+
+    const AbstractTask &previousTask = *previous.abstractTask;
+    int numPreviousVariables = previousTask.get_num_variables();
+    int numPreviousOperators = previousTask.get_num_operators();
+    int numVariables = abstractTask->get_num_variables();
+    int numOperators = abstractTask->get_num_operators();
+
+    //Remap table: previous variable id -> new variable id (-1 if the variable was removed)
+    std::vector<int> variableRemap(numPreviousVariables, 0);
+    for (int var : removedVariables) { variableRemap[var] = -1; }
+    int newID = 0;
+    for (int var = 0; var < numPreviousVariables; ++var)
+    {
+        if (variableRemap[var] != -1) { variableRemap[var] = newID++; }
+    }
+    assert(newID == numVariables);
+
+    //Remap table: previous operator id -> new operator id (-1 if the operator was removed)
+    std::vector<int> operatorRemap(numPreviousOperators, -1);
+    for (int opID = 0; opID < numOperators; ++opID)
+    {
+        if (operatorOrigins[opID] != -1) { operatorRemap[operatorOrigins[opID]] = opID; }
+    }
+
+    std::vector<bool> affected(numVariables, false);
+    auto markPreviousOperator = [&](int opID)
+    {
+        for (int i = 0; i < previousTask.get_num_operator_preconditions(opID, false); ++i)
         {
-        	int precon_var = precondition.get_variable().get_id();
-            int precon_val = precondition.get_value();
-            precon_facts.push_back(std::make_pair(precon_var, precon_val));
+            int var = variableRemap[previousTask.get_operator_precondition(opID, i, false).var];
+            if (var != -1) { affected[var] = true; }
+        }
+        for (int i = 0; i < previousTask.get_num_operator_effects(opID, false); ++i)
+        {
+            int var = variableRemap[previousTask.get_operator_effect(opID, i, false).var];
+            if (var != -1) { affected[var] = true; }
         }
+    };
+    //Operators that lost the conditions on removed variables
+    for (int var : removedVariables)
+    {
+        for (int opID : previous.operatorsByVariable[var]) { markPreviousOperator(opID); }
+    }
+    //Operators that were removed (replaced by composite operators or left without effects)
+    for (int opID = 0; opID < numPreviousOperators; ++opID)
+    {
+        if (operatorRemap[opID] == -1) { markPreviousOperator(opID); }
+    }
 
-        std::vector<std::pair<int, int>> postcon_facts;
-        for (auto postcondition : op.get_effects())
+    operatorsByVariable.assign(numVariables, std::vector<int>());
+    for (int var = 0; var < numPreviousVariables; ++var)
+    {
+        if (variableRemap[var] == -1) { continue; }
+        for (int opID : previous.operatorsByVariable[var])
         {
-        	auto postcondition_fact = postcondition.get_fact();
-            int postcon_var = postcondition_fact.get_variable().get_id();
-            int postcon_val = postcondition_fact.get_value();
-            postcon_facts.push_back(std::make_pair(postcon_var, postcon_val));
+            if (operatorRemap[opID] != -1) { operatorsByVariable[variableRemap[var]].push_back(operatorRemap[opID]); }
+        }
+    }
+    //Newly added (composite) operators come behind the previous ones, which keeps the lists sorted.
+    for (int opID = 0; opID < numOperators; ++opID)
+    {
+        if (operatorOrigins[opID] != -1) { continue; }
+        std::set<int> mentionedVariables;
+        OperatorProxy op = taskProxy.get_operators()[opID];
+    	for (auto precondition : op.get_preconditions()) { mentionedVariables.insert(precondition.get_variable().get_id()); }
+        for (auto postcondition : op.get_effects()) { mentionedVariables.insert(postcondition.get_fact().get_variable().get_id()); }
+        for (int var : mentionedVariables)
+        {
+            operatorsByVariable[var].push_back(opID);
+            affected[var] = true;
         }
+    }
+
+    std::vector<int> initialValues = abstractTask->get_initial_state_values();
+    freeDTGs.reserve(numVariables);
+    int numRebuilt = 0;
+    for (int var = 0; var < numPreviousVariables; ++var)
+    {
+        int newVar = variableRemap[var];
+        if (newVar == -1) { continue; }
+        if (!affected[newVar])
+        {
+            freeDTGs.push_back(previous.freeDTGs[var].remapped(newVar, operatorRemap));
+        }
+        else
+        {
+            freeDTG free_dtg(newVar, abstractTask->get_variable_domain_size(newVar));
+            free_dtg.externallyCaused(initialValues[newVar]);
+            freeDTGs.push_back(free_dtg);
+            for (int opID : operatorsByVariable[newVar]) { addOperator(taskProxy.get_operators()[opID], newVar); }
+            numRebuilt++;
+        }
+    }
+    for (auto &free_dtg : freeDTGs) { free_dtg.finalize(); }
+    cout << "Reused " << numVariables - numRebuilt << " and rebuilt " << numRebuilt << " free DTGs" << endl;
+}
+
+/*
+Adds the free transitions and the externally required / caused values induced by the operator to the free DTGs.
+If onlyVariable is set, only the free DTG of that variable is updated.
+ */
+void abstractor::addOperator(OperatorProxy op, int onlyVariable)
+{
+    std::vector<std::pair<int, int>> precon_facts;
+    for (auto precondition : op.get_preconditions())
+    {
+        int precon_var = precondition.get_variable().get_id();
+        int precon_val = precondition.get_value();
+        precon_facts.push_back(std::make_pair(precon_var, precon_val));
+    }
+
+    std::vector<std::pair<int, int>> postcon_facts;
+    for (auto postcondition : op.get_effects())
+    {
+        auto postcondition_fact = postcondition.get_fact();
+        int postcon_var = postcondition_fact.get_variable().get_id();
+        int postcon_val = postcondition_fact.get_value();
+        postcon_facts.push_back(std::make_pair(postcon_var, postcon_val));
+    }
 
-        bool freeOperation = false;
+    auto isUpdated = [onlyVariable](int var) { return onlyVariable == -1 || onlyVariable == var; };
+    bool freeOperation = false;
 
-        if (precon_facts.size() < 2 && postcon_facts.size() < 2)
+    if (precon_facts.size() < 2 && postcon_facts.size() < 2)
+    {
+        //if (precon_facts.size() == 0) { freeOperation = true; }
+        //if (postcon_facts.size() == 0) { freeOperation = true; }
+        if (precon_facts.size() == 1 && postcon_facts.size() == 1)
         {
-        	//if (precon_facts.size() == 0) { freeOperation = true; }
-            //if (postcon_facts.size() == 0) { freeOperation = true; }
-            if (precon_facts.size() == 1 && postcon_facts.size() == 1)
+            if (precon_facts[0].first == postcon_facts[0].first)
             {
-            	if (precon_facts[0].first == postcon_facts[0].first)
+                freeOperation = true;
+                if (isUpdated(precon_facts[0].first))
                 {
-                	freeOperation = true;
-        			freeDTG free_dtg = *find_freeDTG_by_variable(precon_facts[0].first);
-                	free_dtg.addTransition(precon_facts[0].second, postcon_facts[0].second, op.get_id());
+                    find_freeDTG_by_variable(precon_facts[0].first)->addTransition(precon_facts[0].second, postcon_facts[0].second, op.get_id(), op.get_cost());
                 }
             }
         }
+    }
 
-        if (!freeOperation)
-        {
-        	//Mark relevant precons as externally required
-        	for (auto precon_fact : precon_facts) {
-            	for (auto postcon_fact : postcon_facts) {
-            		if (precon_fact.first != postcon_fact.first)
-            		{
-            			find_freeDTG_by_variable(precon_fact.first)->externallyRequired(precon_fact.second);
-            		}
-            	}
-        	}
-        	//Mark relevant postcons as externally caused
-        	//This can be optimised by not looping over all postcons for each postcon, instead only those who wasn't compared to yet.
-        	for (auto postcon_fact_1 : postcon_facts) {
-        		for (auto postcon_fact_2 : postcon_facts) {
-                	if (postcon_fact_1.first != postcon_fact_2.first)
-            		{
-            			find_freeDTG_by_variable(postcon_fact_1.first)->externallyCaused(postcon_fact_1.second);
-                    	find_freeDTG_by_variable(postcon_fact_2.first)->externallyCaused(postcon_fact_2.second);
-            		}
-            	}
-        	}
+    if (!freeOperation)
+    {
+        //Mark relevant precons as externally required
+        for (auto precon_fact : precon_facts) {
+            if (!isUpdated(precon_fact.first)) { continue; }
+            for (auto postcon_fact : postcon_facts) {
+                if (precon_fact.first != postcon_fact.first)
+                {
+                    find_freeDTG_by_variable(precon_fact.first)->externallyRequired(precon_fact.second);
+                }
+            }
+        }
+        //Mark relevant postcons as externally caused
+        //This can be optimised by not looping over all postcons for each postcon, instead only those who wasn't compared to yet.
+        for (auto postcon_fact_1 : postcon_facts) {
+            for (auto postcon_fact_2 : postcon_facts) {
+                if (postcon_fact_1.first != postcon_fact_2.first)
+                {
+                    if (isUpdated(postcon_fact_1.first)) { find_freeDTG_by_variable(postcon_fact_1.first)->externallyCaused(postcon_fact_1.second); }
+                    if (isUpdated(postcon_fact_2.first)) { find_freeDTG_by_variable(postcon_fact_2.first)->externallyCaused(postcon_fact_2.second); }
+                }
+            }
         }
     }
 }
 
 freeDTG* abstractor::find_freeDTG_by_variable(int var_id)
 {
-	for (auto &free_dtg : freeDTGs) {
-		if (free_dtg.getVariable() == var_id) {
-			return &free_dtg;
-		}
-	}
-	return nullptr;
+	//The free DTGs are stored in order of their variable ids
+	if (var_id < 0 || var_id >= (int)freeDTGs.size()) { return nullptr; }
+	assert(freeDTGs[var_id].getVariable() == var_id);
+	return &freeDTGs[var_id];
 }
 
 void abstractor::printResults(bool extReqValAreStronglyConnected, bool allReqReachableByCaused, bool goalReachableByRequired, freeDTG *free_dtg)
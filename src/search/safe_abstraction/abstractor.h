@@ -5,14 +5,18 @@
 #include "free_domain_transition_graph.h"
 #include "../tasks/root_task.h"
 
+#include <set>
 
 class abstractor {
   std::shared_ptr<AbstractTask> abstractTask;
   TaskProxy taskProxy;
   std::vector<freeDTG> freeDTGs;
+  //Operators (by id) that have a precondition or an effect on the variable. Kept sorted so that rebuilt free DTGs match a full rebuild.
+  std::vector<std::vector<int>> operatorsByVariable;
 
   private:
     void create_free_domain_transition_graphs();
+    void addOperator(OperatorProxy op, int onlyVariable = -1);
     void printResults(bool extReqValAreStronglyConnected, bool allReqReachableByCaused, bool goalReachableByRequired, freeDTG *free_dtg);
     void printOperations();
     void printTask();
@@ -21,7 +25,18 @@ class abstractor {
       abstractor(std::shared_ptr<AbstractTask> abstractTask)
           : abstractTask(abstractTask), taskProxy(*abstractTask)
       {}
+      abstractor(std::shared_ptr<AbstractTask> abstractTask, const abstractor &previous, const std::list<int> &removedVariables, const std::vector<int> &operatorOrigins);
+      /*
+      Abstractor for the task of the next abstraction step, reusing the free DTGs of this one.
+      operatorOrigins holds for every operator of the next task the id of the operator of this task it stems from (-1 for new operators).
+      */
+      abstractor next(std::shared_ptr<AbstractTask> nextTask, const std::list<int> &removedVariables, const std::vector<int> &operatorOrigins) const
+      {
+          return abstractor(nextTask, *this, removedVariables, operatorOrigins);
+      }
       std::list<int> find_safe_variables();
+      //Builds the free DTGs if they weren't built (or derived from the previous step) yet. The refiner needs them.
+      void ensureFreeDTGs() { if (freeDTGs.empty()) { create_free_domain_transition_graphs(); } }
       std::shared_ptr<AbstractTask> getAbstractTask() { return abstractTask; }
       TaskProxy getTaskProxy() { return taskProxy; }
       freeDTG* find_freeDTG_by_variable(int var_id);
@@ -1,5 +1,35 @@
 #include "compositor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+compositor::compositor(std::shared_ptr<AbstractTask> abstractTask, std::set<int> compositedOperatorIDs, std::vector<tasks::ExplicitOperator> compositeOperators,
+                       const std::map<int, std::vector<int>> &decompositOperationIDs)
+    : abstractTask(abstractTask), taskProxy(*abstractTask), maxSequenceLength(0), isHarsh(false), numThreads(1),
+      compositedOperatorIDs(std::move(compositedOperatorIDs)), compositeOperators(std::move(compositeOperators))
+{
+    for (const auto &[compositeID, operatorIDs] : decompositOperationIDs)
+    {
+        std::vector<OperatorProxy> &operations = decompositOperations[compositeID];
+        for (int opID : operatorIDs) { operations.push_back(taskProxy.get_operators()[opID]); }
+    }
+}
+
+std::map<int, std::vector<int>> compositor::getDecompositOperationIDs() const
+{
+    std::map<int, std::vector<int>> decompositOperationIDs;
+    for (const auto &[compositeID, operations] : decompositOperations)
+    {
+        std::vector<int> &operatorIDs = decompositOperationIDs[compositeID];
+        for (const OperatorProxy &op : operations) { operatorIDs.push_back(op.get_id()); }
+    }
+    return decompositOperationIDs;
+}
+
 void compositor::composite()
 {
   	std::cout << "> Running Compositor" << std::endl;
@@ -9,120 +39,240 @@ void compositor::composite()
        	return;
     }
 
-    int pairCounter = 0;
+    //Fact -> operator index used to answer all A / B / notB queries below
+    index = std::make_shared<const operatorIndex>(taskProxy);
+    goalValues.assign(taskProxy.get_variables().size(), -1);
+    for (FactProxy goal : taskProxy.get_goals()) { goalValues[goal.get_variable().get_id()] = goal.get_value(); }
 
     auto vars = taskProxy.get_variables();
 	int varSize = taskProxy.get_variables().size();
-    int firstVarIndex = 0;
-    int secondVarIndex = 1;
+    //All variable pairs in the order in which they are tried. The first pair that removes the causal coupling is used.
+    std::vector<std::pair<int, int>> varPairs;
+    for (int firstVarIndex = 0; firstVarIndex < varSize-1; firstVarIndex++)
+    {
+        for (int secondVarIndex = firstVarIndex+1; secondVarIndex < varSize; secondVarIndex++)
+        {
+            varPairs.push_back(std::make_pair(firstVarIndex, secondVarIndex));
+        }
+    }
 
-    while (firstVarIndex < varSize-1)
-	{
-    	//cout << firstVarIndex << ", " << secondVarIndex << std::endl;
-        auto varPair = std::make_pair(vars[firstVarIndex], vars[secondVarIndex]);
-        pairCounter++;
-        secondVarIndex++;
-        if (secondVarIndex >= varSize)
+    PairComposition composition;
+    int foundPair = -1;
+    if (numThreads > 1)
+    {
+        foundPair = compositePairsInParallel(varPairs, composition);
+    }
+    else
+    {
+        for (int i = 0; i < (int)varPairs.size(); i++)
         {
-        	firstVarIndex++;
-        	secondVarIndex = firstVarIndex+1;
+            if (compositePair(varPairs[i], composition, std::cout))
+            {
+                foundPair = i;
+                break;
+            }
+            composition = PairComposition();
         }
+    }
 
-        bool notSafe = false;
+    if (foundPair != -1)
+    {
+        compositedOperatorIDs = std::move(composition.compositedOperatorIDs);
+        compositeOperators = std::move(composition.compositeOperators);
+        decompositOperations = std::move(composition.decompositOperations);
+        auto varPair = std::make_pair(vars[varPairs[foundPair].first], vars[varPairs[foundPair].second]);
+        cout << "Tried " << foundPair+1 << " variable pairs and found a causal decoupling for "; printPair(varPair); cout << endl;
+        return;
+    }
+    cout << "Tried " << varPairs.size() << " variable pairs and did NOT find a causal decoupling" << endl;
+}
 
-    	std::vector<std::pair<std::set<int>, std::set<int>>> compositeTargets;
-	    int count = 0;
-    	double averageA = 0;
-    	double averageB = 0;
+/*
+Tries to composite the operators of one variable pair. Only reads from the task, all results are written to composition.
+Returns true if the composition removes the causal coupling of the pair.
+ */
+bool compositor::compositePair(std::pair<int, int> varIndices, PairComposition &composition, std::ostream &log) const
+{
+    auto vars = taskProxy.get_variables();
+    auto varPair = std::make_pair(vars[varIndices.first], vars[varIndices.second]);
 
-    	std::vector<std::vector<std::pair<int, int>>> C = getC(varPair); //Pass pair
+    bool notSafe = false;
 
-        //printPair(varPair); cout << endl;
-    	for (auto c : C)
-    	{
-        	if (!isHarsh) { notSafe = false; }
-            //print_c(c); cout<<endl;
-    		std::pair<std::set<int>, std::set<int>> newTargets = getCompositeTargets(c);
-            //if (newTargets.first.empty())
-            //{
-            //	cout << "A is empty." << endl;
-            //	notSafe = true; break;
-            //}
-            if (!notBIsCommutative(newTargets.first, newTargets.second, c))
-            {
-            	//cout << "NotB is not commutative" << endl;
-                notSafe = true;
-                if (isHarsh) { break; }
-            }
-            else if (!notAIsInconsistentOrDisjoint(newTargets.first, newTargets.second, c))
+    std::vector<std::pair<std::set<int>, std::set<int>>> compositeTargets;
+    int count = 0;
+    double averageA = 0;
+    double averageB = 0;
+
+    std::vector<std::vector<std::pair<int, int>>> C = getC(varPair); //Pass pair
+
+    //printPair(varPair); cout << endl;
+    for (auto c : C)
+    {
+        if (!isHarsh) { notSafe = false; }
+        //print_c(c); cout<<endl;
+        std::pair<std::set<int>, std::set<int>> newTargets = getCompositeTargets(c);
+        //if (newTargets.first.empty())
+        //{
+        //	cout << "A is empty." << endl;
+        //	notSafe = true; break;
+        //}
+        if (!notBIsCommutative(newTargets.first, newTargets.second, c))
+        {
+            //cout << "NotB is not commutative" << endl;
+            notSafe = true;
+            if (isHarsh) { break; }
+        }
+        else if (!notAIsInconsistentOrDisjoint(newTargets.first, newTargets.second, c))
+        {
+            notSafe = true;
+            if (isHarsh) { break; }
+        }
+        else if (!effectsOfAInconsistentOrDisjointWithGoal(newTargets.first, log))
+        {
+            notSafe = true;
+            if (isHarsh) { break; }
+        }
+        else if (!notSafe)
+        {
+            compositeTargets.push_back(newTargets);
+            count++;
+            averageA += (newTargets.first.size() - averageA) / count;
+            averageB += (newTargets.second.size() - averageB) / count;
+            //cout << "B has: " << newTargets.second.size() << endl;
+            //if (newTargets.second.size() > 1) {notSafe = true; break;}
+        }
+    }
+    if (isHarsh && notSafe)
+    {
+        //cout << "c not safe." << endl;
+        //printPair(varPair);
+        //cout << " composition is NOT safe" << endl;
+        return false;
+    }
+    //If break: continiue;
+
+    //std::cout << "Found " << compositeTargets.size() << " composition target set pairs " << std::endl;
+    if (compositeTargets.size() > 0)
+    {
+        //std::cout << "Average length of A: " << averageA << std::endl;
+        //std::cout << "Average length of B: " << averageB << std::endl;
+        std::vector<std::vector<OperatorProxy>> compositeChain = generateCompositeOperations(compositeTargets, composition);
+
+        //std::cout << "Creating decomposition map..." << std::endl;
+        int newIndex = taskProxy.get_operators().size();
+        for (auto c : compositeChain)
+        {
+            composition.decompositOperations[newIndex] = c;
+            newIndex++;
+        }
+    }
+
+    //Test for second contition with compositeOperators
+    //True: Return;
+    //False: Next variable pair
+    return removesCausalCoupling(varPair, composition.compositeOperators) && composition.compositeOperators.size() > 0;
+}
+
+/*
+Scans the variable pairs with numThreads worker threads. Every worker starts on its own contiguous range of pairs and
+steals the upper half of the largest remaining range of another worker once its own range is exhausted.
+
+The result is the same as for the sequential scan: the pair with the lowest index that removes the causal coupling
+wins. Pairs behind the best pair found so far are skipped, and the log output of the pairs up to the winning pair is
+printed in order once all workers are done.
+ */
+int compositor::compositePairsInParallel(const std::vector<std::pair<int, int>> &varPairs, PairComposition &composition) const
+{
+    struct PairRange {
+        std::mutex mutex;
+        int next = 0;
+        int end = 0;
+    };
+
+    int numPairs = varPairs.size();
+    int numWorkers = std::max(1, std::min(numThreads, numPairs));
+    std::vector<PairRange> ranges(numWorkers);
+    for (int w = 0; w < numWorkers; w++)
+    {
+        ranges[w].next = (int)((long long)numPairs * w / numWorkers);
+        ranges[w].end = (int)((long long)numPairs * (w+1) / numWorkers);
+    }
+
+    std::atomic<int> bestPair(numPairs);
+    std::mutex bestMutex;
+    std::vector<std::string> logs(numPairs);
+
+    auto takePair = [&](int worker)
+    {
+        {
+            std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+            if (ranges[worker].next < ranges[worker].end) { return ranges[worker].next++; }
+        }
+        while (true)
+        {
+            int victim = -1;
+            int mostRemaining = 0;
+            for (int w = 0; w < numWorkers; w++)
             {
-            	notSafe = true;
-                if (isHarsh) { break; }
+                if (w == worker) { continue; }
+                std::lock_guard<std::mutex> lock(ranges[w].mutex);
+                int remaining = std::min(ranges[w].end, bestPair.load() + 1) - ranges[w].next;
+                if (remaining > mostRemaining) { mostRemaining = remaining; victim = w; }
             }
-            else if (!effectsOfAInconsistentOrDisjointWithGoal(newTargets.first))
+            if (victim == -1) { return -1; }
+
+            int stolenBegin;
+            int stolenEnd;
             {
-            	notSafe = true;
-                if (isHarsh) { break; }
+                std::lock_guard<std::mutex> lock(ranges[victim].mutex);
+                if (ranges[victim].next >= ranges[victim].end) { continue; } //Somebody else was faster
+                stolenEnd = ranges[victim].end;
+                stolenBegin = ranges[victim].next + (stolenEnd - ranges[victim].next) / 2;
+                ranges[victim].end = stolenBegin;
             }
-    		else if (!notSafe)
-    		{
-            	compositeTargets.push_back(newTargets);
-    			count++;
-    			averageA += (newTargets.first.size() - averageA) / count;
-    			averageB += (newTargets.second.size() - averageB) / count;
-    			//cout << "B has: " << newTargets.second.size() << endl;
-    			//if (newTargets.second.size() > 1) {notSafe = true; break;}
-    		}
-    	}
-    	if (isHarsh && notSafe)
-        {
-          	//cout << "c not safe." << endl;
-            //printPair(varPair);
-            //cout << " composition is NOT safe" << endl;
-        	continue;
+            std::lock_guard<std::mutex> lock(ranges[worker].mutex);
+            ranges[worker].next = stolenBegin + 1;
+            ranges[worker].end = stolenEnd;
+            return stolenBegin;
         }
-    	//If break: continiue;
+    };
 
-    	//std::cout << "Found " << compositeTargets.size() << " composition target set pairs " << std::endl;
-    	if (compositeTargets.size() > 0)
-    	{
-        	//std::cout << "Average length of A: " << averageA << std::endl;
-        	//std::cout << "Average length of B: " << averageB << std::endl;
-        	std::vector<std::vector<OperatorProxy>> compositeChain = generateCompositeOperations(compositeTargets);
-
-        	//std::cout << "Creating decomposition map..." << std::endl;
-    		int newIndex = taskProxy.get_operators().size();
-    		for (auto c : compositeChain)
-    		{
-        		decompositOperations[newIndex] = c;
-        		newIndex++;
-    		}
-   		}
-
-    	//Test for second contition with compositeOperators
-    	//True: Return;
-   	 	//False: Clear(); Next variable pair
-    	if (removesCausalCoupling(varPair) && compositeOperators.size() > 0)
+    auto work = [&](int worker)
+    {
+        for (int i = takePair(worker); i != -1; i = takePair(worker))
         {
-          //cout << "Causal Coupling is removed." << endl;
-          cout << "Tried " << pairCounter << " variable pairs and found a causal decoupling for "; printPair(varPair); cout << endl;
-          return;
+            if (i > bestPair.load()) { continue; } //A pair with a lower index already removes the causal coupling
+
+            PairComposition pairComposition;
+            std::ostringstream log;
+            bool decouples = compositePair(varPairs[i], pairComposition, log);
+            logs[i] = log.str();
+            if (decouples)
+            {
+                std::lock_guard<std::mutex> lock(bestMutex);
+                if (i < bestPair.load())
+                {
+                    bestPair.store(i);
+                    composition = std::move(pairComposition);
+                }
+            }
         }
-    	else
-    	{
-            //printPair(varPair);
-			//cout << " causal Coupling is NOT removed." << endl;
-    		compositedOperatorIDs.clear();
-    		compositeOperators.clear();
-    		decompositOperations.clear();
-    	}
-    }
-    cout << "Tried " << pairCounter << " variable pairs and did NOT find a causal decoupling" << endl;
+    };
+
+    std::vector<std::thread> workers;
+    for (int w = 1; w < numWorkers; w++) { workers.emplace_back(work, w); }
+    work(0);
+    for (std::thread &worker : workers) { worker.join(); }
+
+    int foundPair = bestPair.load() < numPairs ? bestPair.load() : -1;
+    int lastPair = foundPair != -1 ? foundPair : numPairs - 1;
+    for (int i = 0; i <= lastPair; i++) { std::cout << logs[i]; }
+    return foundPair;
 }
 
-bool compositor::removesCausalCoupling(std::pair<VariableProxy, VariableProxy> varPair)
+bool compositor::removesCausalCoupling(std::pair<VariableProxy, VariableProxy> varPair, const std::vector<tasks::ExplicitOperator> &compositeOperators) const
 {
-	for (auto compOp : compositeOperators)
+	for (const auto &compOp : compositeOperators)
 	{
         int var1Precon = -1;
         int var2Precon = -1;
@@ -162,7 +312,7 @@ bool compositor::removesCausalCoupling(std::pair<VariableProxy, VariableProxy> v
 	return true; //return true if all is good
 }
 
-std::vector<std::vector<OperatorProxy>> compositor::generateCompositeOperations(std::vector<std::pair<std::set<int>, std::set<int>>> compositeTargets)
+std::vector<std::vector<OperatorProxy>> compositor::generateCompositeOperations(const std::vector<std::pair<std::set<int>, std::set<int>>> &compositeTargets, PairComposition &composition) const
 {
 	//std::cout << "Generating composite operations..." << std::endl;
 	std::vector<std::vector<OperatorProxy>> compositionList;
@@ -176,10 +326,10 @@ std::vector<std::vector<OperatorProxy>> compositor::generateCompositeOperations(
             std::vector<OperatorProxy> compositeOperation;
         	compositeOperation.push_back(taskProxy.get_operators()[A]);
 
-            auto expandedOperations = expandCompositeOperation(compositeOperation, B);
+            auto expandedOperations = expandCompositeOperation(compositeOperation, B, composition);
             compositionList.insert(compositionList.end(), expandedOperations.begin(), expandedOperations.end());
 
-            if (expandedOperations.size() > 0) {compositedOperatorIDs.insert(A);} //If expanded chains are found mark A
+            if (expandedOperations.size() > 0) {composition.compositedOperatorIDs.insert(A);} //If expanded chains are found mark A
         }
     }
     double sumOfLength = 0;
@@ -192,7 +342,7 @@ std::vector<std::vector<OperatorProxy>> compositor::generateCompositeOperations(
     return compositionList;
 }
 
-std::vector<std::vector<OperatorProxy>> compositor::expandCompositeOperation(std::vector<OperatorProxy> compositeOperation, std::set<int> targets)
+std::vector<std::vector<OperatorProxy>> compositor::expandCompositeOperation(const std::vector<OperatorProxy> &compositeOperation, const std::set<int> &targets, PairComposition &composition) const
 {
 	std::vector<std::vector<OperatorProxy>>	compositionList;
 
@@ -206,13 +356,13 @@ std::vector<std::vector<OperatorProxy>> compositor::expandCompositeOperation(std
     	if (isCompositeOperationExecutable(expandedCompositeOperation))
         {
         	tasks::ExplicitOperator newOperator = createExplicitOperator(expandedCompositeOperation);
-            if (!isUniqueOperator(newOperator)) {return compositionList;}
+            if (!isUniqueOperator(newOperator, composition.compositeOperators)) {return compositionList;}
 
-            compositeOperators.push_back(newOperator);
-        	compositedOperatorIDs.insert(b);
+            composition.compositeOperators.push_back(newOperator);
+        	composition.compositedOperatorIDs.insert(b);
         	compositionList.push_back(expandedCompositeOperation);
 
-        	auto expandedOperations = expandCompositeOperation(expandedCompositeOperation, targets);
+        	auto expandedOperations = expandCompositeOperation(expandedCompositeOperation, targets, composition);
             compositionList.insert(compositionList.end(), expandedOperations.begin(), expandedOperations.end());
         }
     }
@@ -220,7 +370,7 @@ std::vector<std::vector<OperatorProxy>> compositor::expandCompositeOperation(std
     return compositionList;
 }
 
-bool compositor::isCompositeOperationExecutable(std::vector<OperatorProxy> compositeOperation)
+bool compositor::isCompositeOperationExecutable(const std::vector<OperatorProxy> &compositeOperation) const
 {
     std::map<int, int> state;
     for (int i = 0; i < compositeOperation.size(); i++)
@@ -252,14 +402,14 @@ bool compositor::isCompositeOperationExecutable(std::vector<OperatorProxy> compo
     return true;
 }
 
-tasks::ExplicitOperator compositor::createExplicitOperator(std::vector<OperatorProxy> compOp)
+tasks::ExplicitOperator compositor::createExplicitOperator(const std::vector<OperatorProxy> &compOp) const
 {
       std::map<int, int> state;
 
       vector<FactPair> preconditions;
       set<FactPair> preconditionsSet;
       vector<tasks::ExplicitEffect> effects;
-      int cost;
+      int cost = 0;
       string name = "[CO:";
       bool is_an_axiom = false;
 
@@ -295,22 +445,22 @@ tasks::ExplicitOperator compositor::createExplicitOperator(std::vector<OperatorP
       tasks::ExplicitOperator compositeOP = tasks::ExplicitOperator(preconditions, effects, cost, name, is_an_axiom);
       return compositeOP;
 }
-bool compositor::isUniqueOperator(tasks::ExplicitOperator newOperator)
+bool compositor::isUniqueOperator(const tasks::ExplicitOperator &newOperator, const std::vector<tasks::ExplicitOperator> &compositeOperators) const
 {
-	for(auto op : compositeOperators)
+	for(const auto &op : compositeOperators)
     {
           if (areIdenticalOperators(op, newOperator)) {return false;}
     }
     return true;
 }
 
-bool compositor::areIdenticalOperators(tasks::ExplicitOperator a, tasks::ExplicitOperator b)
+bool compositor::areIdenticalOperators(const tasks::ExplicitOperator &a, const tasks::ExplicitOperator &b) const
 {
 	if (a.preconditions.size() != b.preconditions.size()) {return false;}
     if (a.effects.size() != b.effects.size()) {return false;}
 
-    auto aPreCons = a.preconditions;
-    auto bPreCons = b.preconditions;
+    const auto &aPreCons = a.preconditions;
+    const auto &bPreCons = b.preconditions;
     for (auto aPre : aPreCons)
     {
     	bool matched = false;
@@ -325,8 +475,8 @@ bool compositor::areIdenticalOperators(tasks::ExplicitOperator a, tasks::Explici
         if (!matched) {return false;}
     }
 
-    auto aPostCons = a.effects;
-    auto bPostCons = b.effects;
+    const auto &aPostCons = a.effects;
+    const auto &bPostCons = b.effects;
     for (auto aPost : aPostCons)
     {
     	bool matched = false;
@@ -343,108 +493,95 @@ bool compositor::areIdenticalOperators(tasks::ExplicitOperator a, tasks::Explici
     return true;
 }
 
-bool compositor::notBIsCommutative(std::set<int> A, std::set<int> B, std::vector<std::pair<int, int>> c)
+/*
+notB is the set of operators that are not in B and are consistent with c. The operators of notB must commute with all
+operators of A and B. Instead of comparing every operator of notB with every operator of A and B, we go over the
+preconditions and effects of A and B and only look at the operators that produce / consume a different value of the
+same variable, since only those can conflict.
+ */
+bool compositor::notBIsCommutative(const std::set<int> &A, const std::set<int> &B, const std::vector<std::pair<int, int>> &c) const
 {
-    bool isCommutative = true;
-	std::set<int> notB;
-    std::set<int> AUB = A;
-    AUB.insert(B.begin(), B.end());
-
-    for (auto op : taskProxy.get_operators())
+    auto isInNotB = [&](int opID)
     {
-    	if (B.count(op.get_id()) == 0)
-    	{
-        	bool consistentWithC = true;
-
-        	for (auto pre : op.get_preconditions())
+        if (B.count(opID) > 0) { return false; }
+        for (const auto &fact : c)
+        {
+            int preVal = index->getPreconditionValue(opID, fact.first);
+            if (preVal != -1 && preVal != fact.second) { return false; }
+        }
+        return true;
+    };
+    //Does an operator of notB produce (or consume) a value of var other than val?
+    auto notBProducesOtherValue = [&](int var, int val)
+    {
+        for (int otherVal = 0; otherVal < index->getNumValues(var); ++otherVal)
+        {
+            if (otherVal == val) { continue; }
+            for (const int *op = index->producersBegin(var, otherVal); op != index->producersEnd(var, otherVal); ++op)
             {
-            	for (auto fact : c)
-                {
-                	if (pre.get_pair().var == fact.first && pre.get_pair().value != fact.second) {consistentWithC = false; break;}
-                }
-                if (!consistentWithC) {break;}
+                if (isInNotB(*op)) { return true; }
             }
-            if (consistentWithC) {notB.insert(op.get_id());}
         }
-    }
+        return false;
+    };
+    auto notBConsumesOtherValue = [&](int var, int val)
+    {
+        for (int otherVal = 0; otherVal < index->getNumValues(var); ++otherVal)
+        {
+            if (otherVal == val) { continue; }
+            for (const int *op = index->consumersBegin(var, otherVal); op != index->consumersEnd(var, otherVal); ++op)
+            {
+                if (isInNotB(*op)) { return true; }
+            }
+        }
+        return false;
+    };
 
-    for (auto notb : notB)
+    std::set<int> AUB = A;
+    AUB.insert(B.begin(), B.end());
+
+    for (auto aub : AUB)
     {
-    	auto notbOp = taskProxy.get_operators()[notb];
-        for (auto aub : AUB)
+        auto aubOp = taskProxy.get_operators()[aub];
+        for (auto aubPrecon : aubOp.get_preconditions())
         {
-        	auto aubOp = taskProxy.get_operators()[aub];
-            for (auto notbEffect : notbOp.get_effects())
-        	{
-        		for (auto aubPrecon : aubOp.get_preconditions()){
-           			if (notbEffect.get_fact().get_pair().var == aubPrecon.get_pair().var) {
-						if (notbEffect.get_fact().get_pair().value != aubPrecon.get_pair().value)
-                        {
-                            //std::cout << notbOp.get_name() << " and " << aubOp.get_name() << " are not commutative (notb.effect -> aub.precon)" << std::endl;
-                        	return false;
-                        }
-                    }
-            	}
-
-                for (auto aubEffect : aubOp.get_effects()){
-                	if (notbEffect.get_fact().get_pair().var == aubEffect.get_fact().get_pair().var) {
-                        if (notbEffect.get_fact().get_pair().value != aubEffect.get_fact().get_pair().value)
-                        {
-                        	//std::cout << notbOp.get_name() << " and " << aubOp.get_name() << " are not commutative (notb.effect <-> aub.effect)" << std::endl;
-							return false;
-                        }
-                    }
-        		}
-        	}
-
-            for (auto aubEffect : aubOp.get_effects()){
-        		for (auto notbPrecon : notbOp.get_preconditions()){
-           			if (aubEffect.get_fact().get_pair().var == notbPrecon.get_pair().var){
-                    	if (aubEffect.get_fact().get_pair().value != notbPrecon.get_pair().value)
-                        {
-                        	//std::cout << notbOp.get_name() << " and " << aubOp.get_name() << " are not commutative (notb.precon <- aub.effect)" << std::endl;
-							return false;
-                        }
-                	}
-            	}
-        	}
+            //notb.effect -> aub.precon
+            if (notBProducesOtherValue(aubPrecon.get_pair().var, aubPrecon.get_pair().value)) { return false; }
+        }
+        for (auto aubEffect : aubOp.get_effects())
+        {
+            FactPair fact = aubEffect.get_fact().get_pair();
+            //notb.effect <-> aub.effect
+            if (notBProducesOtherValue(fact.var, fact.value)) { return false; }
+            //notb.precon <- aub.effect
+            if (notBConsumesOtherValue(fact.var, fact.value)) { return false; }
         }
     }
     return true;
 }
 
-bool compositor::notAIsInconsistentOrDisjoint(std::set<int> A, std::set<int> B, std::vector<std::pair<int, int>> c)
+/*
+Every operator outside of A must either not touch the variables of c (disjoint) or set one of them to a value
+different from c (inconsistent). Operators that don't produce any fact of c are disjoint or inconsistent by
+definition, so only the producers of the facts of c need to be checked.
+ */
+bool compositor::notAIsInconsistentOrDisjoint(const std::set<int> &A, const std::set<int> &B, const std::vector<std::pair<int, int>> &c) const
 {
-    for (auto op : taskProxy.get_operators())
+    for (const auto &cFact : c)
     {
-    	if (A.count(op.get_id()) == 0) //If not in A
-    	{
-        	bool disjoint = true;
-            bool inconsistent = false;
+        for (const int *op = index->producersBegin(cFact.first, cFact.second); op != index->producersEnd(cFact.first, cFact.second); ++op)
+        {
+            if (A.count(*op) > 0) { continue; }
 
-        	for (auto post : op.get_effects())
+            bool inconsistent = false;
+            for (const auto &otherFact : c)
             {
-                auto postFact = post.get_fact().get_pair();
-
-                for (auto cFact : c)
-                {
-                	if (postFact.var == cFact.first)
-                	{
-                        disjoint = false;
-                        //cout << op.get_name() << " is not disjoint from "; print_c(c); cout << endl;
-                    	if (postFact.value != cFact.second)
-                        {
-                        	//cout << op.get_name() << " is inconsistent from it though" << endl;
-							inconsistent = true;
-                            break;
-                        }
-                    }
-                }
-                if (inconsistent) {break;}
+                int postVal = index->getEffectValue(*op, otherFact.first);
+                if (postVal != -1 && postVal != otherFact.second) { inconsistent = true; break; }
             }
-            if (!disjoint && !inconsistent)
+            if (!inconsistent)
             {
-                //cout << "(!) " << op.get_name() << " is NOT disjoint NOR inconsistent from "; print_c(c); cout << endl;
+                //cout << "(!) " << taskProxy.get_operators()[*op].get_name() << " is NOT disjoint NOR inconsistent from "; print_c(c); cout << endl;
                 return false;
             }
         }
@@ -453,10 +590,8 @@ bool compositor::notAIsInconsistentOrDisjoint(std::set<int> A, std::set<int> B,
     return true;
 }
 
-bool compositor::effectsOfAInconsistentOrDisjointWithGoal(std::set<int> A)
+bool compositor::effectsOfAInconsistentOrDisjointWithGoal(const std::set<int> &A, std::ostream &log) const
 {
-	GoalsProxy goals = taskProxy.get_goals();
-
 	for (auto a : A)
 	{
         auto op = taskProxy.get_operators()[a];
@@ -466,129 +601,50 @@ bool compositor::effectsOfAInconsistentOrDisjointWithGoal(std::set<int> A)
         for (auto post : op.get_effects())
         {
         	auto postFact = post.get_fact().get_pair();
-            for (auto goal : goals)
+            int goalValue = goalValues[postFact.var];
+            if (goalValue != -1)
             {
-            	auto goalFact = goal.get_pair();
-            	if (postFact.var == goalFact.var)
-            	{
-                	disjoint = false;
-                    if (postFact.value != goalFact.value)
-                    {
-                    	//Effects of A are inconsistent
-                        inconsistent = true;
-						break;
-                    }
+                disjoint = false;
+                if (postFact.value != goalValue)
+                {
+                    //Effects of A are inconsistent
+                    inconsistent = true;
+                    break;
                 }
             }
-            if (inconsistent) {break;}
 
-            cout << "Effects of " << op.get_name() << " are not disjoint nor inconsistent" << endl;
+            log << "Effects of " << op.get_name() << " are not disjoint nor inconsistent" << endl;
             if (!disjoint && !inconsistent) {return false;}
         }
     }
     return true;
 }
 
-std::pair<std::set<int>, std::set<int>> compositor::getCompositeTargets(std::vector<std::pair<int, int>> c)
+std::pair<std::set<int>, std::set<int>> compositor::getCompositeTargets(const std::vector<std::pair<int, int>> &c) const
 {
-    std::set<int> A; //set of all actions whose effects include c
-    std::set<int> B; //set of all actions whose preconditions include c
-
-    for (OperatorProxy op : taskProxy.get_operators())
+    //A: set of all actions whose effects include c (intersection of the producers of the facts of c)
+    //B: set of all actions whose preconditions include c (intersection of the consumers of the facts of c)
+    auto intersect = [&](auto begin, auto end)
     {
-    	//std::cout << "Checking if " << op.get_name() << " should be in A" << std::endl;
-        auto effects = op.get_effects();
-        bool containsC = true;
-
-        if (effects.size() < c.size() )
+        std::vector<int> result(begin(c[0]), end(c[0]));
+        for (int i = 1; i < (int)c.size() && !result.empty(); ++i)
         {
-        	containsC = false;
-        	//std::cout << op.get_name() << " doesn't contain c in its effects" << std::endl;
-            continue; //Not enough effects to contain c
+            std::vector<int> intersection;
+            std::set_intersection(result.begin(), result.end(), begin(c[i]), end(c[i]), std::back_inserter(intersection));
+            result.swap(intersection);
         }
-        else
-        {
-        	for (auto fact : c)
-            {
-                bool containsFact = false;
-            	for (auto post : effects)
-            	{
-                    auto postVar = post.get_fact().get_pair().var;
-                	auto postVal = post.get_fact().get_pair().value;
-                	if (postVar != fact.first){ continue; }
-                	if (postVal == fact.second)
-                    {
-                    	containsFact = true;
-                    	break;
-                    }
-            	}
-                if (!containsFact)
-                {
-                	containsC = false;
-                	break;
-                }
-            }
-        }
-        if (containsC)
-        {
-        	A.insert(op.get_id());
-        	//std::cout << "Adding " << op.get_name() << " to A" << std::endl;
-        }
-    	else
-    	{
-    		//std::cout << op.get_name() << " does not contain c in its effects" << std::endl;
-    	}
-    }
+        return std::set<int>(result.begin(), result.end());
+    };
+
+    std::set<int> A = intersect([&](const std::pair<int, int> &fact) { return index->producersBegin(fact.first, fact.second); },
+                                [&](const std::pair<int, int> &fact) { return index->producersEnd(fact.first, fact.second); });
     if (A.size() == 0) {
     	//std::cout << "Skipping: A is empty" << std::endl;
     	return std::make_pair(std::set<int>(), std::set<int>());
     }
 
-    for (OperatorProxy op : taskProxy.get_operators())
-    {
-        //std::cout << "Checking if " << op.get_name() << " should be in B" << std::endl;
-        auto preconditions = op.get_preconditions();
-        bool containsC = true;
-
-        if (preconditions.size() < c.size() )
-        {
-        	containsC = false;
-        	//std::cout << op.get_name() << " doesn't contain c in its preconditions" << std::endl;
-            continue; //Not enough effects to contain c
-        }
-        else
-        {
-        	for (auto fact : c)
-            {
-                bool containsFact = false;
-            	for (auto pre : preconditions)
-            	{
-                    auto preVar = pre.get_pair().var;
-                	auto preVal = pre.get_pair().value;
-                	if (preVar != fact.first) {continue;}
-                	if (preVal == fact.second)
-                    {
-                    	containsFact = true;
-                    	break;
-                    }
-            	}
-                if (!containsFact)
-                {
-                	containsC = false;
-                	break;
-                }
-            }
-        }
-        if (containsC)
-        {
-        	B.insert(op.get_id());
-        	//std::cout << "Adding " << op.get_name() << " to B" << std::endl;
-        }
-        else
-        {
-        	//std::cout << op.get_name() << " does not contain c in its preconditions" << std::endl;
-        }
-    }
+    std::set<int> B = intersect([&](const std::pair<int, int> &fact) { return index->consumersBegin(fact.first, fact.second); },
+                                [&](const std::pair<int, int> &fact) { return index->consumersEnd(fact.first, fact.second); });
     if (B.size() == 0)
     {
         //std::cout << "Skipping: B is empty" << std::endl;
@@ -600,7 +656,7 @@ std::pair<std::set<int>, std::set<int>> compositor::getCompositeTargets(std::vec
     return std::make_pair(A, B);
 }
 
-std::vector<std::vector<std::pair<int, int>>> compositor::getC(std::pair<VariableProxy, VariableProxy> varPair)
+std::vector<std::vector<std::pair<int, int>>> compositor::getC(std::pair<VariableProxy, VariableProxy> varPair) const
 {
     //std::cout << "Getting c..." << std::endl;
 
@@ -643,12 +699,12 @@ std::vector<std::vector<std::pair<int, int>>> compositor::getC(std::pair<Variabl
     return C;
 }
 
-void compositor::printPair(std::pair<VariableProxy, VariableProxy> varPair)
+void compositor::printPair(std::pair<VariableProxy, VariableProxy> varPair) const
 {
 	cout << "(" << varPair.first.get_name() << "," << varPair.second.get_name() << ") :";
 }
 
-void compositor::print_c(std::vector<std::pair<int, int>> c)
+void compositor::print_c(std::vector<std::pair<int, int>> c) const
 {
 	cout << "c (" << taskProxy.get_variables()[c[0].first].get_name() << " = " << c[0].second <<
       			"," << taskProxy.get_variables()[c[1].first].get_name() << " = " << c[1].second << ")";
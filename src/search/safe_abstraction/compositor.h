@@ -4,6 +4,9 @@
 #include "../abstract_task.h"
 #include "../task_proxy.h"
 #include "../tasks/root_task.h"
+#include "operator_index.h"
+#include "memory"
+#include "ostream"
 #include "vector"
 #include "map"
 #include "set"
@@ -14,6 +17,9 @@ TaskProxy taskProxy;
 std::shared_ptr<AbstractTask> compositedTask;
 int maxSequenceLength;
 bool isHarsh;
+int numThreads;
+std::shared_ptr<const operatorIndex> index;
+std::vector<int> goalValues; //Goal value per variable (-1 if the variable has no goal)
 
 public:
 std::set<int> compositedOperatorIDs;
@@ -21,32 +27,48 @@ std::vector<tasks::ExplicitOperator> compositeOperators;
 std::map<int, std::vector<OperatorProxy>> decompositOperations;
 
     private:
+        //Result of compositing the operators of a single variable pair
+        struct PairComposition {
+            std::set<int> compositedOperatorIDs;
+            std::vector<tasks::ExplicitOperator> compositeOperators;
+            std::map<int, std::vector<OperatorProxy>> decompositOperations;
+        };
+
         void composite();
-        std::vector<std::vector<std::pair<int, int>>> getC(std::pair<VariableProxy, VariableProxy> varPair);
-        std::pair<std::set<int>, std::set<int>> getCompositeTargets(std::vector<std::pair<int, int>> c);
-        std::vector<std::vector<OperatorProxy>> generateCompositeOperations(std::vector<std::pair<std::set<int>, std::set<int>>> compositeTargets);
-        std::vector<std::vector<OperatorProxy>> expandCompositeOperation(std::vector<OperatorProxy> compositeOperation, std::set<int> targets);
-        bool isCompositeOperationExecutable(std::vector<OperatorProxy> compositeOperation);
-        tasks::ExplicitOperator createExplicitOperator(std::vector<OperatorProxy> compOp);
-        bool isUniqueOperator(tasks::ExplicitOperator newOperator);
-        bool areIdenticalOperators(tasks::ExplicitOperator a, tasks::ExplicitOperator b);
-        bool notBIsCommutative(std::set<int> A, std::set<int> B, std::vector<std::pair<int, int>> c);
-        bool notAIsInconsistentOrDisjoint(std::set<int> A, std::set<int> B, std::vector<std::pair<int, int>> c);
-        bool effectsOfAInconsistentOrDisjointWithGoal(std::set<int> A);
-        bool removesCausalCoupling(std::pair<VariableProxy, VariableProxy> varPair);
-
-        void printPair(std::pair<VariableProxy, VariableProxy> varPair);
-        void print_c(std::vector<std::pair<int, int>> c);
+        bool compositePair(std::pair<int, int> varIndices, PairComposition &composition, std::ostream &log) const;
+        int compositePairsInParallel(const std::vector<std::pair<int, int>> &varPairs, PairComposition &composition) const;
+        std::vector<std::vector<std::pair<int, int>>> getC(std::pair<VariableProxy, VariableProxy> varPair) const;
+        std::pair<std::set<int>, std::set<int>> getCompositeTargets(const std::vector<std::pair<int, int>> &c) const;
+        std::vector<std::vector<OperatorProxy>> generateCompositeOperations(const std::vector<std::pair<std::set<int>, std::set<int>>> &compositeTargets, PairComposition &composition) const;
+        std::vector<std::vector<OperatorProxy>> expandCompositeOperation(const std::vector<OperatorProxy> &compositeOperation, const std::set<int> &targets, PairComposition &composition) const;
+        bool isCompositeOperationExecutable(const std::vector<OperatorProxy> &compositeOperation) const;
+        tasks::ExplicitOperator createExplicitOperator(const std::vector<OperatorProxy> &compOp) const;
+        bool isUniqueOperator(const tasks::ExplicitOperator &newOperator, const std::vector<tasks::ExplicitOperator> &compositeOperators) const;
+        bool areIdenticalOperators(const tasks::ExplicitOperator &a, const tasks::ExplicitOperator &b) const;
+        bool notBIsCommutative(const std::set<int> &A, const std::set<int> &B, const std::vector<std::pair<int, int>> &c) const;
+        bool notAIsInconsistentOrDisjoint(const std::set<int> &A, const std::set<int> &B, const std::vector<std::pair<int, int>> &c) const;
+        bool effectsOfAInconsistentOrDisjointWithGoal(const std::set<int> &A, std::ostream &log) const;
+        bool removesCausalCoupling(std::pair<VariableProxy, VariableProxy> varPair, const std::vector<tasks::ExplicitOperator> &compositeOperators) const;
+
+        void printPair(std::pair<VariableProxy, VariableProxy> varPair) const;
+        void print_c(std::vector<std::pair<int, int>> c) const;
 
     public:
-        compositor(std::shared_ptr<AbstractTask> abstractTask, int maxSequenceLength, bool isHarsh, bool enable)
+        compositor(std::shared_ptr<AbstractTask> abstractTask, int maxSequenceLength, bool isHarsh, bool enable, int numThreads = 1)
             : abstractTask(abstractTask), taskProxy(*abstractTask)
         {
    		  this->maxSequenceLength = maxSequenceLength;
           this->isHarsh = isHarsh;
+          this->numThreads = numThreads;
           if (enable) { composite(); }
         }
+        //Compositor taking over a stored composition (see hierarchyCache) instead of searching for one
+        compositor(std::shared_ptr<AbstractTask> abstractTask, std::set<int> compositedOperatorIDs, std::vector<tasks::ExplicitOperator> compositeOperators,
+                   const std::map<int, std::vector<int>> &decompositOperationIDs);
+        std::map<int, std::vector<int>> getDecompositOperationIDs() const;
+        std::shared_ptr<AbstractTask> getAbstractTask() {return abstractTask;}
         std::shared_ptr<AbstractTask> getCompositedTask() {return compositedTask;}
+        void setCompositedTask(std::shared_ptr<AbstractTask> task) {compositedTask = task;}
 };
 
 #endif //COMPOSITOR_H
@@ -1,22 +1,105 @@
 #include "free_domain_transition_graph.h"
 #include "../abstract_task.h"
+#include <algorithm>
+#include <cassert>
+#include <limits>
 #include <list>
-#include <vector>
 #include <queue>
+#include <vector>
 #include <iostream>
 
 freeDTG::freeDTG(int var, int numberOfValues)
 {
     variable = var;
     numVal = numberOfValues;
-    this->transitions = new std::list<Transition>[numVal];
+    finalized = false;
+    wordsPerRow = (numVal + 63) / 64;
     this->externallyRequiredValues = std::vector<bool>(numVal);
     this->externallyCausedValues = std::vector<bool>(numVal);
 }
 
-void freeDTG::addTransition(int a, int b, int operation_id)
+//Copy of this free DTG for another variable id with the operator ids of all transitions replaced by operatorRemap[id]
+freeDTG freeDTG::remapped(int newVar, const std::vector<int> &operatorRemap) const
+{
+    assert(finalized);
+    freeDTG copy(*this);
+    copy.variable = newVar;
+    copy.shortestPathTrees.assign(numVal, std::vector<int>());
+    copy.cheapestPathTrees.assign(numVal, std::vector<int>());
+    for (Transition &transition : copy.forwardTransitions) { transition.operation_id = operatorRemap[transition.operation_id]; }
+    for (Transition &transition : copy.reverseTransitions) { transition.operation_id = operatorRemap[transition.operation_id]; }
+    return copy;
+}
+
+void freeDTG::addTransition(int a, int b, int operation_id, int cost)
 {
-    transitions[a].emplace_back(b, operation_id); // Add b to a’s list. (Transtion from a to b)
+    assert(!finalized);
+    pendingTransitions.emplace_back(a, Transition(b, operation_id, cost)); // Transtion from a to b
+}
+
+//Packs the collected transitions into the forward and reverse adjacency arrays and computes the reachability table
+void freeDTG::finalize()
+{
+    if (finalized) { return; }
+    forwardOffsets.assign(numVal + 1, 0);
+    reverseOffsets.assign(numVal + 1, 0);
+    for (const auto &[source, transition] : pendingTransitions)
+    {
+        forwardOffsets[source + 1]++;
+        reverseOffsets[transition.destination + 1]++;
+    }
+    for (int v = 0; v < numVal; v++)
+    {
+        forwardOffsets[v + 1] += forwardOffsets[v];
+        reverseOffsets[v + 1] += reverseOffsets[v];
+    }
+
+    //Filling in insertion order keeps the order of the transitions per value (and with it the paths found by getPath)
+    forwardTransitions.assign(pendingTransitions.size(), Transition(-1, -1, 0));
+    forwardSources.assign(pendingTransitions.size(), -1);
+    reverseTransitions.assign(pendingTransitions.size(), Transition(-1, -1, 0));
+    std::vector<int> forwardNext(forwardOffsets.begin(), forwardOffsets.end() - 1);
+    std::vector<int> reverseNext(reverseOffsets.begin(), reverseOffsets.end() - 1);
+    for (const auto &[source, transition] : pendingTransitions)
+    {
+        forwardSources[forwardNext[source]] = source;
+        forwardTransitions[forwardNext[source]++] = transition;
+        reverseTransitions[reverseNext[transition.destination]++] = Transition(source, transition.operation_id, transition.cost);
+    }
+    std::vector<std::pair<int, Transition>>().swap(pendingTransitions);
+
+    computeReachability();
+    shortestPathTrees.assign(numVal, std::vector<int>());
+    cheapestPathTrees.assign(numVal, std::vector<int>());
+    finalized = true;
+}
+
+//Iterative DFS from every value, marking the visited values in the row of the starting value
+void freeDTG::computeReachability()
+{
+    reachability.assign(static_cast<size_t>(numVal) * wordsPerRow, 0);
+    std::vector<int> stack;
+    stack.reserve(numVal);
+    for (int start = 0; start < numVal; start++)
+    {
+        uint64_t *row = &reachability[static_cast<size_t>(start) * wordsPerRow];
+        row[start / 64] |= uint64_t(1) << (start % 64);
+        stack.push_back(start);
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            stack.pop_back();
+            for (int i = forwardOffsets[v]; i < forwardOffsets[v + 1]; i++)
+            {
+                int w = forwardTransitions[i].destination;
+                uint64_t bit = uint64_t(1) << (w % 64);
+                //Don't deepen if value was already visited (avoids getting stuck in cycles).
+                if (row[w / 64] & bit) { continue; }
+                row[w / 64] |= bit;
+                stack.push_back(w);
+            }
+        }
+    }
 }
 
 void freeDTG::externallyRequired(int val)
@@ -32,145 +115,129 @@ void freeDTG::externallyCaused(int val)
 }
 
 /*
-Based on https://www.geeksforgeeks.org/connectivity-in-a-directed-graph/
-
 Checks if the targetValues are strongly connected within the freeDTG.
 Note that they may travel via non-target values to reach eachother.
+
+If the first target value v reaches all target values and all target values reach v,
+all target values are reachable by any target value via v.
  */
-bool freeDTG::isStronglyConnected(std::list<int> targetValues)
+bool freeDTG::isStronglyConnected(const std::list<int> &targetValues) const
 {
+    assert(finalized);
 	//Trivial case. Not sure if true or false should be returned
     if (targetValues.size() == 0) {return true;}
 
-    //Check if all targetValues are reachable from the first target value v
-    if (!freeDTG::isReachable(targetValues.front(), targetValues)){return false;}
-
-	//Invert the freeDTG a->b => a<-b
-    freeDTG inversion = freeDTG::getTranspose();
-
-    /*
-    Check if all targetValues are reachable from the first target value v in the inversion.
-    If this is the case, we know that in the original (uninverted) free DTG, all targetValues can reach v.
-
-    This together with the knowledge that v can reach all target values means that all target values are
-    reachable by any target value via v.
-     */
-    if (!inversion.isReachable(targetValues.front(), targetValues)){return false;}
-
+    int v = targetValues.front();
+    for (int target : targetValues)
+    {
+        if (!reaches(v, target) || !reaches(target, v)) { return false; }
+    }
     return true;
 }
 
-//Simple recursive DFS
-void freeDTG::DFS(int v, std::vector<bool> *visited)
+//Check if targetValues are reachable by startingValue in the DTG
+bool freeDTG::isReachable(int startingValue, const std::list<int> &targetValues) const
 {
-    (*visited)[v] = true;
-
-    for (Transition transition : transitions[v])
+    assert(finalized);
+    for (int target : targetValues)
     {
-   		//Don't deepen if value was already visited (avoids getting stuck in cycles).
-        if (!(*visited)[transition.destination])
-        {
-            DFS(transition.destination, visited);
-        }
+        if (!reaches(startingValue, target)) { return false; }
     }
+    return true;
 }
 
-//Inverts the DTG such that transision a->b becomes a<-b.
-freeDTG freeDTG::getTranspose()
+//BFS from sourceVal remembering for every value the transition it was reached by
+const std::vector<int> &freeDTG::getShortestPathTree(int sourceVal)
 {
-    freeDTG inversion(variable, numVal);
-    for (int v = 0; v < numVal; v++)
+    std::vector<int> &reachedBy = shortestPathTrees[sourceVal];
+    if (!reachedBy.empty()) { return reachedBy; }
+
+    reachedBy.assign(numVal, -1);
+    std::vector<int> queue;
+    queue.reserve(numVal);
+    queue.push_back(sourceVal);
+    for (size_t head = 0; head < queue.size(); head++)
     {
-        for (Transition w : transitions[v])
+        int current = queue[head];
+        for (int i = forwardOffsets[current]; i < forwardOffsets[current + 1]; i++)
         {
-            inversion.addTransition(w.destination, v, w.operation_id);
+            int next = forwardTransitions[i].destination;
+            if (next == sourceVal || reachedBy[next] != -1) continue; // Skip if visited
+            reachedBy[next] = i;
+            queue.push_back(next);
         }
     }
-    return inversion;
+    return reachedBy;
 }
 
-//Check if targetValues are reachable by startingValue in the DTG
-bool freeDTG::isReachable(int startingValue, std::list<int> targetValues)
+//Dijkstra from sourceVal over the operator costs, remembering for every value the transition it was reached by
+const std::vector<int> &freeDTG::getCheapestPathTree(int sourceVal)
 {
-    if (targetValues.size() == 0) {return true;}
-    std::vector<bool> visited(numVal, false);
-
-    freeDTG::DFS(startingValue, &visited); //Perform DFS
-
-    for (int i = 0; i < visited.size(); i++)
+    std::vector<int> &reachedBy = cheapestPathTrees[sourceVal];
+    if (!reachedBy.empty()) { return reachedBy; }
+
+    reachedBy.assign(numVal, -1);
+    std::vector<int> distance(numVal, std::numeric_limits<int>::max());
+    std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<>> queue;
+    distance[sourceVal] = 0;
+    queue.emplace(0, sourceVal);
+    while (!queue.empty())
     {
-        if (visited[i] == false) //If a value wasn't visited its not reachable from the starting value
+        auto [currentDistance, current] = queue.top();
+        queue.pop();
+        if (currentDistance > distance[current]) continue; // Outdated entry
+        for (int i = forwardOffsets[current]; i < forwardOffsets[current + 1]; i++)
         {
-            for (int target : targetValues)
-            {
-                if (target == i) //If a target value isn't reachable we retun false.
-                {
-                    //std::cout << "couldn't reach: " << i << " from: " << targetValues.front() << std::endl;
-                    return false;
-                }
-            }
+            const Transition &transition = forwardTransitions[i];
+            int nextDistance = currentDistance + transition.cost;
+            if (nextDistance >= distance[transition.destination]) continue;
+            distance[transition.destination] = nextDistance;
+            reachedBy[transition.destination] = i;
+            queue.emplace(nextDistance, transition.destination);
         }
     }
-    return true;
+    return reachedBy;
 }
 
-struct PathNode {
-    int value;
-    std::vector<int> operation_ids;
-
-    PathNode(int value, std::vector<int> ops)
-        : value(value), operation_ids(std::move(ops)) {}
-};
-
-std::vector<int> freeDTG::getPath(int sourceVal, int destinationVal) {
+/*
+Path from sourceVal to destinationVal as a list of operator ids.
+The path is the shortest one in number of transitions, or the cheapest one with respect to the operator costs if cheapest is set.
+ */
+std::vector<int> freeDTG::getPath(int sourceVal, int destinationVal, bool cheapest)
+{
+    assert(finalized);
     if (sourceVal == destinationVal) return {};
+    if (!reaches(sourceVal, destinationVal))
+    {
+        //std::cout << "Could not find path from " << sourceVal << " to " << destinationVal << " for variable " << variable << std::endl;
+        // If no path is found, return an empty vector
+        return {};
+    }
 
-    std::queue<PathNode> queue;
-    std::unordered_map<int, bool> visited;
-
-    queue.emplace(sourceVal, std::vector<int>{});
-    visited[sourceVal] = true;
-
-    while (!queue.empty()) {
-        PathNode current = queue.front();
-        queue.pop();
-
-        // Explore all transitions from the current node
-        for (Transition& transition : transitions[current.value]) {
-            if (visited[transition.destination]) continue; // Skip if visited
-
-            // Create a new path with the current operation ID added
-            std::vector<int> new_path = current.operation_ids;
-            new_path.push_back(transition.operation_id);
-
-            // If we reached the destination, return the path
-            if (transition.destination == destinationVal) {
-                return new_path;
-            }
-
-            queue.emplace(transition.destination, new_path);
-            visited[transition.destination] = true;
-        }
+    const std::vector<int> &reachedBy = cheapest ? getCheapestPathTree(sourceVal) : getShortestPathTree(sourceVal);
+    std::vector<int> path;
+    for (int v = destinationVal; v != sourceVal; v = forwardSources[reachedBy[v]])
+    {
+        path.push_back(forwardTransitions[reachedBy[v]].operation_id);
     }
-    //std::cout << "Could not find path from " << sourceVal << " to " << destinationVal << " for variable " << variable << std::endl;
-    // If no path is found, return an empty vector
-    return {};
+    std::reverse(path.begin(), path.end());
+    return path;
 }
 
-void freeDTG::printFreeDTG(std::shared_ptr<AbstractTask> original_task)
+void freeDTG::printFreeDTG(std::shared_ptr<AbstractTask> original_task) const
 {
     std::cout << "safe_abstraction > FreeDTG of variable: " << original_task->get_variable_name(variable) << std::endl;
     for (int i = 0; i < numVal; ++i) {
         std::cout << "  Transitions for value " << i << ": [ ";
-        for (Transition transition : transitions[i]) {
-            std::cout << transition.destination << " ";
+        for (int t = forwardOffsets[i]; t < forwardOffsets[i + 1]; ++t) {
+            std::cout << forwardTransitions[t].destination << " ";
         }
         std::cout << "]" << std::endl;
     }
     std::cout << std::endl;
 }
 
-void freeDTG::printExternalInformation(std::shared_ptr<AbstractTask> original_task)
+void freeDTG::printExternalInformation(std::shared_ptr<AbstractTask> original_task) const
 {
     std::cout << "safe_abstraction > External information of variable: " << original_task->get_variable_name(variable) << std::endl;
     for (int i = 0; i < numVal; ++i) {
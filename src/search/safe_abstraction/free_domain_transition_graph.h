@@ -2,39 +2,67 @@
 #define FREE_DOMAIN_TRANSITION_GRAPH_H
 
 #include "../abstract_task.h"
+#include <cstdint>
 #include <list>
 #include <vector>
 
 struct Transition {
     int destination;
     int operation_id;
+    int cost;
 
-    Transition(int dest, int op_id) : destination(dest), operation_id(op_id) {}
+    Transition(int dest, int op_id, int cost) : destination(dest), operation_id(op_id), cost(cost) {}
 };
 
+/*
+The free DTG is built in two phases: transitions are collected with addTransition and then
+finalize() packs them into forward and reverse adjacency arrays (CSR, ordered by source value and
+insertion order) and computes which values are reachable from which. After that the graph is read only.
+ */
 class freeDTG
 {
   int variable;
   int numVal; // Number of values
-  std::list<Transition> *transitions;
+  bool finalized;
+  //Transitions in insertion order as long as the graph is not finalized
+  std::vector<std::pair<int, Transition>> pendingTransitions;
+  //Transitions leaving value v are forwardTransitions[forwardOffsets[v]] ... forwardTransitions[forwardOffsets[v+1]-1]
+  std::vector<int> forwardOffsets;
+  std::vector<Transition> forwardTransitions;
+  std::vector<int> forwardSources;
+  //Same for the incoming transitions of value v, holding the source value and operator
+  std::vector<int> reverseOffsets;
+  std::vector<Transition> reverseTransitions;
+  //Row v holds one bit per value u, set if u is reachable from v (every value reaches itself)
+  int wordsPerRow;
+  std::vector<uint64_t> reachability;
+  //Shortest path tree of every source value, computed on first use: the forward transition each value is reached by (-1 if it isn't)
+  std::vector<std::vector<int>> shortestPathTrees;
+  //Same for the cheapest paths with respect to the operator costs
+  std::vector<std::vector<int>> cheapestPathTrees;
   std::vector<bool> externallyRequiredValues;
   std::vector<bool> externallyCausedValues;
 
+  void computeReachability();
+  const std::vector<int> &getShortestPathTree(int sourceVal);
+  const std::vector<int> &getCheapestPathTree(int sourceVal);
+  bool reaches(int from, int to) const { return (reachability[from * wordsPerRow + to / 64] >> (to % 64)) & 1; }
+
   public:
     freeDTG(int var, int numVal);
-    int getVariable() {return variable;}
-    std::vector<bool> getExternallyRequiredValues() { return externallyRequiredValues; }
-    std::vector<bool> getExternallyCausedValues() {return externallyCausedValues;}
-    void addTransition(int a, int b, int operation_id);
+    int getVariable() const {return variable;}
+    freeDTG remapped(int newVar, const std::vector<int> &operatorRemap) const;
+    const std::vector<bool> &getExternallyRequiredValues() const { return externallyRequiredValues; }
+    const std::vector<bool> &getExternallyCausedValues() const {return externallyCausedValues;}
+    void addTransition(int a, int b, int operation_id, int cost);
+    void finalize();
     void externallyRequired(int val);
     void externallyCaused(int val);
-    bool isStronglyConnected(std::list<int> targetValues);
-    void DFS(int value, std::vector<bool> *visited);
-    freeDTG getTranspose();
-    bool isReachable(int value, std::list<int> targetValues);
-    void printFreeDTG(std::shared_ptr<AbstractTask> original_task);
-    void printExternalInformation(std::shared_ptr<AbstractTask> original_task);
-    std::vector<int> getPath(int sourceVal, int destinationVal);
+    bool isStronglyConnected(const std::list<int> &targetValues) const;
+    bool isReachable(int value, const std::list<int> &targetValues) const;
+    void printFreeDTG(std::shared_ptr<AbstractTask> original_task) const;
+    void printExternalInformation(std::shared_ptr<AbstractTask> original_task) const;
+    std::vector<int> getPath(int sourceVal, int destinationVal, bool cheapest = false);
 };
 
 #endif //FREE_DOMAIN_TRANSITION_GRAPH_H
@@ -0,0 +1,282 @@
+#include "hierarchy_cache.h"
+#include "../utils/hash.h"
+#include "../utils/system.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//Bump whenever the layout of the file changes
+static const uint32_t FORMAT_VERSION = 1;
+static const char MAGIC[4] = {'S', 'A', 'H', 'C'};
+//Upper bound for stored counts, so that a corrupted file is rejected instead of exhausting memory
+static const uint32_t MAX_COUNT = 1u << 28;
+
+static void writeInt(std::ostream &out, int32_t value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); }
+static void writeUInt64(std::ostream &out, uint64_t value) { out.write(reinterpret_cast<const char *>(&value), sizeof(value)); }
+
+static void writeString(std::ostream &out, const std::string &value)
+{
+    writeInt(out, value.size());
+    out.write(value.data(), value.size());
+}
+
+static void writeFacts(std::ostream &out, const std::vector<FactPair> &facts)
+{
+    writeInt(out, facts.size());
+    for (const FactPair &fact : facts) { writeInt(out, fact.var); writeInt(out, fact.value); }
+}
+
+static bool readInt(std::istream &in, int32_t &value) { return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value))); }
+static bool readUInt64(std::istream &in, uint64_t &value) { return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value))); }
+
+static bool readCount(std::istream &in, int32_t &count)
+{
+    return readInt(in, count) && count >= 0 && static_cast<uint32_t>(count) <= MAX_COUNT;
+}
+
+//Nothing is allocated for a count before the bytes it needs are known to be in the file
+static bool hasBytesLeft(std::istream &in, std::streamoff bytes)
+{
+    std::streampos position = in.tellg();
+    if (position < 0 || !in.seekg(0, std::ios::end)) { return false; }
+    std::streamoff left = in.tellg() - position;
+    in.seekg(position);
+    return bytes <= left;
+}
+
+static bool readString(std::istream &in, std::string &value)
+{
+    int32_t size;
+    if (!readCount(in, size) || !hasBytesLeft(in, size)) { return false; }
+    value.resize(size);
+    return static_cast<bool>(in.read(value.data(), size));
+}
+
+static bool readFacts(std::istream &in, std::vector<FactPair> &facts)
+{
+    int32_t size;
+    if (!readCount(in, size)) { return false; }
+    if (!hasBytesLeft(in, static_cast<std::streamoff>(size) * 2 * sizeof(int32_t))) { return false; }
+    facts.clear();
+    facts.reserve(size);
+    for (int i = 0; i < size; ++i)
+    {
+        int32_t var, value;
+        if (!readInt(in, var) || !readInt(in, value)) { return false; }
+        facts.emplace_back(var, value);
+    }
+    return true;
+}
+
+hierarchyCache::hierarchyCache(const std::string &directory, const std::string &inputText, const std::string &settings)
+    : settings(settings)
+{
+    //Hash the input and the settings in words of four bytes (the last one padded with zeros)
+    utils::HashState hashState;
+    for (const std::string *text : {&inputText, &settings})
+    {
+        utils::feed(hashState, static_cast<uint64_t>(text->size()));
+        for (size_t i = 0; i < text->size(); i += 4)
+        {
+            uint32_t word = 0;
+            std::memcpy(&word, text->data() + i, std::min<size_t>(4, text->size() - i));
+            hashState.feed(word);
+        }
+    }
+    inputHash = hashState.get_hash64();
+
+    std::ostringstream fileName;
+    fileName << std::hex << std::setw(16) << std::setfill('0') << inputHash << ".hierarchy";
+    path = directory.empty() || directory.back() == '/' ? directory + fileName.str() : directory + "/" + fileName.str();
+}
+
+bool hierarchyCache::load(std::vector<Step> &steps) const
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) { return false; }
+
+    char magic[4];
+    int32_t version;
+    uint64_t hash;
+    std::string storedSettings;
+    if (!in.read(magic, 4) || std::memcmp(magic, MAGIC, 4) != 0 || !readInt(in, version) || version != static_cast<int32_t>(FORMAT_VERSION)
+        || !readUInt64(in, hash) || hash != inputHash || !readString(in, storedSettings) || storedSettings != settings)
+    {
+        //Another input or mode that hashes to the same file, or an outdated format
+        return false;
+    }
+
+    int32_t numSteps;
+    if (!readCount(in, numSteps)) { return false; }
+    std::vector<Step> loadedSteps;
+    for (int stepIndex = 0; stepIndex < numSteps; ++stepIndex)
+    {
+        Step &step = loadedSteps.emplace_back();
+        int32_t size, value;
+        if (!readCount(in, size)) { return false; }
+        for (int i = 0; i < size; ++i)
+        {
+            if (!readInt(in, value)) { return false; }
+            step.safeVariables.push_back(value);
+        }
+
+        if (!readCount(in, size)) { return false; }
+        for (int i = 0; i < size; ++i)
+        {
+            if (!readInt(in, value)) { return false; }
+            step.compositedOperatorIDs.insert(step.compositedOperatorIDs.end(), value);
+        }
+
+        if (!readCount(in, size)) { return false; }
+        for (int i = 0; i < size; ++i)
+        {
+            std::vector<FactPair> preconditions;
+            std::vector<tasks::ExplicitEffect> effects;
+            int32_t numEffects, cost, isAxiom;
+            std::string name;
+            if (!readFacts(in, preconditions) || !readCount(in, numEffects)) { return false; }
+            for (int j = 0; j < numEffects; ++j)
+            {
+                int32_t var;
+                std::vector<FactPair> conditions;
+                if (!readInt(in, var) || !readInt(in, value) || !readFacts(in, conditions)) { return false; }
+                effects.emplace_back(var, value, std::move(conditions));
+            }
+            if (!readInt(in, cost) || !readString(in, name) || !readInt(in, isAxiom)) { return false; }
+            step.compositeOperators.emplace_back(preconditions, effects, cost, name, isAxiom != 0);
+        }
+
+        if (!readCount(in, size)) { return false; }
+        for (int i = 0; i < size; ++i)
+        {
+            int32_t key, length;
+            if (!readInt(in, key) || !readCount(in, length)) { return false; }
+            std::vector<int> &operatorIDs = step.decompositOperations[key];
+            for (int j = 0; j < length; ++j)
+            {
+                if (!readInt(in, value)) { return false; }
+                operatorIDs.push_back(value);
+            }
+        }
+    }
+    steps = std::move(loadedSteps);
+    return true;
+}
+
+void hierarchyCache::save(const std::vector<Step> &steps) const
+{
+    //Write to a temporary file first, so that concurrent runs never read a partially written cache
+    std::string temporaryPath = path + "." + std::to_string(utils::get_process_id()) + ".tmp";
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            std::cout << "Could not write abstraction hierarchy to " << path << std::endl;
+            return;
+        }
+        out.write(MAGIC, 4);
+        writeInt(out, FORMAT_VERSION);
+        writeUInt64(out, inputHash);
+        writeString(out, settings);
+
+        writeInt(out, steps.size());
+        for (const Step &step : steps)
+        {
+            writeInt(out, step.safeVariables.size());
+            for (int var : step.safeVariables) { writeInt(out, var); }
+
+            writeInt(out, step.compositedOperatorIDs.size());
+            for (int op : step.compositedOperatorIDs) { writeInt(out, op); }
+
+            writeInt(out, step.compositeOperators.size());
+            for (const tasks::ExplicitOperator &op : step.compositeOperators)
+            {
+                writeFacts(out, op.preconditions);
+                writeInt(out, op.effects.size());
+                for (const tasks::ExplicitEffect &effect : op.effects)
+                {
+                    writeInt(out, effect.fact.var);
+                    writeInt(out, effect.fact.value);
+                    writeFacts(out, effect.conditions);
+                }
+                writeInt(out, op.cost);
+                writeString(out, op.name);
+                writeInt(out, op.is_an_axiom);
+            }
+
+            writeInt(out, step.decompositOperations.size());
+            for (const auto &[key, operatorIDs] : step.decompositOperations)
+            {
+                writeInt(out, key);
+                writeInt(out, operatorIDs.size());
+                for (int op : operatorIDs) { writeInt(out, op); }
+            }
+        }
+        if (!out)
+        {
+            std::cout << "Could not write abstraction hierarchy to " << path << std::endl;
+            std::remove(temporaryPath.c_str());
+            return;
+        }
+    }
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        std::cout << "Could not write abstraction hierarchy to " << path << std::endl;
+        std::remove(temporaryPath.c_str());
+        return;
+    }
+    std::cout << "Saved abstraction hierarchy to " << path << std::endl;
+}
+
+static bool isValidFact(const FactPair &fact, const AbstractTask &task)
+{
+    return fact.var >= 0 && fact.var < task.get_num_variables() && fact.value >= 0 && fact.value < task.get_variable_domain_size(fact.var);
+}
+
+static bool areValidFacts(const std::vector<FactPair> &facts, const AbstractTask &task)
+{
+    return std::all_of(facts.begin(), facts.end(), [&](const FactPair &fact) { return isValidFact(fact, task); });
+}
+
+bool hierarchyCache::isValidAbstraction(const Step &step, const AbstractTask &task)
+{
+    std::set<int> variables;
+    for (int var : step.safeVariables)
+    {
+        if (var < 0 || var >= task.get_num_variables() || !variables.insert(var).second) { return false; }
+    }
+    return true;
+}
+
+bool hierarchyCache::isValidComposition(const Step &step, const AbstractTask &abstractedTask)
+{
+    int numOperators = abstractedTask.get_num_operators();
+    for (int op : step.compositedOperatorIDs)
+    {
+        if (op < 0 || op >= numOperators) { return false; }
+    }
+    for (const tasks::ExplicitOperator &op : step.compositeOperators)
+    {
+        if (!areValidFacts(op.preconditions, abstractedTask)) { return false; }
+        for (const tasks::ExplicitEffect &effect : op.effects)
+        {
+            if (!isValidFact(effect.fact, abstractedTask) || !areValidFacts(effect.conditions, abstractedTask)) { return false; }
+        }
+    }
+    //Composite operators are numbered after the operators of the task and consist of operators of the task
+    int numCompositeOperators = step.compositeOperators.size();
+    for (const auto &[compositeID, operatorIDs] : step.decompositOperations)
+    {
+        if (compositeID < numOperators || compositeID >= numOperators + numCompositeOperators) { return false; }
+        for (int op : operatorIDs)
+        {
+            if (op < 0 || op >= numOperators) { return false; }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef SAFE_ABSTRACTION_HIERARCHY_CACHE_H
+#define SAFE_ABSTRACTION_HIERARCHY_CACHE_H
+
+#include "../tasks/root_task.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/*
+Stores the outcome of the abstraction loop on disk, keyed by a hash of the SAS input and the abstraction mode.
+Per step only the decisions are stored (the safe variables and the composition), which is what is expensive to find.
+A later run on the same input replays them, deriving the simplified tasks, the remaps between them and the free DTGs from the input.
+ */
+class hierarchyCache
+{
+  public:
+    struct Step {
+        std::list<int> safeVariables;
+        std::set<int> compositedOperatorIDs;
+        std::vector<tasks::ExplicitOperator> compositeOperators;
+        //Composite operator id -> ids of the operators it consists of (see compositor::decompositOperations)
+        std::map<int, std::vector<int>> decompositOperations;
+    };
+
+  private:
+    std::string path;
+    std::string settings;
+    uint64_t inputHash; //Hash of the input and the settings
+
+  public:
+    hierarchyCache(const std::string &directory, const std::string &inputText, const std::string &settings);
+    const std::string &getPath() const { return path; }
+    //Returns false if there is no (valid) cache file for this input and these settings
+    bool load(std::vector<Step> &steps) const;
+    void save(const std::vector<Step> &steps) const;
+
+    /*
+    The ids in a loaded step refer to the tasks of its step, which only exist while the step is replayed, so they are checked then.
+    isValidAbstraction checks the safe variables against the task the step starts with,
+    isValidComposition checks the composition against the task without the safe variables.
+     */
+    static bool isValidAbstraction(const Step &step, const AbstractTask &task);
+    static bool isValidComposition(const Step &step, const AbstractTask &abstractedTask);
+};
+
+#endif //SAFE_ABSTRACTION_HIERARCHY_CACHE_H
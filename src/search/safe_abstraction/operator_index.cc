@@ -0,0 +1,79 @@
+#include "operator_index.h"
+
+/*
+Fills a CSR from (key, entry) pairs in two passes (count, then place). Entries are added in increasing order,
+so every list is sorted as long as the pairs are given in order of their entries.
+ */
+template<typename ForEachPair>
+static void buildCSR(int numKeys, std::vector<int> &offsets, std::vector<int> &entries, ForEachPair forEachPair)
+{
+    offsets.assign(numKeys + 1, 0);
+    forEachPair([&](int key, int) { offsets[key + 1]++; });
+    for (int i = 0; i < numKeys; ++i) { offsets[i + 1] += offsets[i]; }
+    entries.resize(offsets[numKeys]);
+    std::vector<int> next(offsets.begin(), offsets.end() - 1);
+    forEachPair([&](int key, int entry) { entries[next[key]++] = entry; });
+}
+
+operatorIndex::operatorIndex(const TaskProxy &taskProxy)
+{
+    VariablesProxy variables = taskProxy.get_variables();
+    OperatorsProxy operators = taskProxy.get_operators();
+    int numOperators = operators.size();
+
+    factOffsets.reserve(variables.size() + 1);
+    factOffsets.push_back(0);
+    for (VariableProxy var : variables)
+    {
+        factOffsets.push_back(factOffsets.back() + var.get_domain_size());
+        for (int val = 0; val < var.get_domain_size(); ++val) { factVariable.push_back(var.get_id()); }
+    }
+    int numFacts = factOffsets.back();
+
+    auto forEachPrecondition = [&](auto callback)
+    {
+        for (OperatorProxy op : operators)
+        {
+            for (FactProxy pre : op.get_preconditions())
+            {
+                callback(op.get_id(), getFactIndex(pre.get_variable().get_id(), pre.get_value()));
+            }
+        }
+    };
+    auto forEachEffect = [&](auto callback)
+    {
+        for (OperatorProxy op : operators)
+        {
+            for (EffectProxy eff : op.get_effects())
+            {
+                FactPair fact = eff.get_fact().get_pair();
+                callback(op.get_id(), getFactIndex(fact.var, fact.value));
+            }
+        }
+    };
+
+    buildCSR(numOperators, operatorPreconditions.offsets, operatorPreconditions.entries, forEachPrecondition);
+    buildCSR(numOperators, operatorEffects.offsets, operatorEffects.entries, forEachEffect);
+    buildCSR(numFacts, consumers.offsets, consumers.entries,
+             [&](auto callback) { forEachPrecondition([&](int op, int fact) { callback(fact, op); }); });
+    buildCSR(numFacts, producers.offsets, producers.entries,
+             [&](auto callback) { forEachEffect([&](int op, int fact) { callback(fact, op); }); });
+}
+
+int operatorIndex::getPreconditionValue(int opID, int var) const
+{
+    for (const int *fact = operatorPreconditions.begin(opID); fact != operatorPreconditions.end(opID); ++fact)
+    {
+        if (factVariable[*fact] == var) { return *fact - factOffsets[var]; }
+    }
+    return -1;
+}
+
+int operatorIndex::getEffectValue(int opID, int var) const
+{
+    for (const int *fact = operatorEffects.begin(opID); fact != operatorEffects.end(opID); ++fact)
+    {
+        if (factVariable[*fact] == var) { return *fact - factOffsets[var]; }
+    }
+    return -1;
+}
@@ -0,0 +1,53 @@
+#ifndef OPERATOR_INDEX_H
+#define OPERATOR_INDEX_H
+
+#include "../task_proxy.h"
+
+#include <vector>
+
+/*
+Fact -> operator index of a task, built once and then queried by the compositor.
+
+For every fact (var = val) it stores the operators that produce it (have it as effect) and the operators that consume it
+(have it as precondition). The lists are stored in a flat CSR layout: the operators of fact f are
+operators[offsets[f]] ... operators[offsets[f+1]-1], sorted by operator id. Facts are numbered variable by variable.
+
+Additionally the preconditions and effects of every operator are stored in the same way, so that the value an operator
+requires or sets for a variable can be looked up without going through the TaskProxy.
+ */
+class operatorIndex
+{
+  struct CSR {
+    std::vector<int> offsets;
+    std::vector<int> entries;
+
+    const int *begin(int i) const { return entries.data() + offsets[i]; }
+    const int *end(int i) const { return entries.data() + offsets[i+1]; }
+    int size(int i) const { return offsets[i+1] - offsets[i]; }
+  };
+
+  std::vector<int> factOffsets; //First fact index of every variable
+  CSR producers;
+  CSR consumers;
+  CSR operatorPreconditions; //Fact indices
+  CSR operatorEffects; //Fact indices
+  std::vector<int> factVariable;
+
+  public:
+    explicit operatorIndex(const TaskProxy &taskProxy);
+
+    int getFactIndex(int var, int val) const { return factOffsets[var] + val; }
+    int getNumValues(int var) const { return factOffsets[var+1] - factOffsets[var]; }
+    int getNumOperators() const { return (int)operatorEffects.offsets.size() - 1; }
+
+    const int *producersBegin(int var, int val) const { return producers.begin(getFactIndex(var, val)); }
+    const int *producersEnd(int var, int val) const { return producers.end(getFactIndex(var, val)); }
+    const int *consumersBegin(int var, int val) const { return consumers.begin(getFactIndex(var, val)); }
+    const int *consumersEnd(int var, int val) const { return consumers.end(getFactIndex(var, val)); }
+
+    //Value the operator requires / sets for the variable or -1 if it has no precondition / effect on it
+    int getPreconditionValue(int opID, int var) const;
+    int getEffectValue(int opID, int var) const;
+};
+
+#endif //OPERATOR_INDEX_H
@@ -1,7 +1,9 @@
 #include "refiner.h"
 #include "../task_proxy.h"
+#include "../tasks/simplified_task.h"
+#include "../utils/timer.h"
 
-Plan refiner::refine_plan(Plan plan, vector<pair<abstractor, compositor>> &abstraction_hirarchy)
+Plan refiner::refine_plan(Plan plan, vector<pair<abstractor, compositor>> &abstraction_hirarchy, bool costOptimal)
 {
     std::cout << "=============================== REFINEMNET =============================" << std::endl;
 
@@ -10,185 +12,151 @@ Plan refiner::refine_plan(Plan plan, vector<pair<abstractor, compositor>> &abstr
 	int i = 0;
 	std::reverse(abstraction_hirarchy.begin(), abstraction_hirarchy.end());
 
-    if (abstraction_hirarchy.size() > 0) { printPlan(plan, abstraction_hirarchy[0].first.getTaskProxy()); }
+    if (abstraction_hirarchy.size() > 0) { printPlan(plan, TaskProxy(*abstraction_hirarchy[0].second.getCompositedTask())); }
 
-    for (auto step : abstraction_hirarchy)
+    for (auto &step : abstraction_hirarchy)
     {
         cout << "> Refining Step: " << i << endl;
-        i++;
+        utils::Timer stepTimer;
 
         cout << "Decomposing Operators..." << endl;
         refiner::decompose_step(plan, step.second);
 
         cout << "Inserting missing Operators..." << endl;
-        refiner::refine_step(plan, step.first);
+        refiner::refine_step(plan, step.first, costOptimal);
 
         cout << "Intermediate Plan Length: " << plan.size() << endl;
         printPlan(plan, step.first.getTaskProxy());
+        stepTimer.stop();
+        cout << "Refinement time of step " << i << ": " << stepTimer << endl;
+        i++;
 
     }
     cout << endl;
     cout << "Took " << i << " steps to refine plan" << endl;
     cout << "Refined Plan Length: " << plan.size() << endl;
+    //The last step works on the original task
+    if (abstraction_hirarchy.size() > 0) { cout << "Refined Plan Cost: " << calculate_plan_cost(plan, abstraction_hirarchy.back().first.getTaskProxy()) << endl; }
     std::cout << "========================================================================" << std::endl;
     return plan;
 }
 
+static int parentOperatorID(const shared_ptr<tasks::SimplifiedTask> &task, int opID)
+{
+    return task ? task->get_parent_operator_id(opID) : opID;
+}
+
+/*
+Translates the plan from the composited task to the task the abstractor of this step works on in a single pass.
+The simplified tasks are compacted, so the operator ids are translated to the parent tasks on the way.
+ */
 void refiner::decompose_step(Plan &plan, compositor &compositor)
 {
-    std::map<int, std::vector<OperatorProxy>> decompositOperations = compositor.decompositOperations;
+    const std::map<int, std::vector<OperatorProxy>> &decompositOperations = compositor.decompositOperations;
+    shared_ptr<tasks::SimplifiedTask> compositedTask = dynamic_pointer_cast<tasks::SimplifiedTask>(compositor.getCompositedTask());
+    shared_ptr<tasks::SimplifiedTask> abstractTask = dynamic_pointer_cast<tasks::SimplifiedTask>(compositor.getAbstractTask());
 
-    if (decompositOperations.empty()) {
-        std::cout << "Nothing to decompose" << std::endl;
-        return;
-    }
+    if (decompositOperations.empty()) { std::cout << "Nothing to decompose" << std::endl; }
 
-    for (int i = 0; i < plan.size(); i++)
+    Plan decomposedPlan;
+    decomposedPlan.reserve(plan.size());
+    for (OperatorID op : plan)
     {
-        int opID = plan[i].get_index();
-        if (decompositOperations.count(opID) > 0)
-        {
-        	decomposeCompositeOperator(plan, compositor, i);
-            decompose_step(plan, compositor);
-            return;
-        }
+        refiner::decomposeCompositeOperator(decomposedPlan, decompositOperations, parentOperatorID(compositedTask, op.get_index()), abstractTask);
     }
+    plan.swap(decomposedPlan);
 }
 
-void refiner::decomposeCompositeOperator(Plan &plan, compositor &compositor, int insertionIndex)
+//Appends the operator to the plan, replacing composite operators (recursively) by the operators they consist of
+void refiner::decomposeCompositeOperator(Plan &plan, const std::map<int, std::vector<OperatorProxy>> &decompositOperations, int opID, const shared_ptr<tasks::SimplifiedTask> &abstractTask)
 {
-    int opID = plan[insertionIndex].get_index();
-    int offset = insertionIndex;
-
-    //cout << "Decomposing Operator " << opID << " at position " << insertionIndex << endl;
-
-	plan.erase(plan.begin() + insertionIndex);
-	for (auto operatorProxy : compositor.decompositOperations[opID])
-	{
-        //cout << "Inserting Operator " << operatorProxy.get_name() << " at position " << offset << endl;
-    	plan.insert(plan.begin()+offset, OperatorID(operatorProxy.get_id()));
-    	offset++;
-	}
+    auto decomposition = decompositOperations.find(opID);
+    if (decomposition == decompositOperations.end())
+    {
+        plan.push_back(OperatorID(parentOperatorID(abstractTask, opID)));
+        return;
+    }
+    for (const OperatorProxy &op : decomposition->second)
+    {
+        refiner::decomposeCompositeOperator(plan, decompositOperations, op.get_id(), abstractTask);
+    }
 }
 
-void refiner::refine_step(Plan &plan, abstractor &abstractor)
+/*
+Repairs the plan in a single forward pass: the plan is simulated on the task of this step and whenever a
+precondition (or, at the end, a goal) on an abstracted variable is not met, the free path leading to the
+required value is appended to the refined plan first. Free operators only mention their own variable,
+so a repair never invalidates the state of any other variable.
+ */
+void refiner::refine_step(Plan &plan, abstractor &abstractor, bool costOptimal)
 {
     //cout << "=== Refining" << endl;
     TaskProxy task_proxy = abstractor.getTaskProxy();
 
     auto operations = task_proxy.get_operators();
-    auto variables = task_proxy.get_variables();
     State initial_state = task_proxy.get_initial_state();
     auto goals = task_proxy.get_goals();
-    std::vector<FactPair> state;
+    std::vector<int> state = initial_state.get_unpacked_values();
 
-    for (auto fact : initial_state)
-    {
-        state.push_back(fact.get_pair());
-    }
+    Plan refinedPlan;
+    refinedPlan.reserve(plan.size());
 
-    for (int i = 0; i < plan.size(); i++)
+    for (OperatorID opID : plan)
     {
-        OperatorID opID = plan[i];
-
-      /*
-    	cout << "  Current State: " << endl;
-        for (auto fact : state)
-       	{
-       	    auto var_name = initial_state[fact.var].get_variable().get_name();
-       		cout << "    " << var_name << " = " << fact.value << endl;
-        }
-
-       */
-
         //cout << "opID: " << opID.get_index() << endl;
         auto op = operations[opID];
         for (auto precon : op.get_preconditions())
         {
-        	auto var = precon.get_variable();
-        	auto val = precon.get_value();
+        	int var = precon.get_variable().get_id();
+        	int val = precon.get_value();
 
-        	if (state[var.get_id()].value == val)
-        	{
-        		//cout << "  Precon " << var.get_name() << " = " << val << " is okay" << endl;
-        		continue;
-        	}
-        	else
+        	if (state[var] != val)
         	{
-        		//cout << "  Precon " << var.get_name() << " = " << val << " is NOT okay" << endl;
+        		//cout << "  Precon " << precon.get_variable().get_name() << " = " << val << " is NOT okay" << endl;
                 //Add missing operations here
-                refiner::insertMissingOperations(plan, abstractor, i, var.get_id(), state[var.get_id()].value, val);
-                refiner::refine_step(plan, abstractor);
-                return;
+                refiner::insertMissingOperations(refinedPlan, abstractor, var, state[var], val, costOptimal);
+                state[var] = val;
         	}
         }
 
         for (auto effect : op.get_effects())
         {
-			auto prostcon= effect.get_fact();
-			auto var = prostcon.get_variable();
-        	auto val = prostcon.get_value();
-
-			state[var.get_id()].value = val;
+			FactPair postcon = effect.get_fact().get_pair();
+			state[postcon.var] = postcon.value;
         }
+        refinedPlan.push_back(opID);
     }
     //cout << "Intermediate task has " << goals.size() << " goals" << endl;
     for (auto goal : goals)
     {
         int goalVar = goal.get_variable().get_id();
         int goalVal = goal.get_value();
-        if (state[goalVar].value == goalVal){
-            continue;}
-        else
+        if (state[goalVar] != goalVal)
         {
-            //cout << goal.get_variable().get_name() << " is not in its goal value " << goal.get_value() << ". Instead it has value: " << state[goalVar].value << endl;
-            int index;
-            if (!plan.empty())
-            {
-                index = plan.size();
-            }
-            else
-            {
-                index = 0;
-            }
-            refiner::insertMissingOperations(plan, abstractor, index, goalVar, state[goalVar].value, goalVal);
-            refiner::refine_step(plan, abstractor);
-            return;
+            //cout << goal.get_variable().get_name() << " is not in its goal value " << goal.get_value() << ". Instead it has value: " << state[goalVar] << endl;
+            refiner::insertMissingOperations(refinedPlan, abstractor, goalVar, state[goalVar], goalVal, costOptimal);
+            state[goalVar] = goalVal;
         }
     }
+    plan.swap(refinedPlan);
 }
 
-void refiner::insertMissingOperations(Plan &plan, abstractor &abstractor, int insertionIndex , int varID, int startVal, int endVal)
+//Appends the free path (the shortest or, if costOptimal is set, the cheapest one) of varID from startVal to endVal to the plan
+void refiner::insertMissingOperations(Plan &plan, abstractor &abstractor, int varID, int startVal, int endVal, bool costOptimal)
 {
-    //cout << "Inserting new opertaion at position " << insertionIndex << endl;
-    freeDTG freeDTG = *abstractor.find_freeDTG_by_variable(varID);
-    //cout << "  Searching for path" << endl;
-    std::vector<int> newOperations = freeDTG.getPath(startVal, endVal);
-    //cout << "  Found Length of path: " << newOperations.size() << endl;
-    std::reverse(newOperations.begin(), newOperations.end());
+    freeDTG &freeDTG = *abstractor.find_freeDTG_by_variable(varID);
+    std::vector<int> newOperations = freeDTG.getPath(startVal, endVal, costOptimal);
+    if (newOperations.empty())
+    {
+        cout << "  Found no free path of " << abstractor.getTaskProxy().get_variables()[varID].get_name()
+             << " from " << startVal << " to " << endVal << endl;
+        return;
+    }
     for (int opID : newOperations)
     {
         auto op = abstractor.getTaskProxy().get_operators()[opID];
         cout << "  Inserting operation: " << "(" << op.get_id() << ") " << op.get_name() << endl;
-        /*
-        cout << "    " << "Precon: ";
-        for (auto precondition : op.get_preconditions())
-        {
-            auto precon_var = precondition.get_variable();
-            int precon_val = precondition.get_value();
-            cout << precon_var.get_name() << " = " << precon_val << ", ";
-        }
-        cout << endl << "    " << "Postcon: ";
-        for (auto postcondition : op.get_effects())
-        {
-            auto postcondition_fact = postcondition.get_fact();
-            auto postcon_var = postcondition_fact.get_variable();
-            int postcon_val = postcondition_fact.get_value();
-            cout << postcon_var.get_name() << " = " << postcon_val << ", ";
-        }
-        cout << endl << endl;
-         */
-        plan.insert(plan.begin()+insertionIndex, OperatorID(opID));
+        plan.push_back(OperatorID(opID));
     }
 }
 
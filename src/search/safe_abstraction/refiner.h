@@ -5,16 +5,21 @@
 #include "../plan_manager.h"
 #include "abstractor.h"
 #include "compositor.h"
+#include "../tasks/simplified_task.h"
 
 class refiner {
     private:
         static void decompose_step(Plan &plan, compositor &compositor);
-        static void decomposeCompositeOperator(Plan &plan, compositor &compositor, int insertionIndex);
-        static void refine_step(Plan &plan, abstractor &abstractor);
-        static void insertMissingOperations(Plan &plan, abstractor &abstractor, int insertionIndex , int varID, int startVal, int endVal);
+        static void decomposeCompositeOperator(Plan &plan, const std::map<int, std::vector<OperatorProxy>> &decompositOperations, int opID, const std::shared_ptr<tasks::SimplifiedTask> &abstractTask);
+        static void refine_step(Plan &plan, abstractor &abstractor, bool costOptimal);
+        static void insertMissingOperations(Plan &plan, abstractor &abstractor, int varID, int startVal, int endVal, bool costOptimal);
         static void printPlan(Plan &plan, TaskProxy task_proxy);
     public:
-        static Plan refine_plan(Plan plan, vector<pair<abstractor, compositor>> &abstraction_hirarchy);
+        /*
+        Refines a plan of the most abstract task to a plan of the original task.
+        If costOptimal is set, missing values are reached by the cheapest free paths instead of the shortest ones.
+        */
+        static Plan refine_plan(Plan plan, vector<pair<abstractor, compositor>> &abstraction_hirarchy, bool costOptimal = false);
 };
 
 #endif //REFINER_H
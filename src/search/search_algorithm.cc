@@ -9,6 +9,7 @@
 #include "task_utils/task_properties.h"
 #include "tasks/root_task.h"
 #include "utils/countdown_timer.h"
+#include "utils/mapped_memory.h"
 #include "utils/rng_options.h"
 #include "utils/system.h"
 #include "utils/timer.h"
@@ -47,7 +48,9 @@ SearchAlgorithm::SearchAlgorithm(const plugins::Options &opts)
       task(tasks::g_root_task),
       task_proxy(*task),
       log(utils::get_log_from_options(opts)),
-      state_registry(task_proxy),
+      state_registry(
+          task_proxy, utils::create_external_memory_pool(),
+          opts.get<int>("state_compression")),
       successor_generator(get_successor_generator(task_proxy, log)),
       search_space(state_registry, log),
       statistics(log),
@@ -59,6 +62,8 @@ SearchAlgorithm::SearchAlgorithm(const plugins::Options &opts)
         utils::exit_with(ExitCode::SEARCH_INPUT_ERROR);
     }
     bound = opts.get<int>("bound");
+    if (opts.get<bool>("profile"))
+        statistics.get_profiler().enable(opts.get<double>("profile_interval"));
     task_properties::print_variable_statistics(task_proxy);
 }
 
@@ -86,6 +91,7 @@ void SearchAlgorithm::set_plan(const Plan &p) {
 void SearchAlgorithm::search() {
     initialize();
     utils::CountdownTimer timer(max_time);
+    SearchProfiler &profiler = statistics.get_profiler();
     while (status == IN_PROGRESS) {
         status = step();
         if (timer.is_expired()) {
@@ -93,9 +99,11 @@ void SearchAlgorithm::search() {
             status = TIMEOUT;
             break;
         }
+        profiler.print_report_if_due(statistics, log);
     }
     // TODO: Revise when and which search times are logged.
     log << "Actual search time: " << timer.get_elapsed_time() << endl;
+    profiler.print_final_report(statistics, log);
 }
 
 bool SearchAlgorithm::check_goal_and_set_plan(const State &state) {
@@ -148,6 +156,31 @@ void SearchAlgorithm::add_options_to_feature(plugins::Feature &feature) {
         "experiments. Timed-out searches are treated as failed searches, "
         "just like incomplete search algorithms that exhaust their search space.",
         "infinity");
+    feature.add_option<int>(
+        "state_compression",
+        "store registered states dictionary-encoded: every group of this many "
+        "consecutive bins of a packed state is replaced by the index of its "
+        "value in a dictionary of the values the group has taken so far. "
+        "This saves memory if the groups take few distinct values, at the "
+        "cost of decoding states whenever they are looked up. "
+        "0 stores states uncompressed.",
+        "0",
+        plugins::Bounds("0", "infinity"));
+    feature.add_option<bool>(
+        "profile",
+        "measure the time spent in successor generation, state registration, "
+        "pruning, open list insertion and removal and in each evaluator, and "
+        "print it as a JSON object on a line starting with \"Search profile:\" "
+        "periodically and at the end of the search. Times are inclusive, so "
+        "evaluations that happen during other phases are counted for both. "
+        "Currently only eager and lazy search time their phases.",
+        "false");
+    feature.add_option<double>(
+        "profile_interval",
+        "seconds of search time between two profile reports if "
+        "profile=true (0 means that only the final report is printed)",
+        "10.0",
+        plugins::Bounds("0.0", "infinity"));
     utils::add_log_options_to_feature(feature);
 }
 
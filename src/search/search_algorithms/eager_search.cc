@@ -4,12 +4,14 @@
 #include "../evaluator.h"
 #include "../open_list_factory.h"
 #include "../pruning_method.h"
+#include "../search_profiler.h"
 
 #include "../algorithms/ordered_set.h"
-#include "../plugins/options.h"
+#include "../plugins/plugin.h"
 #include "../task_utils/successor_generator.h"
 #include "../utils/logging.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <memory>
@@ -27,6 +29,7 @@ EagerSearch::EagerSearch(const plugins::Options &opts)
       f_evaluator(opts.get<shared_ptr<Evaluator>>("f_eval", nullptr)),
       preferred_operator_evaluators(opts.get_list<shared_ptr<Evaluator>>("preferred")),
       lazy_evaluator(opts.get<shared_ptr<Evaluator>>("lazy_evaluator", nullptr)),
+      batch_evaluators(opts.get_list<shared_ptr<Evaluator>>("batch_evaluators")),
       pruning_method(opts.get<shared_ptr<PruningMethod>>("pruning")) {
     if (lazy_evaluator && !lazy_evaluator->does_cache_estimates()) {
         cerr << "lazy_evaluator must cache its estimates" << endl;
@@ -93,6 +96,7 @@ void EagerSearch::initialize() {
         SearchNode node = search_space.get_node(initial_state);
         node.open_initial();
 
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_INSERTION);
         open_list->insert(eval_context, initial_state.get_id());
     }
 
@@ -114,7 +118,11 @@ SearchStatus EagerSearch::step() {
             log << "Completely explored state space -- no solution!" << endl;
             return FAILED;
         }
-        StateID id = open_list->remove_min();
+        StateID id = StateID::no_state;
+        {
+            ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_REMOVAL);
+            id = open_list->remove_min();
+        }
         State s = state_registry.lookup_state(id);
         node.emplace(search_space.get_node(s));
 
@@ -154,6 +162,7 @@ SearchStatus EagerSearch::step() {
                     continue;
                 }
                 if (new_h != old_h) {
+                    ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_INSERTION);
                     open_list->insert(eval_context, id);
                     continue;
                 }
@@ -172,13 +181,19 @@ SearchStatus EagerSearch::step() {
         return SOLVED;
 
     vector<OperatorID> applicable_ops;
-    successor_generator.generate_applicable_ops(s, applicable_ops);
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::SUCCESSOR_GENERATION);
+        successor_generator.generate_applicable_ops(s, applicable_ops);
+    }
 
     /*
       TODO: When preferred operators are in use, a preferred operator will be
       considered by the preferred operator queues even when it is pruned.
     */
-    pruning_method->prune_operators(s, applicable_ops);
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::PRUNING);
+        pruning_method->prune_operators(s, applicable_ops);
+    }
 
     // This evaluates the expanded state (again) to get preferred ops
     EvaluationContext eval_context(s, node->get_g(), false, &statistics, true);
@@ -189,12 +204,48 @@ SearchStatus EagerSearch::step() {
                                     preferred_operators);
     }
 
-    for (OperatorID op_id : applicable_ops) {
-        OperatorProxy op = task_proxy.get_operators()[op_id];
-        if ((node->get_real_g() + op.get_cost()) >= bound)
-            continue;
+    applicable_ops.erase(
+        remove_if(applicable_ops.begin(), applicable_ops.end(),
+                  [&](OperatorID op_id) {
+                      OperatorProxy op = task_proxy.get_operators()[op_id];
+                      return node->get_real_g() + op.get_cost() >= bound;
+                  }),
+        applicable_ops.end());
+
+    vector<State> succ_states;
+    succ_states.reserve(applicable_ops.size());
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::STATE_REGISTRATION);
+        state_registry.get_successor_states(s, applicable_ops, succ_states);
+    }
 
-        State succ_state = state_registry.get_successor_state(s, op);
+    if (!batch_evaluators.empty()) {
+        new_states.clear();
+        for (const State &succ_state : succ_states) {
+            /*
+              Several operators can lead to the same successor. The
+              number of successors is small, so a linear search for
+              duplicates is cheap enough.
+            */
+            if (search_space.get_node(succ_state).is_new() &&
+                none_of(new_states.begin(), new_states.end(),
+                        [&](const State &state) {
+                            return state.get_id() == succ_state.get_id();
+                        }))
+                new_states.push_back(succ_state);
+        }
+        for (const shared_ptr<Evaluator> &evaluator : batch_evaluators) {
+            ScopedProfileTimer timer(&statistics.get_profiler(), evaluator.get());
+            int num_evaluations = evaluator->evaluate_batch(new_states);
+            if (evaluator->is_used_for_counting_evaluations())
+                statistics.inc_evaluations(num_evaluations);
+        }
+    }
+
+    for (size_t i = 0; i < applicable_ops.size(); ++i) {
+        OperatorID op_id = applicable_ops[i];
+        OperatorProxy op = task_proxy.get_operators()[op_id];
+        const State &succ_state = succ_states[i];
         statistics.inc_generated();
         bool is_preferred = preferred_operators.contains(op_id);
 
@@ -228,7 +279,10 @@ SearchStatus EagerSearch::step() {
             }
             succ_node.open(*node, op, get_adjusted_cost(op));
 
-            open_list->insert(succ_eval_context, succ_state.get_id());
+            {
+                ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_INSERTION);
+                open_list->insert(succ_eval_context, succ_state.get_id());
+            }
             if (search_progress.check_progress(succ_eval_context)) {
                 statistics.print_checkpoint_line(succ_node.get_g());
                 reward_progress();
@@ -268,6 +322,7 @@ SearchStatus EagerSearch::step() {
                   rather than a recomputation of the evaluator value
                   from scratch.
                 */
+                ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_INSERTION);
                 open_list->insert(succ_eval_context, succ_state.get_id());
             } else {
                 // If we do not reopen closed nodes, we just update the parent pointers.
@@ -308,6 +363,14 @@ void EagerSearch::update_f_value_statistics(EvaluationContext &eval_context) {
 }
 
 void add_options_to_feature(plugins::Feature &feature) {
+    feature.add_list_option<shared_ptr<Evaluator>>(
+        "batch_evaluators",
+        "evaluate the new successors of each expanded state with these "
+        "evaluators in one batch before they are inserted into the open "
+        "list. This only has an effect for evaluators that cache their "
+        "estimates and can evaluate batches efficiently (currently hmax "
+        "and add).",
+        "[]");
     SearchAlgorithm::add_pruning_option(feature);
     SearchAlgorithm::add_options_to_feature(feature);
 }
@@ -24,6 +24,9 @@ class EagerSearch : public SearchAlgorithm {
     std::vector<Evaluator *> path_dependent_evaluators;
     std::vector<std::shared_ptr<Evaluator>> preferred_operator_evaluators;
     std::shared_ptr<Evaluator> lazy_evaluator;
+    std::vector<std::shared_ptr<Evaluator>> batch_evaluators;
+    // Buffer for the new successor states that are evaluated in a batch.
+    std::vector<State> new_states;
 
     std::shared_ptr<PruningMethod> pruning_method;
 
@@ -0,0 +1,449 @@
+#include "hda_star_search.h"
+
+#include "../evaluation_context.h"
+#include "../evaluator.h"
+#include "../per_state_information.h"
+
+#include "../plugins/plugin.h"
+#include "../task_utils/successor_generator.h"
+#include "../task_utils/task_properties.h"
+#include "../utils/countdown_timer.h"
+#include "../utils/logging.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <queue>
+#include <set>
+#include <thread>
+
+using namespace std;
+
+namespace hda_star_search {
+static const int INF = numeric_limits<int>::max();
+
+/*
+  A successor sent to the worker owning it. The packed state data is stored
+  in the state_data vector of the batch (bins_per_state bins per message).
+*/
+struct SuccessorMessage {
+    int g;
+    int real_g;
+    int parent_worker;
+    StateID parent_id;
+    int op_id;
+};
+
+struct MessageBatch {
+    MessageBatch *next = nullptr;
+    vector<SuccessorMessage> messages;
+    vector<PackedStateBin> state_data;
+};
+
+/*
+  Multi-producer single-consumer queue of message batches. Producers push
+  onto a lock-free stack, the consumer takes the whole stack at once and
+  restores the order in which the batches were pushed.
+*/
+class MessageQueue {
+    atomic<MessageBatch *> head;
+public:
+    MessageQueue() : head(nullptr) {
+    }
+
+    ~MessageQueue() {
+        MessageBatch *batch = pop_all();
+        while (batch) {
+            MessageBatch *next = batch->next;
+            delete batch;
+            batch = next;
+        }
+    }
+
+    void push(MessageBatch *batch) {
+        batch->next = head.load(memory_order_relaxed);
+        while (!head.compare_exchange_weak(
+                   batch->next, batch,
+                   memory_order_release, memory_order_relaxed)) {
+        }
+    }
+
+    MessageBatch *pop_all() {
+        MessageBatch *batch = head.exchange(nullptr, memory_order_acquire);
+        MessageBatch *reversed = nullptr;
+        while (batch) {
+            MessageBatch *next = batch->next;
+            batch->next = reversed;
+            reversed = batch;
+            batch = next;
+        }
+        return reversed;
+    }
+};
+
+struct NodeInfo {
+    int g = -1; // -1 for states that were not reached yet
+    int real_g = -1;
+    int h = -1;
+    bool closed = false;
+    bool dead_end = false;
+    int parent_worker = -1;
+    StateID parent_id = StateID::no_state;
+    int op_id = -1;
+};
+
+struct OpenEntry {
+    int f;
+    int h;
+    int g;
+    StateID id;
+
+    OpenEntry(int f, int h, int g, StateID id)
+        : f(f), h(h), g(g), id(id) {
+    }
+
+    // Order for a max-heap that returns the entry with the lowest f (ties: lowest h) first.
+    bool operator<(const OpenEntry &other) const {
+        if (f != other.f)
+            return f > other.f;
+        return h > other.h;
+    }
+};
+
+struct Worker {
+    int id;
+    shared_ptr<Evaluator> evaluator;
+    StateRegistry registry;
+    PerStateInformation<NodeInfo> nodes;
+    priority_queue<OpenEntry> open_list;
+    MessageQueue inbox;
+    // One batch per worker collecting the successors sent to it during an expansion.
+    vector<unique_ptr<MessageBatch>> outbox;
+
+    long long expanded = 0;
+    long long evaluated = 0;
+    long long generated = 0;
+    long long reopened = 0;
+    long long dead_ends = 0;
+    long long received = 0;
+
+    Worker(int id, const shared_ptr<Evaluator> &evaluator,
+           const TaskProxy &task_proxy, int num_workers)
+        : id(id),
+          evaluator(evaluator),
+          registry(task_proxy),
+          outbox(num_workers) {
+    }
+};
+
+HDAStarSearch::HDAStarSearch(const plugins::Options &opts)
+    : SearchAlgorithm(opts),
+      evaluators(opts.get_list<shared_ptr<Evaluator>>("evals")),
+      work_remaining(0),
+      incumbent_cost(INF),
+      timed_out(false),
+      goal_worker(-1),
+      goal_id(StateID::no_state) {
+    task_properties::verify_no_axioms(task_proxy);
+
+    set<Evaluator *> distinct_evaluators;
+    set<Evaluator *> path_dependent_evaluators;
+    for (const shared_ptr<Evaluator> &evaluator : evaluators) {
+        distinct_evaluators.insert(evaluator.get());
+        evaluator->get_path_dependent_evaluators(path_dependent_evaluators);
+    }
+    if (distinct_evaluators.size() != evaluators.size()) {
+        cerr << "hdastar needs a separate evaluator object for every thread "
+             << "(do not pass the same variable several times)" << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_INPUT_ERROR);
+    }
+    if (!path_dependent_evaluators.empty()) {
+        cerr << "hdastar does not support path-dependent evaluators" << endl;
+        utils::exit_with(utils::ExitCode::SEARCH_UNSUPPORTED);
+    }
+
+    // Registries have to be created here: the per-task caches they use are not thread-safe.
+    int num_workers = evaluators.size();
+    for (int i = 0; i < num_workers; ++i) {
+        workers.push_back(make_unique<Worker>(i, evaluators[i], task_proxy, num_workers));
+    }
+}
+
+HDAStarSearch::~HDAStarSearch() {
+}
+
+int HDAStarSearch::get_owner(const PackedStateBin *buffer) const {
+    int num_bins = state_registry.get_state_packer().get_num_bins();
+    uint64_t hash = StateRegistry::get_packed_state_hash(buffer, num_bins);
+    /*
+      Use the high bits of the hash: the hash sets of the registries use the
+      low bits to pick buckets, which would otherwise be the same for all
+      states owned by one worker.
+    */
+    return static_cast<int>((hash * workers.size()) >> 32);
+}
+
+/*
+  Registers the state in the worker's registry and (re)opens it if it is new
+  or was reached more cheaply. Returns true if an open list entry was added.
+*/
+bool HDAStarSearch::reach_state(
+    Worker &worker, const PackedStateBin *buffer, int g, int real_g,
+    int parent_worker, StateID parent_id, int op_id) {
+    State state = worker.registry.register_state(buffer);
+    NodeInfo &node = worker.nodes[state];
+    if (node.dead_end)
+        return false;
+    if (node.g == -1) {
+        EvaluationContext eval_context(state, g, false, nullptr);
+        ++worker.evaluated;
+        if (eval_context.is_evaluator_value_infinite(worker.evaluator.get())) {
+            node.g = g;
+            node.dead_end = true;
+            ++worker.dead_ends;
+            return false;
+        }
+        node.h = eval_context.get_evaluator_value(worker.evaluator.get());
+    } else if (g >= node.g) {
+        return false;
+    } else if (node.closed) {
+        node.closed = false;
+        ++worker.reopened;
+    }
+    node.g = g;
+    node.real_g = real_g;
+    node.parent_worker = parent_worker;
+    node.parent_id = parent_id;
+    node.op_id = op_id;
+    worker.open_list.emplace(g + node.h, node.h, g, state.get_id());
+    return true;
+}
+
+void HDAStarSearch::process_messages(Worker &worker) {
+    int num_bins = state_registry.get_state_packer().get_num_bins();
+    MessageBatch *batch = worker.inbox.pop_all();
+    while (batch) {
+        long long discarded = 0;
+        for (size_t i = 0; i < batch->messages.size(); ++i) {
+            const SuccessorMessage &message = batch->messages[i];
+            ++worker.received;
+            if (!reach_state(worker, &batch->state_data[i * num_bins],
+                             message.g, message.real_g, message.parent_worker,
+                             message.parent_id, message.op_id)) {
+                ++discarded;
+            }
+        }
+        // Messages that turned into open list entries stay counted.
+        work_remaining -= discarded;
+        MessageBatch *next = batch->next;
+        delete batch;
+        batch = next;
+    }
+}
+
+void HDAStarSearch::expand(Worker &worker, const State &state) {
+    const NodeInfo &node = worker.nodes[state];
+    int g = node.g;
+    int real_g = node.real_g;
+    int num_bins = state_registry.get_state_packer().get_num_bins();
+    const int_packer::IntPacker &state_packer = state_registry.get_state_packer();
+
+    vector<OperatorID> applicable_ops;
+    successor_generator.generate_applicable_ops(state, applicable_ops);
+    vector<PackedStateBin> buffer(num_bins);
+    for (OperatorID op_id : applicable_ops) {
+        OperatorProxy op = task_proxy.get_operators()[op_id];
+        if (real_g + op.get_cost() >= bound)
+            continue;
+        int succ_g = g + get_adjusted_cost(op);
+        if (succ_g >= incumbent_cost.load(memory_order_relaxed))
+            continue;
+
+        copy(state.get_buffer(), state.get_buffer() + num_bins, buffer.begin());
+        for (EffectProxy effect : op.get_effects()) {
+            if (does_fire(effect, state)) {
+                FactPair effect_pair = effect.get_fact().get_pair();
+                state_packer.set(buffer.data(), effect_pair.var, effect_pair.value);
+            }
+        }
+        ++worker.generated;
+
+        int owner = get_owner(buffer.data());
+        if (owner == worker.id) {
+            if (reach_state(worker, buffer.data(), succ_g, real_g + op.get_cost(),
+                            worker.id, state.get_id(), op_id.get_index()))
+                ++work_remaining;
+        } else {
+            unique_ptr<MessageBatch> &batch = worker.outbox[owner];
+            if (!batch)
+                batch = make_unique<MessageBatch>();
+            batch->messages.push_back(
+                {succ_g, real_g + op.get_cost(), worker.id, state.get_id(),
+                 op_id.get_index()});
+            batch->state_data.insert(batch->state_data.end(), buffer.begin(), buffer.end());
+        }
+    }
+
+    for (size_t owner = 0; owner < workers.size(); ++owner) {
+        unique_ptr<MessageBatch> &batch = worker.outbox[owner];
+        if (!batch)
+            continue;
+        // Count the messages before they can be processed (and discounted).
+        work_remaining += batch->messages.size();
+        workers[owner]->inbox.push(batch.release());
+    }
+}
+
+void HDAStarSearch::report_goal(const Worker &worker, StateID id, int g) {
+    lock_guard<mutex> lock(incumbent_mutex);
+    if (g < incumbent_cost.load()) {
+        incumbent_cost = g;
+        goal_worker = worker.id;
+        goal_id = id;
+    }
+}
+
+void HDAStarSearch::run_worker(Worker &worker, double max_time) {
+    utils::CountdownTimer timer(max_time);
+    while (work_remaining.load() > 0 && !timed_out.load(memory_order_relaxed)) {
+        process_messages(worker);
+        if (worker.open_list.empty()) {
+            this_thread::yield();
+            continue;
+        }
+
+        OpenEntry entry = worker.open_list.top();
+        worker.open_list.pop();
+        State state = worker.registry.lookup_state(entry.id);
+        NodeInfo &node = worker.nodes[state];
+        // Skip entries of nodes that were reopened with a lower g since and nodes that can't lead to a better plan.
+        if (node.closed || entry.g != node.g ||
+            entry.f >= incumbent_cost.load(memory_order_relaxed)) {
+            --work_remaining;
+            continue;
+        }
+        node.closed = true;
+        ++worker.expanded;
+
+        if (task_properties::is_goal_state(task_proxy, state)) {
+            report_goal(worker, entry.id, node.g);
+        } else {
+            expand(worker, state);
+        }
+        --work_remaining;
+
+        if ((worker.expanded & 1023) == 0 && timer.is_expired())
+            timed_out = true;
+    }
+}
+
+Plan HDAStarSearch::extract_plan() const {
+    Plan plan;
+    int worker_id = goal_worker;
+    StateID id = goal_id;
+    while (true) {
+        const Worker &worker = *workers[worker_id];
+        State state = worker.registry.lookup_state(id);
+        const NodeInfo &node = worker.nodes[state];
+        if (node.op_id == -1)
+            break;
+        plan.push_back(OperatorID(node.op_id));
+        worker_id = node.parent_worker;
+        id = node.parent_id;
+    }
+    reverse(plan.begin(), plan.end());
+    return plan;
+}
+
+void HDAStarSearch::initialize() {
+    log << "Conducting hash-distributed A* search with " << workers.size()
+        << " threads, (real) bound = " << bound << endl;
+
+    State initial_state = state_registry.get_initial_state();
+    Worker &owner = *workers[get_owner(initial_state.get_buffer())];
+    if (reach_state(owner, initial_state.get_buffer(), 0, 0, -1, StateID::no_state, -1)) {
+        work_remaining = 1;
+        State owned_initial_state = owner.registry.lookup_state(owner.open_list.top().id);
+        log << "Initial heuristic value: " << owner.nodes[owned_initial_state].h << endl;
+    } else {
+        log << "Initial state is a dead end." << endl;
+    }
+}
+
+SearchStatus HDAStarSearch::step() {
+    vector<thread> threads;
+    for (const unique_ptr<Worker> &worker : workers) {
+        threads.emplace_back(&HDAStarSearch::run_worker, this, ref(*worker), max_time);
+    }
+    for (thread &thread : threads) {
+        thread.join();
+    }
+
+    for (const unique_ptr<Worker> &worker : workers) {
+        statistics.inc_expanded(worker->expanded);
+        statistics.inc_evaluated_states(worker->evaluated);
+        statistics.inc_evaluations(worker->evaluated);
+        statistics.inc_generated(worker->generated);
+        statistics.inc_reopened(worker->reopened);
+        statistics.inc_dead_ends(worker->dead_ends);
+    }
+
+    if (goal_worker == -1) {
+        if (timed_out) {
+            log << "Time limit reached. Abort search." << endl;
+        } else {
+            log << "Completely explored state space -- no solution!" << endl;
+        }
+        return FAILED;
+    }
+    if (timed_out) {
+        // The best plan found so far is not guaranteed to be optimal.
+        log << "Time limit reached. Returning the best plan found so far." << endl;
+    }
+    log << "Solution found!" << endl;
+    set_plan(extract_plan());
+    return SOLVED;
+}
+
+void HDAStarSearch::print_statistics() const {
+    statistics.print_detailed_statistics();
+    long long registered = 0;
+    for (const unique_ptr<Worker> &worker : workers) {
+        registered += worker->registry.size();
+        log << "Worker " << worker->id << ": " << worker->expanded
+            << " expanded, " << worker->registry.size() << " registered, "
+            << worker->received << " received state(s)" << endl;
+    }
+    log << "Number of registered states: " << registered << endl;
+}
+
+class HDAStarSearchFeature : public plugins::TypedFeature<SearchAlgorithm, HDAStarSearch> {
+public:
+    HDAStarSearchFeature() : TypedFeature("hdastar") {
+        document_title("Hash-distributed A* search");
+        document_synopsis(
+            "Parallel A* that distributes the states among one thread per "
+            "evaluator by their hash. Every thread stores, expands and "
+            "evaluates the states it owns and sends the successors it "
+            "generates to their owners. Closed nodes are re-opened.");
+
+        add_list_option<shared_ptr<Evaluator>>(
+            "evals",
+            "evaluators for h-values, one per thread. They must be distinct "
+            "objects since evaluators are not thread-safe, e.g. "
+            "[lmcut(), lmcut(), lmcut(), lmcut()] for four threads.");
+        SearchAlgorithm::add_options_to_feature(*this);
+
+        document_note(
+            "Supported tasks",
+            "Tasks with axioms and path-dependent evaluators are not supported.");
+    }
+
+    virtual shared_ptr<HDAStarSearch> create_component(const plugins::Options &options, const utils::Context &context) const override {
+        plugins::verify_list_non_empty<shared_ptr<Evaluator>>(context, options, "evals");
+        return make_shared<HDAStarSearch>(options);
+    }
+};
+
+static plugins::FeaturePlugin<HDAStarSearchFeature> _plugin;
+}
@@ -0,0 +1,72 @@
+#ifndef SEARCH_ALGORITHMS_HDA_STAR_SEARCH_H
+#define SEARCH_ALGORITHMS_HDA_STAR_SEARCH_H
+
+#include "../search_algorithm.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class Evaluator;
+
+namespace plugins {
+class Options;
+}
+
+namespace hda_star_search {
+struct Worker;
+
+/*
+  Hash-distributed A* (Kishimoto, Fukunaga and Botea, 2009).
+
+  Every worker thread owns the states whose hash maps to it: it registers
+  them in its own StateRegistry, keeps their search nodes and its own open
+  list and evaluates them with its own evaluator. Successors of expanded
+  states are sent to their owner through lock-free message queues.
+
+  The search ends when no worker has open nodes or unprocessed messages left.
+  Until then, nodes whose f-value is not below the cost of the best plan found
+  so far are pruned, so the resulting plan is optimal for admissible
+  evaluators.
+*/
+class HDAStarSearch : public SearchAlgorithm {
+    std::vector<std::shared_ptr<Evaluator>> evaluators;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /*
+      Number of open list entries plus number of messages that were sent
+      but not processed yet, summed over all workers. Every new entry or
+      message is counted before the entry it stems from is discounted, so
+      the counter only reaches zero when the search space is exhausted.
+    */
+    std::atomic<long long> work_remaining;
+    std::atomic<int> incumbent_cost;
+    std::atomic<bool> timed_out;
+    std::mutex incumbent_mutex;
+    int goal_worker;
+    StateID goal_id;
+
+    int get_owner(const PackedStateBin *buffer) const;
+    bool reach_state(
+        Worker &worker, const PackedStateBin *buffer, int g, int real_g,
+        int parent_worker, StateID parent_id, int op_id);
+    void process_messages(Worker &worker);
+    void expand(Worker &worker, const State &state);
+    void report_goal(const Worker &worker, StateID id, int g);
+    void run_worker(Worker &worker, double max_time);
+    Plan extract_plan() const;
+
+protected:
+    virtual void initialize() override;
+    virtual SearchStatus step() override;
+
+public:
+    explicit HDAStarSearch(const plugins::Options &opts);
+    virtual ~HDAStarSearch() override;
+
+    virtual void print_statistics() const override;
+};
+}
+
+#endif
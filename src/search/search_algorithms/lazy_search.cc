@@ -1,6 +1,7 @@
 #include "lazy_search.h"
 
 #include "../open_list_factory.h"
+#include "../search_profiler.h"
 
 #include "../algorithms/ordered_set.h"
 #include "../plugins/options.h"
@@ -97,8 +98,11 @@ void LazySearch::generate_successors() {
         preferred_operators.shuffle(*rng);
     }
 
-    vector<OperatorID> successor_operators =
-        get_successor_operators(preferred_operators);
+    vector<OperatorID> successor_operators;
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::SUCCESSOR_GENERATION);
+        successor_operators = get_successor_operators(preferred_operators);
+    }
 
     statistics.inc_generated(successor_operators.size());
 
@@ -110,6 +114,7 @@ void LazySearch::generate_successors() {
         if (new_real_g < bound) {
             EvaluationContext new_eval_context(
                 current_eval_context, new_g, is_preferred, nullptr);
+            ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_INSERTION);
             open_list->insert(new_eval_context, make_pair(current_state.get_id(), op_id));
         }
     }
@@ -121,14 +126,21 @@ SearchStatus LazySearch::fetch_next_state() {
         return FAILED;
     }
 
-    EdgeOpenListEntry next = open_list->remove_min();
+    EdgeOpenListEntry next(StateID::no_state, OperatorID::no_operator);
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::OPEN_LIST_REMOVAL);
+        next = open_list->remove_min();
+    }
 
     current_predecessor_id = next.first;
     current_operator_id = next.second;
     State current_predecessor = state_registry.lookup_state(current_predecessor_id);
     OperatorProxy current_operator = task_proxy.get_operators()[current_operator_id];
     assert(task_properties::is_applicable(current_operator, current_predecessor));
-    current_state = state_registry.get_successor_state(current_predecessor, current_operator);
+    {
+        ScopedProfileTimer timer(statistics.get_profiler(), SearchPhase::STATE_REGISTRATION);
+        current_state = state_registry.get_successor_state(current_predecessor, current_operator);
+    }
 
     SearchNode pred_node = search_space.get_node(current_predecessor);
     current_g = pred_node.get_g() + get_adjusted_cost(current_operator);
@@ -0,0 +1,115 @@
+#include "search_profiler.h"
+
+#include "evaluator.h"
+#include "search_statistics.h"
+
+#include "utils/logging.h"
+
+#include <cmath>
+#include <sstream>
+
+using namespace std;
+
+static const vector<string> PHASE_NAMES = {
+    "successor_generation",
+    "state_registration",
+    "open_list_insertion",
+    "open_list_removal",
+    "pruning"
+};
+
+static double get_seconds(SearchProfiler::Clock::duration duration) {
+    return chrono::duration<double>(duration).count();
+}
+
+static void print_json_string(ostream &out, const string &str) {
+    out << '"';
+    for (char c : str) {
+        if (c == '"' || c == '\\')
+            out << '\\';
+        out << c;
+    }
+    out << '"';
+}
+
+static void print_json_entry(ostream &out, const SearchProfiler::Entry &entry) {
+    out << "\"calls\": " << entry.calls
+        << ", \"seconds\": " << get_seconds(entry.time);
+}
+
+SearchProfiler::SearchProfiler()
+    : enabled(false),
+      report_interval(Clock::duration::max()),
+      phases(PHASE_NAMES.size()) {
+}
+
+void SearchProfiler::enable(double report_interval_in_seconds) {
+    enabled = true;
+    start_time = Clock::now();
+    if (report_interval_in_seconds == 0 || isinf(report_interval_in_seconds)) {
+        next_report_time = Clock::time_point::max();
+    } else {
+        report_interval = chrono::duration_cast<Clock::duration>(
+            chrono::duration<double>(report_interval_in_seconds));
+        next_report_time = start_time + report_interval;
+    }
+}
+
+SearchProfiler::Entry &SearchProfiler::get_entry(const Evaluator *evaluator) {
+    int slot = evaluator->get_cache_slot();
+    if (slot >= static_cast<int>(evaluator_entries.size())) {
+        // Make room for all existing evaluators at once (see EvaluatorCache).
+        evaluator_entries.resize(Evaluator::get_num_cache_slots());
+        evaluators.resize(Evaluator::get_num_cache_slots(), nullptr);
+    }
+    evaluators[slot] = evaluator;
+    return evaluator_entries[slot];
+}
+
+void SearchProfiler::print_report(
+    const SearchStatistics &statistics, utils::LogProxy &log,
+    bool is_final) const {
+    double seconds = get_seconds(Clock::now() - start_time);
+    ostringstream out;
+    out << "{\"final\": " << (is_final ? "true" : "false")
+        << ", \"seconds\": " << seconds
+        << ", \"expanded\": " << statistics.get_expanded()
+        << ", \"evaluated\": " << statistics.get_evaluated_states()
+        << ", \"generated\": " << statistics.get_generated();
+    if (seconds > 0) {
+        out << ", \"expanded_per_second\": "
+            << statistics.get_expanded() / seconds
+            << ", \"generated_per_second\": "
+            << statistics.get_generated() / seconds;
+    }
+    out << ", \"phases\": {";
+    for (size_t phase = 0; phase < phases.size(); ++phase) {
+        if (phase > 0)
+            out << ", ";
+        out << '"' << PHASE_NAMES[phase] << "\": {";
+        print_json_entry(out, phases[phase]);
+        out << "}";
+    }
+    out << "}, \"evaluators\": [";
+    bool first = true;
+    for (size_t slot = 0; slot < evaluators.size(); ++slot) {
+        if (!evaluators[slot])
+            continue;
+        if (!first)
+            out << ", ";
+        first = false;
+        out << "{\"name\": ";
+        print_json_string(out, evaluators[slot]->get_description());
+        out << ", ";
+        print_json_entry(out, evaluator_entries[slot]);
+        out << "}";
+    }
+    out << "]}";
+    log << "Search profile: " << out.str() << endl;
+}
+
+void SearchProfiler::print_final_report(
+    const SearchStatistics &statistics, utils::LogProxy &log) const {
+    if (enabled)
+        print_report(statistics, log, true);
+}
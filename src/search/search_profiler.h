@@ -0,0 +1,135 @@
+#ifndef SEARCH_PROFILER_H
+#define SEARCH_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class Evaluator;
+class SearchStatistics;
+
+namespace utils {
+class LogProxy;
+}
+
+/*
+  Phases of a search step that are profiled separately. Evaluators are
+  profiled individually in addition to these phases.
+*/
+enum class SearchPhase {
+    SUCCESSOR_GENERATION,
+    STATE_REGISTRATION,
+    OPEN_LIST_INSERTION,
+    OPEN_LIST_REMOVAL,
+    PRUNING
+};
+
+/*
+  Optional profile of where a search spends its time.
+
+  If profiling is enabled, the search measures the time spent in each
+  SearchPhase and in each evaluator and counts how often they are entered.
+  Reports are printed periodically and at the end of the search as a line
+  "Search profile: " followed by a JSON object.
+
+  Times are taken by ScopedProfileTimer objects around the profiled code.
+  If profiling is disabled, a timer only tests a flag. Times are
+  inclusive: evaluators are usually computed while other phases (e.g.,
+  open list insertion) or other evaluators (e.g., sum) are timed, and
+  their time is counted for both.
+*/
+class SearchProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        int64_t calls = 0;
+        Clock::duration time = Clock::duration::zero();
+    };
+private:
+    bool enabled;
+    Clock::duration report_interval;
+    Clock::time_point start_time;
+    Clock::time_point next_report_time;
+    std::vector<Entry> phases;
+    // Indexed by the cache slots of the evaluators.
+    std::vector<Entry> evaluator_entries;
+    std::vector<const Evaluator *> evaluators;
+
+    void print_report(
+        const SearchStatistics &statistics, utils::LogProxy &log,
+        bool is_final) const;
+public:
+    SearchProfiler();
+
+    /*
+      Start profiling. Reports are printed every report_interval seconds
+      of search time (only at the end if report_interval is 0 or
+      infinite).
+    */
+    void enable(double report_interval);
+    bool is_enabled() const {
+        return enabled;
+    }
+
+    Entry &get_entry(SearchPhase phase) {
+        return phases[static_cast<int>(phase)];
+    }
+    Entry &get_entry(const Evaluator *evaluator);
+
+    void print_report_if_due(
+        const SearchStatistics &statistics, utils::LogProxy &log) {
+        if (enabled && Clock::now() >= next_report_time) {
+            print_report(statistics, log, false);
+            next_report_time += report_interval;
+        }
+    }
+    void print_final_report(
+        const SearchStatistics &statistics, utils::LogProxy &log) const;
+};
+
+/*
+  Adds the time from its construction to its destruction to a phase or
+  evaluator of a profiler. Does nothing if the profiler is null or
+  disabled.
+*/
+class ScopedProfileTimer {
+    SearchProfiler *profiler;
+    SearchPhase phase;
+    /*
+      The entry is only looked up when the timer stops, since timing the
+      subevaluators of an evaluator can move the entries of evaluators.
+    */
+    const Evaluator *evaluator;
+    SearchProfiler::Clock::time_point start;
+public:
+    ScopedProfileTimer(SearchProfiler &profiler, SearchPhase phase)
+        : profiler(profiler.is_enabled() ? &profiler : nullptr),
+          phase(phase),
+          evaluator(nullptr) {
+        if (this->profiler)
+            start = SearchProfiler::Clock::now();
+    }
+
+    ScopedProfileTimer(SearchProfiler *profiler, const Evaluator *evaluator)
+        : profiler(profiler && profiler->is_enabled() ? profiler : nullptr),
+          phase(SearchPhase::SUCCESSOR_GENERATION),
+          evaluator(evaluator) {
+        if (this->profiler)
+            start = SearchProfiler::Clock::now();
+    }
+
+    ~ScopedProfileTimer() {
+        if (profiler) {
+            SearchProfiler::Entry &entry = evaluator ?
+                profiler->get_entry(evaluator) : profiler->get_entry(phase);
+            entry.time += SearchProfiler::Clock::now() - start;
+            ++entry.calls;
+        }
+    }
+
+    ScopedProfileTimer(const ScopedProfileTimer &) = delete;
+    ScopedProfileTimer &operator=(const ScopedProfileTimer &) = delete;
+};
+
+#endif
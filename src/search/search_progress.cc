@@ -17,11 +17,11 @@ bool SearchProgress::process_evaluator_value(const Evaluator *evaluator, int val
       2. return true if this is a new lowest value
          (includes case where we haven't seen this evaluator before)
     */
-    auto insert_result = min_values.insert(make_pair(evaluator, value));
-    auto iter = insert_result.first;
-    bool was_inserted = insert_result.second;
-    if (was_inserted) {
+    // Look up before inserting to avoid allocating a node for every call.
+    auto iter = min_values.find(evaluator);
+    if (iter == min_values.end()) {
         // We haven't seen this evaluator before.
+        min_values.emplace(evaluator, value);
         return true;
     } else {
         int &min_value = iter->second;
@@ -6,9 +6,12 @@
 
   It keeps counters for expanded, generated and evaluated states (and
   some other statistics) and provides uniform output for all search
-  methods.
+  methods. Its profiler measures where the search spends its time if
+  profiling is enabled.
 */
 
+#include "search_profiler.h"
+
 namespace utils {
 class LogProxy;
 }
@@ -33,6 +36,8 @@ class SearchStatistics {
     int lastjump_evaluated_states;
     int lastjump_generated_states;
 
+    SearchProfiler profiler;
+
     void print_f_line() const;
 public:
     explicit SearchStatistics(utils::LogProxy &log);
@@ -55,6 +60,8 @@ public:
     int get_reopened() const {return reopened_states;}
     int get_generated_ops() const {return generated_ops;}
 
+    SearchProfiler &get_profiler() {return profiler;}
+
     /*
       Call the following method with the f value of every expanded
       state. It will notice "jumps" (i.e., when the expanded f value
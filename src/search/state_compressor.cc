@@ -0,0 +1,62 @@
+#include "state_compressor.h"
+
+#include "utils/logging.h"
+
+#include <cassert>
+
+using namespace std;
+
+StateCompressor::Group::Group(int first_bin, int size)
+    : first_bin(first_bin),
+      size(size),
+      values(size),
+      value_ids(ValueHash(values, size), ValueEqual(values, size)) {
+}
+
+StateCompressor::StateCompressor(int num_bins, int group_size)
+    : num_bins(num_bins) {
+    assert(group_size > 0);
+    for (int first_bin = 0; first_bin < num_bins; first_bin += group_size) {
+        groups.push_back(make_unique<Group>(
+                             first_bin, min(group_size, num_bins - first_bin)));
+    }
+}
+
+void StateCompressor::encode(const PackedStateBin *buffer, PackedStateBin *encoded) {
+    for (size_t i = 0; i < groups.size(); ++i) {
+        Group &group = *groups[i];
+        group.values.push_back(buffer + group.first_bin);
+        pair<int, bool> result = group.value_ids.insert(group.values.size() - 1);
+        if (!result.second) {
+            group.values.pop_back();
+        }
+        encoded[i] = result.first;
+    }
+}
+
+void StateCompressor::decode(const PackedStateBin *encoded, PackedStateBin *buffer) const {
+    for (size_t i = 0; i < groups.size(); ++i) {
+        const Group &group = *groups[i];
+        const PackedStateBin *value = group.values[encoded[i]];
+        copy(value, value + group.size, buffer + group.first_bin);
+    }
+}
+
+size_t StateCompressor::get_dictionary_size_in_bytes() const {
+    size_t bytes = 0;
+    for (const auto &group : groups) {
+        bytes += group->values.size() * group->size * sizeof(PackedStateBin);
+        bytes += static_cast<size_t>(group->value_ids.capacity()) *
+            (sizeof(int) + sizeof(int_hash_set::HashType));
+    }
+    return bytes;
+}
+
+void StateCompressor::print_statistics(utils::LogProxy &log) const {
+    log << "State compression: " << num_bins << " bins encoded in "
+        << groups.size() << " bins, dictionary sizes:";
+    for (const auto &group : groups) {
+        log << " " << group->values.size();
+    }
+    log << endl;
+}
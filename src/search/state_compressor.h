@@ -0,0 +1,154 @@
+#ifndef STATE_COMPRESSOR_H
+#define STATE_COMPRESSOR_H
+
+#include "algorithms/int_hash_set.h"
+#include "algorithms/int_packer.h"
+#include "algorithms/segmented_vector.h"
+#include "utils/hash.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace utils {
+class LogProxy;
+}
+
+using PackedStateBin = int_packer::IntPacker::Bin;
+
+/*
+  StateCompressor dictionary-encodes packed states for the StateRegistry.
+
+  The bins of a packed state are split into groups of group_size consecutive
+  bins. For each group, the compressor keeps a dictionary of the distinct
+  values the group has taken so far and encodes a state as the indices of its
+  group values in these dictionaries, i.e., with one bin per group instead of
+  group_size bins. This pays off because the variables packed into a group
+  usually take only a small fraction of their value combinations in the
+  reachable states (e.g., because of mutexes), so the dictionaries stay small
+  compared to the number of states.
+
+  Since every group value has exactly one index, two states are equal iff
+  their encodings are equal. Encoded states can therefore be hashed and
+  compared for duplicate detection without decoding them.
+
+  Dictionary entries are never removed.
+*/
+class StateCompressor {
+    struct Group {
+        struct ValueHash {
+            const segmented_vector::SegmentedArrayVector<PackedStateBin> &values;
+            int size;
+            ValueHash(
+                const segmented_vector::SegmentedArrayVector<PackedStateBin> &values,
+                int size)
+                : values(values), size(size) {
+            }
+
+            int_hash_set::HashType operator()(int id) const {
+                utils::HashState hash_state;
+                const PackedStateBin *value = values[id];
+                for (int i = 0; i < size; ++i) {
+                    hash_state.feed(value[i]);
+                }
+                return hash_state.get_hash32();
+            }
+        };
+
+        struct ValueEqual {
+            const segmented_vector::SegmentedArrayVector<PackedStateBin> &values;
+            int size;
+            ValueEqual(
+                const segmented_vector::SegmentedArrayVector<PackedStateBin> &values,
+                int size)
+                : values(values), size(size) {
+            }
+
+            bool operator()(int lhs, int rhs) const {
+                const PackedStateBin *lhs_value = values[lhs];
+                return std::equal(lhs_value, lhs_value + size, values[rhs]);
+            }
+        };
+
+        const int first_bin;
+        const int size;
+        segmented_vector::SegmentedArrayVector<PackedStateBin> values;
+        int_hash_set::IntHashSet<ValueHash, ValueEqual> value_ids;
+
+        Group(int first_bin, int size);
+    };
+
+    const int num_bins;
+    std::vector<std::unique_ptr<Group>> groups;
+
+public:
+    StateCompressor(int num_bins, int group_size);
+
+    // Number of bins of an encoded state.
+    int get_num_encoded_bins() const {
+        return groups.size();
+    }
+
+    /*
+      Writes the encoding of the given packed state to encoded. Group values
+      that were not seen before are added to the dictionaries.
+    */
+    void encode(const PackedStateBin *buffer, PackedStateBin *encoded);
+    void decode(const PackedStateBin *encoded, PackedStateBin *buffer) const;
+
+    size_t get_dictionary_size_in_bytes() const;
+    void print_statistics(utils::LogProxy &log) const;
+};
+
+class DecodedStatePool;
+
+/*
+  Packed data of a state that a registry with a StateCompressor decoded.
+  The buffer is shared by the State objects that refer to it (see
+  DecodedStateHandle) and goes back to its pool when the last of them is
+  destroyed.
+*/
+struct DecodedStateBuffer {
+    DecodedStatePool *pool;
+    int ref_count;
+    std::vector<PackedStateBin> data;
+
+    DecodedStateBuffer(DecodedStatePool *pool, int num_bins)
+        : pool(pool), ref_count(0), data(num_bins) {
+    }
+};
+
+/*
+  Pool of the decoded buffers of a registry. Buffers are reused, so that
+  decoding states only allocates memory while more states are alive than
+  ever before. The reference counts are not synchronized; like their
+  registry, the buffers must only be used by one thread. States with
+  decoded buffers must not outlive the pool.
+*/
+class DecodedStatePool {
+    const int num_bins;
+    std::vector<std::unique_ptr<DecodedStateBuffer>> buffers;
+    std::vector<DecodedStateBuffer *> free_buffers;
+public:
+    explicit DecodedStatePool(int num_bins)
+        : num_bins(num_bins) {
+    }
+
+    // Returns a buffer with one reference.
+    DecodedStateBuffer *allocate() {
+        if (free_buffers.empty()) {
+            buffers.push_back(std::make_unique<DecodedStateBuffer>(this, num_bins));
+            free_buffers.push_back(buffers.back().get());
+        }
+        DecodedStateBuffer *buffer = free_buffers.back();
+        free_buffers.pop_back();
+        buffer->ref_count = 1;
+        return buffer;
+    }
+
+    void release(DecodedStateBuffer *buffer) {
+        free_buffers.push_back(buffer);
+    }
+};
+
+#endif
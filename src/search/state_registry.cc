@@ -8,15 +8,36 @@
 
 using namespace std;
 
-StateRegistry::StateRegistry(const TaskProxy &task_proxy)
+StateRegistry::StateRegistry(
+    const TaskProxy &task_proxy,
+    const shared_ptr<utils::MappedMemoryPool> &external_memory,
+    int compression_group_size)
     : task_proxy(task_proxy),
       state_packer(task_properties::g_state_packers[task_proxy]),
       axiom_evaluator(g_axiom_evaluators[task_proxy]),
       num_variables(task_proxy.get_variables().size()),
-      state_data_pool(get_bins_per_state()),
+      external_memory(external_memory),
+      compressor(compression_group_size > 0 ?
+                 make_unique<StateCompressor>(
+                     get_bins_per_state(), compression_group_size) : nullptr),
+      compressed_buffer(compressor ? compressor->get_num_encoded_bins() : 0),
+      decoded_states(compressor ?
+                     make_unique<DecodedStatePool>(get_bins_per_state()) : nullptr),
+      state_data_pool(
+          get_bins_per_stored_state(),
+          utils::MappedAllocator<PackedStateBin>(external_memory)),
       registered_states(
-          StateIDSemanticHash(state_data_pool, get_bins_per_state()),
-          StateIDSemanticEqual(state_data_pool, get_bins_per_state())) {
+          StateIDSemanticHash(state_data_pool, get_bins_per_stored_state()),
+          StateIDSemanticEqual(state_data_pool, get_bins_per_stored_state())) {
+}
+
+void StateRegistry::push_state_data(const PackedStateBin *buffer) {
+    if (compressor) {
+        compressor->encode(buffer, compressed_buffer.data());
+        state_data_pool.push_back(compressed_buffer.data());
+    } else {
+        state_data_pool.push_back(buffer);
+    }
 }
 
 StateID StateRegistry::insert_id_or_pop_state() {
@@ -36,8 +57,23 @@ StateID StateRegistry::insert_id_or_pop_state() {
     return StateID(result.first);
 }
 
+StateID StateRegistry::insert_id_or_pop_state(int_hash_set::HashType hash) {
+    StateID id(state_data_pool.size() - 1);
+    pair<int, bool> result = registered_states.insert_with_hash(id.value, hash);
+    if (!result.second) {
+        state_data_pool.pop_back();
+    }
+    assert(registered_states.size() == static_cast<int>(state_data_pool.size()));
+    return StateID(result.first);
+}
+
 State StateRegistry::lookup_state(StateID id) const {
     const PackedStateBin *buffer = state_data_pool[id.value];
+    if (compressor) {
+        DecodedStateBuffer *decoded = decoded_states->allocate();
+        compressor->decode(buffer, decoded->data.data());
+        return task_proxy.create_state(*this, id, decoded);
+    }
     return task_proxy.create_state(*this, id, buffer);
 }
 
@@ -52,7 +88,7 @@ const State &StateRegistry::get_initial_state() {
         for (size_t i = 0; i < initial_state.size(); ++i) {
             state_packer.set(buffer.get(), i, initial_state[i].get_value());
         }
-        state_data_pool.push_back(buffer.get());
+        push_state_data(buffer.get());
         StateID id = insert_id_or_pop_state();
         cached_initial_state = utils::make_unique_ptr<State>(lookup_state(id));
     }
@@ -64,13 +100,97 @@ const State &StateRegistry::get_initial_state() {
 //     operating on state buffers (PackedStateBin *).
 State StateRegistry::get_successor_state(const State &predecessor, const OperatorProxy &op) {
     assert(!op.is_axiom());
-    state_data_pool.push_back(predecessor.get_buffer());
-    PackedStateBin *buffer = state_data_pool[state_data_pool.size() - 1];
+    /*
+      Without compression, the successor is computed in place in the state
+      data pool. Otherwise, it is computed in its own buffer, which is then
+      encoded into the pool and kept by the successor.
+    */
+    DecodedStateBuffer *decoded = nullptr;
+    PackedStateBin *buffer;
+    if (compressor) {
+        decoded = decoded_states->allocate();
+        copy(predecessor.get_buffer(),
+             predecessor.get_buffer() + get_bins_per_state(), decoded->data.begin());
+        buffer = decoded->data.data();
+    } else {
+        state_data_pool.push_back(predecessor.get_buffer());
+        buffer = state_data_pool[state_data_pool.size() - 1];
+    }
+    vector<int> new_values;
+    compute_successor_data(predecessor, op, buffer, new_values);
+    if (compressor) {
+        push_state_data(buffer);
+        StateID id = insert_id_or_pop_state();
+        return task_proxy.create_state(*this, id, decoded);
+    }
+    StateID id = insert_id_or_pop_state();
+    if (task_properties::has_axioms(task_proxy)) {
+        return task_proxy.create_state(*this, id, buffer, move(new_values));
+    }
+    return task_proxy.create_state(*this, id, buffer);
+}
+
+void StateRegistry::get_successor_states(
+    const State &predecessor, const vector<OperatorID> &op_ids,
+    vector<State> &successors) {
+    int num_successors = op_ids.size();
+    int num_bins = get_bins_per_state();
+    int num_stored_bins = get_bins_per_stored_state();
+    OperatorsProxy operators = task_proxy.get_operators();
+
+    // Compute the data of all successors.
+    successor_data.resize(num_successors * num_bins);
+    vector<int> new_values;
+    for (int i = 0; i < num_successors; ++i) {
+        PackedStateBin *buffer = &successor_data[i * num_bins];
+        copy(predecessor.get_buffer(), predecessor.get_buffer() + num_bins, buffer);
+        OperatorProxy op = operators[op_ids[i]];
+        assert(!op.is_axiom());
+        compute_successor_data(predecessor, op, buffer, new_values);
+    }
+    const PackedStateBin *stored_data = successor_data.data();
+    if (compressor) {
+        compressed_successor_data.resize(num_successors * num_stored_bins);
+        for (int i = 0; i < num_successors; ++i) {
+            compressor->encode(&successor_data[i * num_bins],
+                               &compressed_successor_data[i * num_stored_bins]);
+        }
+        stored_data = compressed_successor_data.data();
+    }
+
+    /*
+      Hash all successors and prefetch their buckets before inserting them,
+      so that the memory accesses of the hash set overlap.
+    */
+    successor_hashes.resize(num_successors);
+    for (int i = 0; i < num_successors; ++i) {
+        successor_hashes[i] = get_packed_state_hash(
+            stored_data + i * num_stored_bins, num_stored_bins);
+        registered_states.prefetch(successor_hashes[i]);
+    }
+
+    for (int i = 0; i < num_successors; ++i) {
+        state_data_pool.push_back(stored_data + i * num_stored_bins);
+        StateID id = insert_id_or_pop_state(successor_hashes[i]);
+        if (compressor) {
+            const PackedStateBin *buffer = &successor_data[i * num_bins];
+            DecodedStateBuffer *decoded = decoded_states->allocate();
+            copy(buffer, buffer + num_bins, decoded->data.begin());
+            successors.push_back(task_proxy.create_state(*this, id, decoded));
+        } else {
+            successors.push_back(lookup_state(id));
+        }
+    }
+}
+
+void StateRegistry::compute_successor_data(
+    const State &predecessor, const OperatorProxy &op, PackedStateBin *buffer,
+    vector<int> &new_values) const {
     /* Experiments for issue348 showed that for tasks with axioms it's faster
        to compute successor states using unpacked data. */
     if (task_properties::has_axioms(task_proxy)) {
         predecessor.unpack();
-        vector<int> new_values = predecessor.get_unpacked_values();
+        new_values = predecessor.get_unpacked_values();
         for (EffectProxy effect : op.get_effects()) {
             if (does_fire(effect, predecessor)) {
                 FactPair effect_pair = effect.get_fact().get_pair();
@@ -81,8 +201,6 @@ State StateRegistry::get_successor_state(const State &predecessor, const Operato
         for (size_t i = 0; i < new_values.size(); ++i) {
             state_packer.set(buffer, i, new_values[i]);
         }
-        StateID id = insert_id_or_pop_state();
-        return task_proxy.create_state(*this, id, buffer, move(new_values));
     } else {
         for (EffectProxy effect : op.get_effects()) {
             if (does_fire(effect, predecessor)) {
@@ -90,15 +208,23 @@ State StateRegistry::get_successor_state(const State &predecessor, const Operato
                 state_packer.set(buffer, effect_pair.var, effect_pair.value);
             }
         }
-        StateID id = insert_id_or_pop_state();
-        return task_proxy.create_state(*this, id, buffer);
     }
 }
 
+State StateRegistry::register_state(const PackedStateBin *buffer) {
+    push_state_data(buffer);
+    StateID id = insert_id_or_pop_state();
+    return lookup_state(id);
+}
+
 int StateRegistry::get_bins_per_state() const {
     return state_packer.get_num_bins();
 }
 
+int StateRegistry::get_bins_per_stored_state() const {
+    return compressor ? compressor->get_num_encoded_bins() : get_bins_per_state();
+}
+
 int StateRegistry::get_state_size_in_bytes() const {
     return get_bins_per_state() * sizeof(PackedStateBin);
 }
@@ -106,4 +232,18 @@ int StateRegistry::get_state_size_in_bytes() const {
 void StateRegistry::print_statistics(utils::LogProxy &log) const {
     log << "Number of registered states: " << size() << endl;
     registered_states.print_statistics(log);
+    if (size() > 0) {
+        double state_data_bytes =
+            static_cast<double>(state_data_pool.size()) *
+            get_bins_per_stored_state() * sizeof(PackedStateBin);
+        if (compressor) {
+            compressor->print_statistics(log);
+            state_data_bytes += compressor->get_dictionary_size_in_bytes();
+        }
+        log << "Stored bytes per state: " << state_data_bytes / size()
+            << " (uncompressed: " << get_state_size_in_bytes() << ")" << endl;
+    }
+    if (external_memory) {
+        external_memory->print_statistics(log);
+    }
 }
@@ -3,6 +3,7 @@
 
 #include "abstract_task.h"
 #include "axioms.h"
+#include "state_compressor.h"
 #include "state_id.h"
 
 #include "algorithms/int_hash_set.h"
@@ -10,7 +11,9 @@
 #include "algorithms/segmented_vector.h"
 #include "algorithms/subscriber.h"
 #include "utils/hash.h"
+#include "utils/mapped_memory.h"
 
+#include <memory>
 #include <set>
 
 /*
@@ -113,31 +116,29 @@ using PackedStateBin = int_packer::IntPacker::Bin;
 
 
 class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
+    using StateDataPool = segmented_vector::SegmentedArrayVector<
+        PackedStateBin, utils::MappedAllocator<PackedStateBin>>;
+
     struct StateIDSemanticHash {
-        const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        const StateDataPool &state_data_pool;
         int state_size;
         StateIDSemanticHash(
-            const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool,
+            const StateDataPool &state_data_pool,
             int state_size)
             : state_data_pool(state_data_pool),
               state_size(state_size) {
         }
 
         int_hash_set::HashType operator()(int id) const {
-            const PackedStateBin *data = state_data_pool[id];
-            utils::HashState hash_state;
-            for (int i = 0; i < state_size; ++i) {
-                hash_state.feed(data[i]);
-            }
-            return hash_state.get_hash32();
+            return get_packed_state_hash(state_data_pool[id], state_size);
         }
     };
 
     struct StateIDSemanticEqual {
-        const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool;
+        const StateDataPool &state_data_pool;
         int state_size;
         StateIDSemanticEqual(
-            const segmented_vector::SegmentedArrayVector<PackedStateBin> &state_data_pool,
+            const StateDataPool &state_data_pool,
             int state_size)
             : state_data_pool(state_data_pool),
               state_size(state_size) {
@@ -162,15 +163,66 @@ class StateRegistry : public subscriber::SubscriberService<StateRegistry> {
     AxiomEvaluator &axiom_evaluator;
     const int num_variables;
 
-    segmented_vector::SegmentedArrayVector<PackedStateBin> state_data_pool;
+    std::shared_ptr<utils::MappedMemoryPool> external_memory;
+    /*
+      If states are stored compressed, state_data_pool holds the encodings
+      of the states and compressed_buffer is used to encode new states.
+    */
+    std::unique_ptr<StateCompressor> compressor;
+    std::vector<PackedStateBin> compressed_buffer;
+    // Buffers for decoded states if states are stored compressed.
+    std::unique_ptr<DecodedStatePool> decoded_states;
+    // Scratch space for get_successor_states.
+    std::vector<PackedStateBin> successor_data;
+    std::vector<PackedStateBin> compressed_successor_data;
+    std::vector<int_hash_set::HashType> successor_hashes;
+    StateDataPool state_data_pool;
     StateIDSet registered_states;
 
     std::unique_ptr<State> cached_initial_state;
 
+    void push_state_data(const PackedStateBin *buffer);
     StateID insert_id_or_pop_state();
+    // Same as above for a hash that was computed (and prefetched) in advance.
+    StateID insert_id_or_pop_state(int_hash_set::HashType hash);
+    /*
+      Applies op to the packed data of predecessor in buffer. If the task has
+      axioms, the unpacked values of the successor are stored in new_values.
+    */
+    void compute_successor_data(
+        const State &predecessor, const OperatorProxy &op,
+        PackedStateBin *buffer, std::vector<int> &new_values) const;
     int get_bins_per_state() const;
+    int get_bins_per_stored_state() const;
 public:
-    explicit StateRegistry(const TaskProxy &task_proxy);
+    /*
+      If external_memory is given, the state data and the information that
+      PerStateInformation and PerStateArray objects store for the states of
+      this registry are allocated from it instead of the heap.
+
+      If compression_group_size is positive, states are stored encoded by a
+      StateCompressor with groups of this many bins. Looking up such a state
+      decodes it into a pooled buffer that is shared by the returned State
+      and its copies (see DecodedStatePool).
+    */
+    explicit StateRegistry(
+        const TaskProxy &task_proxy,
+        const std::shared_ptr<utils::MappedMemoryPool> &external_memory = nullptr,
+        int compression_group_size = 0);
+
+    /*
+      Hash of packed state data as used for duplicate detection. Registries
+      of the same task pack states identically, so the hash can be used to
+      distribute states among several registries.
+    */
+    static int_hash_set::HashType get_packed_state_hash(
+        const PackedStateBin *data, int num_bins) {
+        utils::HashState hash_state;
+        for (int i = 0; i < num_bins; ++i) {
+            hash_state.feed(data[i]);
+        }
+        return hash_state.get_hash32();
+    }
 
     const TaskProxy &get_task_proxy() const {
         return task_proxy;
@@ -184,6 +236,11 @@ public:
         return state_packer;
     }
 
+    // Returns nullptr if per-state data is kept on the heap.
+    const std::shared_ptr<utils::MappedMemoryPool> &get_external_memory() const {
+        return external_memory;
+    }
+
     /*
       Returns the state that was registered at the given ID. The ID must refer
       to a state in this registry. Do not mix IDs from from different registries.
@@ -203,6 +260,26 @@ public:
     */
     State get_successor_state(const State &predecessor, const OperatorProxy &op);
 
+    /*
+      Appends the successors of predecessor under the given operators to
+      successors (in the same order) and registers them if this was not done
+      before. This is equivalent to calling get_successor_state for each
+      operator, but faster: the data of all successors is computed in one
+      scratch buffer and their hash buckets are prefetched before they are
+      inserted.
+    */
+    void get_successor_states(
+        const State &predecessor, const std::vector<OperatorID> &op_ids,
+        std::vector<State> &successors);
+
+    /*
+      Returns the state with the given packed data and registers it if this
+      was not done before. The data must be packed with the state packer of
+      this registry's task (e.g. by another registry of the same task) and
+      must already reflect the effects of axioms.
+    */
+    State register_state(const PackedStateBin *buffer);
+
     /*
       Returns the number of states registered so far.
     */
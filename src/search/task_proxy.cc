@@ -1,6 +1,7 @@
 #include "task_proxy.h"
 
 #include "axioms.h"
+#include "state_compressor.h"
 #include "state_registry.h"
 
 #include "task_utils/causal_graph.h"
@@ -28,6 +29,21 @@ State::State(const AbstractTask &task, const StateRegistry &registry,
     this->values = make_shared<vector<int>>(move(values));
 }
 
+void DecodedStateHandle::retain() const {
+    ++buffer->ref_count;
+}
+
+void DecodedStateHandle::release() {
+    if (--buffer->ref_count == 0)
+        buffer->pool->release(buffer);
+}
+
+State::State(const AbstractTask &task, const StateRegistry &registry,
+             StateID id, DecodedStateBuffer *decoded_buffer)
+    : State(task, registry, id, decoded_buffer->data.data()) {
+    this->decoded_buffer = DecodedStateHandle(decoded_buffer);
+}
+
 State::State(const AbstractTask &task, vector<int> &&values)
     : task(&task), registry(nullptr), id(StateID::no_state), buffer(nullptr),
       values(make_shared<vector<int>>(move(values))),
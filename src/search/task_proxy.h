@@ -20,6 +20,7 @@
 
 class AxiomsProxy;
 class ConditionsProxy;
+struct DecodedStateBuffer;
 class EffectProxy;
 class EffectConditionsProxy;
 class EffectsProxy;
@@ -553,6 +554,50 @@ public:
 bool does_fire(const EffectProxy &effect, const State &state);
 
 
+/*
+  Reference to a DecodedStateBuffer (see state_compressor.h) that is
+  counted by the buffer. The buffer goes back to its pool when the last
+  reference is destroyed. A handle without a buffer costs only a null
+  check when it is copied or destroyed.
+*/
+class DecodedStateHandle {
+    DecodedStateBuffer *buffer;
+
+    void retain() const;
+    void release();
+public:
+    DecodedStateHandle()
+        : buffer(nullptr) {
+    }
+
+    // Takes over the reference of the caller.
+    explicit DecodedStateHandle(DecodedStateBuffer *buffer)
+        : buffer(buffer) {
+    }
+
+    DecodedStateHandle(const DecodedStateHandle &other)
+        : buffer(other.buffer) {
+        if (buffer)
+            retain();
+    }
+
+    DecodedStateHandle(DecodedStateHandle &&other) noexcept
+        : buffer(other.buffer) {
+        other.buffer = nullptr;
+    }
+
+    DecodedStateHandle &operator=(DecodedStateHandle other) noexcept {
+        std::swap(buffer, other.buffer);
+        return *this;
+    }
+
+    ~DecodedStateHandle() {
+        if (buffer)
+            release();
+    }
+};
+
+
 class State {
     /*
       TODO: We want to try out two things:
@@ -568,6 +613,12 @@ class State {
     const StateRegistry *registry;
     StateID id;
     const PackedStateBin *buffer;
+    /*
+      Registries that store states compressed decode them into a pooled
+      buffer that is shared by the state and its copies. Otherwise, the
+      handle is empty and buffer points into the registry.
+    */
+    DecodedStateHandle decoded_buffer;
     /*
       values is mutable because we think of it as a redundant representation
       of the state's contents, a kind of cache. One could argue for doing this
@@ -590,6 +641,12 @@ public:
     // Construct a registered state with packed and unpacked data.
     State(const AbstractTask &task, const StateRegistry &registry, StateID id,
           const PackedStateBin *buffer, std::vector<int> &&values);
+    /*
+      Construct a registered state whose packed data is in a decoded
+      buffer. The state takes over the reference of the caller.
+    */
+    State(const AbstractTask &task, const StateRegistry &registry, StateID id,
+          DecodedStateBuffer *decoded_buffer);
     // Construct a state with only unpacked data.
     State(const AbstractTask &task, std::vector<int> &&values);
 
@@ -699,6 +756,13 @@ public:
         return State(*task, registry, id, buffer, std::move(state_values));
     }
 
+    // This method is meant to be called only by the state registry.
+    State create_state(
+        const StateRegistry &registry, StateID id,
+        DecodedStateBuffer *decoded_buffer) const {
+        return State(*task, registry, id, decoded_buffer);
+    }
+
     State get_initial_state() const {
         return create_state(task->get_initial_state_values());
     }
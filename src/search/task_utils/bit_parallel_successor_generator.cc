@@ -0,0 +1,90 @@
+#include "bit_parallel_successor_generator.h"
+
+#include "task_properties.h"
+
+#include "../task_proxy.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace successor_generator {
+BitParallelSuccessorGenerator::BitParallelSuccessorGenerator(
+    const TaskProxy &task_proxy)
+    : state_packer(task_properties::g_state_packers[task_proxy]) {
+    OperatorsProxy task_operators = task_proxy.get_operators();
+    vector<pair<vector<FactPair>, OperatorID>> sorted_operators;
+    sorted_operators.reserve(task_operators.size());
+    for (OperatorProxy op : task_operators) {
+        vector<FactPair> precondition;
+        for (FactProxy pre : op.get_preconditions())
+            precondition.push_back(pre.get_pair());
+        sort(precondition.begin(), precondition.end());
+        sorted_operators.emplace_back(move(precondition), OperatorID(op.get_id()));
+    }
+    // Same order as in SuccessorGeneratorFactory.
+    stable_sort(sorted_operators.begin(), sorted_operators.end(),
+                [](const auto &lhs, const auto &rhs) {
+                    return lhs.first < rhs.first;
+                });
+
+    int num_operators = sorted_operators.size();
+    vector<int> slot_for_bin(state_packer.get_num_bins(), -1);
+    for (int block_start = 0; block_start < num_operators; block_start += BLOCK_SIZE) {
+        block_begin.push_back(block_bins.size());
+        int block_end = min(num_operators, block_start + BLOCK_SIZE);
+        for (int op_index = block_start; op_index < block_end; ++op_index) {
+            const auto &[precondition, op_id] = sorted_operators[op_index];
+            operators.push_back(op_id);
+            for (FactPair pre : precondition) {
+                int bin = state_packer.get_bin_index(pre.var);
+                int &slot = slot_for_bin[bin];
+                if (slot == -1) {
+                    slot = block_bins.size();
+                    block_bins.push_back(bin);
+                    masks.resize(masks.size() + BLOCK_SIZE, 0);
+                    bits.resize(bits.size() + BLOCK_SIZE, 0);
+                }
+                int pos = slot * BLOCK_SIZE + op_index - block_start;
+                masks[pos] |= state_packer.get_mask(pre.var);
+                bits[pos] |= state_packer.get_bits(pre.var, pre.value);
+            }
+        }
+        for (int i = block_begin.back(); i < static_cast<int>(block_bins.size()); ++i)
+            slot_for_bin[block_bins[i]] = -1;
+    }
+    block_begin.push_back(block_bins.size());
+}
+
+void BitParallelSuccessorGenerator::generate_applicable_ops(
+    const Bin *buffer, vector<OperatorID> &applicable_ops) const {
+    int num_operators = operators.size();
+    int num_blocks = block_begin.size() - 1;
+    Bin differences[BLOCK_SIZE];
+    for (int block = 0; block < num_blocks; ++block) {
+        fill_n(differences, BLOCK_SIZE, 0);
+        for (int slot = block_begin[block]; slot < block_begin[block + 1]; ++slot) {
+            Bin bin = buffer[block_bins[slot]];
+            const Bin *slot_masks = &masks[slot * BLOCK_SIZE];
+            const Bin *slot_bits = &bits[slot * BLOCK_SIZE];
+            for (int i = 0; i < BLOCK_SIZE; ++i) {
+                differences[i] |= (bin & slot_masks[i]) ^ slot_bits[i];
+            }
+        }
+        int block_start = block * BLOCK_SIZE;
+        int block_size = min(BLOCK_SIZE, num_operators - block_start);
+        for (int i = 0; i < block_size; ++i) {
+            if (!differences[i])
+                applicable_ops.push_back(operators[block_start + i]);
+        }
+    }
+}
+
+void BitParallelSuccessorGenerator::generate_applicable_ops(
+    const vector<int> &values, vector<OperatorID> &applicable_ops) const {
+    vector<Bin> buffer(state_packer.get_num_bins(), 0);
+    for (size_t var = 0; var < values.size(); ++var)
+        state_packer.set(buffer.data(), var, values[var]);
+    generate_applicable_ops(buffer.data(), applicable_ops);
+}
+}
@@ -0,0 +1,56 @@
+#ifndef TASK_UTILS_BIT_PARALLEL_SUCCESSOR_GENERATOR_H
+#define TASK_UTILS_BIT_PARALLEL_SUCCESSOR_GENERATOR_H
+
+#include "../algorithms/int_packer.h"
+#include "../operator_id.h"
+
+#include <vector>
+
+class TaskProxy;
+
+namespace successor_generator {
+/*
+  Successor generator that tests the preconditions of all operators on the
+  packed data of a state, without unpacking it.
+
+  A precondition var = value holds in a buffer iff the bits of var in its
+  bin equal the bits of value (see IntPacker::get_bits). The preconditions
+  of an operator on the variables of one bin can therefore be tested with a
+  single AND and compare, and the operator is applicable iff
+  (buffer[bin] & mask) XOR bits is 0 for all bins it has preconditions in.
+
+  The operators are split into blocks of BLOCK_SIZE operators. For each
+  block and each bin in which one of its operators has a precondition, we
+  store the masks and bits of all operators of the block in two arrays,
+  with empty masks and bits for operators without preconditions in this
+  bin. The differences of the block's operators are accumulated bin by bin
+  in a loop over these arrays that the compiler can vectorize.
+
+  The operators are sorted like in SuccessorGeneratorFactory, so applicable
+  operators are generated in the same order as with the successor generator
+  tree.
+*/
+class BitParallelSuccessorGenerator {
+    using Bin = int_packer::IntPacker::Bin;
+    static constexpr int BLOCK_SIZE = 64;
+
+    const int_packer::IntPacker &state_packer;
+    std::vector<OperatorID> operators;
+    // Block b tests the bins block_bins[block_begin[b]...block_begin[b+1]-1].
+    std::vector<int> block_begin;
+    std::vector<int> block_bins;
+    // BLOCK_SIZE masks and bits for each entry of block_bins.
+    std::vector<Bin> masks;
+    std::vector<Bin> bits;
+public:
+    explicit BitParallelSuccessorGenerator(const TaskProxy &task_proxy);
+
+    void generate_applicable_ops(
+        const Bin *buffer, std::vector<OperatorID> &applicable_ops) const;
+    // Packs the given values first. Used for unregistered states.
+    void generate_applicable_ops(
+        const std::vector<int> &values, std::vector<OperatorID> &applicable_ops) const;
+};
+}
+
+#endif
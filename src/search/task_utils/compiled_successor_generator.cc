@@ -0,0 +1,83 @@
+#include "compiled_successor_generator.h"
+
+#include "successor_generator_internals.h"
+
+#include "../utils/language.h"
+
+#include <cassert>
+
+using namespace std;
+
+namespace successor_generator {
+CompiledSuccessorGenerator::CompiledSuccessorGenerator(const GeneratorBase &root) {
+    int root_node = root.compile(program);
+    utils::unused_variable(root_node);
+    assert(root_node == 0);
+}
+
+inline const int *CompiledSuccessorGenerator::skip_switches(
+    const int *node, const int *state) const {
+    while (true) {
+        int type = node[0];
+        if (type == SWITCH) {
+            int value = state[node[1]];
+            if (value >= node[2] || node[3 + value] == NO_NODE)
+                return nullptr;
+            node = program.data() + node[3 + value];
+        } else if (type == SWITCH_SINGLE) {
+            if (state[node[1]] != node[2])
+                return nullptr;
+            node = program.data() + node[3];
+        } else {
+            return node;
+        }
+    }
+}
+
+inline void CompiledSuccessorGenerator::append_leaf(
+    const int *leaf, vector<OperatorID> &applicable_ops) const {
+    assert(leaf[0] == LEAF);
+    /*
+      Leaves are usually small, so this is faster than inserting the
+      range (see also GeneratorLeafVector).
+    */
+    for (int i = 0; i < leaf[1]; ++i) {
+        applicable_ops.push_back(OperatorID(leaf[2 + i]));
+    }
+}
+
+void CompiledSuccessorGenerator::generate_applicable_ops_for_fork(
+    const int *fork, const int *state,
+    vector<OperatorID> &applicable_ops) const {
+    assert(fork[0] == FORK);
+    /*
+      We follow the switches below each child in this loop, so we only
+      recurse for forks below forks, which are rare.
+    */
+    const int *entry = fork + 2;
+    const int *end = entry + fork[1] * 3;
+    for (; entry != end; entry += 3) {
+        int var = entry[0];
+        if (var != NO_VARIABLE && state[var] != entry[1])
+            continue;
+        const int *node = skip_switches(program.data() + entry[2], state);
+        if (!node)
+            continue;
+        if (node[0] == LEAF)
+            append_leaf(node, applicable_ops);
+        else
+            generate_applicable_ops_for_fork(node, state, applicable_ops);
+    }
+}
+
+void CompiledSuccessorGenerator::generate_applicable_ops(
+    const vector<int> &state, vector<OperatorID> &applicable_ops) const {
+    const int *node = skip_switches(program.data(), state.data());
+    if (!node)
+        return;
+    if (node[0] == LEAF)
+        append_leaf(node, applicable_ops);
+    else
+        generate_applicable_ops_for_fork(node, state.data(), applicable_ops);
+}
+}
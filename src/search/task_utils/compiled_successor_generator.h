@@ -0,0 +1,68 @@
+#ifndef TASK_UTILS_COMPILED_SUCCESSOR_GENERATOR_H
+#define TASK_UTILS_COMPILED_SUCCESSOR_GENERATOR_H
+
+#include "../operator_id.h"
+
+#include <vector>
+
+namespace successor_generator {
+class GeneratorBase;
+
+/*
+  Node types of a compiled successor generator. A node is stored as its
+  type followed by its payload:
+
+  - fork:          [FORK, n, var_1, value_1, child_1, ...,
+                    var_n, value_n, child_n]
+                   where child_i is only visited if the state has value_i
+                   for var_i. It is visited unconditionally if var_i is
+                   NO_VARIABLE. Single switches that are children of forks
+                   are folded into the fork this way.
+  - switch:        [SWITCH, var_id, k, child_0, ..., child_{k-1}]
+                   where child_i is the node for value i, or NO_NODE.
+                   Values >= k have no node.
+  - single switch: [SWITCH_SINGLE, var_id, value, child]
+  - leaf:          [LEAF, n, op_id_1, ..., op_id_n]
+
+  Children are given by their positions in the program.
+*/
+enum CompiledNodeType {
+    FORK,
+    SWITCH,
+    SWITCH_SINGLE,
+    LEAF
+};
+
+const int NO_NODE = -1;
+const int NO_VARIABLE = -1;
+
+/*
+  Flat version of a successor generator tree (see the notes on a
+  "byte-code" representation in successor_generator_internals.cc).
+
+  All nodes, including the operators of the leaves, are stored in one vector
+  of ints. Hash switches of the tree become dense switch tables, and single
+  switches below forks are folded into the forks. Computing the applicable operators needs neither virtual
+  calls nor hash lookups and touches contiguous memory.
+*/
+class CompiledSuccessorGenerator {
+    std::vector<int> program;
+
+    /*
+      Follows the switch nodes from node on. Returns the first fork or leaf
+      reached, or nullptr if the state has a value without a child.
+    */
+    const int *skip_switches(const int *node, const int *state) const;
+    void append_leaf(const int *leaf, std::vector<OperatorID> &applicable_ops) const;
+    void generate_applicable_ops_for_fork(
+        const int *fork, const int *state,
+        std::vector<OperatorID> &applicable_ops) const;
+public:
+    explicit CompiledSuccessorGenerator(const GeneratorBase &root);
+
+    void generate_applicable_ops(
+        const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const;
+};
+}
+
+#endif
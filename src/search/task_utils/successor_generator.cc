@@ -1,23 +1,52 @@
 #include "successor_generator.h"
 
+#include "bit_parallel_successor_generator.h"
+#include "compiled_successor_generator.h"
 #include "successor_generator_factory.h"
 #include "successor_generator_internals.h"
 
 #include "../abstract_task.h"
 
+#include "../utils/memory.h"
+
 using namespace std;
 
 namespace successor_generator {
-SuccessorGenerator::SuccessorGenerator(const TaskProxy &task_proxy)
-    : root(SuccessorGeneratorFactory(task_proxy).create()) {
+SuccessorGeneratorType g_successor_generator_type = SuccessorGeneratorType::TREE;
+
+SuccessorGenerator::SuccessorGenerator(const TaskProxy &task_proxy) {
+    if (g_successor_generator_type == SuccessorGeneratorType::BIT_PARALLEL) {
+        bit_parallel = utils::make_unique_ptr<BitParallelSuccessorGenerator>(task_proxy);
+        return;
+    }
+    root = SuccessorGeneratorFactory(task_proxy).create();
+    if (g_successor_generator_type == SuccessorGeneratorType::COMPILED) {
+        compiled = utils::make_unique_ptr<CompiledSuccessorGenerator>(*root);
+        // The tree is not needed anymore.
+        root = nullptr;
+    }
 }
 
 SuccessorGenerator::~SuccessorGenerator() = default;
 
 void SuccessorGenerator::generate_applicable_ops(
     const State &state, vector<OperatorID> &applicable_ops) const {
+    if (bit_parallel) {
+        // Registered states are tested without unpacking them.
+        if (state.get_registry()) {
+            bit_parallel->generate_applicable_ops(state.get_buffer(), applicable_ops);
+        } else {
+            bit_parallel->generate_applicable_ops(
+                state.get_unpacked_values(), applicable_ops);
+        }
+        return;
+    }
     state.unpack();
-    root->generate_applicable_ops(state.get_unpacked_values(), applicable_ops);
+    if (compiled) {
+        compiled->generate_applicable_ops(state.get_unpacked_values(), applicable_ops);
+    } else {
+        root->generate_applicable_ops(state.get_unpacked_values(), applicable_ops);
+    }
 }
 
 PerTaskInformation<SuccessorGenerator> g_successor_generators;
@@ -11,10 +11,31 @@ class State;
 class TaskProxy;
 
 namespace successor_generator {
+class BitParallelSuccessorGenerator;
+class CompiledSuccessorGenerator;
 class GeneratorBase;
 
+enum class SuccessorGeneratorType {
+    // Tree of polymorphic nodes.
+    TREE,
+    // The same tree, compiled into a flat program.
+    COMPILED,
+    // Word-level tests of all preconditions on the packed state data.
+    BIT_PARALLEL
+};
+
+/*
+  Type of the successor generators created by g_successor_generators. It is
+  set by the planner option successor_generator=tree|compiled|bit_parallel
+  and must not be changed after the first successor generator has been
+  created.
+*/
+extern SuccessorGeneratorType g_successor_generator_type;
+
 class SuccessorGenerator {
     std::unique_ptr<GeneratorBase> root;
+    std::unique_ptr<CompiledSuccessorGenerator> compiled;
+    std::unique_ptr<BitParallelSuccessorGenerator> bit_parallel;
 
 public:
     explicit SuccessorGenerator(const TaskProxy &task_proxy);
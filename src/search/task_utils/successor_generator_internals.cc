@@ -1,7 +1,10 @@
 #include "successor_generator_internals.h"
 
+#include "compiled_successor_generator.h"
+
 #include "../task_proxy.h"
 
+#include <algorithm>
 #include <cassert>
 
 using namespace std;
@@ -57,6 +60,9 @@ using namespace std;
     nodes, which could be used in the case where k equals the domain
     size of the variable in question.)
 
+    A variant of this representation is implemented by
+    CompiledSuccessorGenerator (see compiled_successor_generator.h).
+
   - More modestly, we could stick with the current polymorphic code,
     but just use more types of nodes, such as switch nodes that stores
     a vector of (value, child) pairs to be scanned linearly or with
@@ -68,6 +74,14 @@ using namespace std;
 */
 
 namespace successor_generator {
+void GeneratorBase::compile_fork_child(
+    vector<int> &program, int fork_entry) const {
+    int child = compile(program);
+    program[fork_entry] = NO_VARIABLE;
+    program[fork_entry + 1] = 0;
+    program[fork_entry + 2] = child;
+}
+
 GeneratorForkBinary::GeneratorForkBinary(
     unique_ptr<GeneratorBase> generator1,
     unique_ptr<GeneratorBase> generator2)
@@ -86,6 +100,16 @@ void GeneratorForkBinary::generate_applicable_ops(
     generator2->generate_applicable_ops(state, applicable_ops);
 }
 
+int GeneratorForkBinary::compile(vector<int> &program) const {
+    int node = program.size();
+    program.push_back(FORK);
+    program.push_back(2);
+    program.resize(program.size() + 2 * 3, NO_NODE);
+    generator1->compile_fork_child(program, node + 2);
+    generator2->compile_fork_child(program, node + 5);
+    return node;
+}
+
 GeneratorForkMulti::GeneratorForkMulti(vector<unique_ptr<GeneratorBase>> children)
     : children(move(children)) {
     /* Note that we permit 0-ary forks as a way to define empty
@@ -101,6 +125,18 @@ void GeneratorForkMulti::generate_applicable_ops(
         generator->generate_applicable_ops(state, applicable_ops);
 }
 
+int GeneratorForkMulti::compile(vector<int> &program) const {
+    int node = program.size();
+    int num_children = children.size();
+    program.push_back(FORK);
+    program.push_back(num_children);
+    program.resize(program.size() + num_children * 3, NO_NODE);
+    for (int i = 0; i < num_children; ++i) {
+        children[i]->compile_fork_child(program, node + 2 + i * 3);
+    }
+    return node;
+}
+
 GeneratorSwitchVector::GeneratorSwitchVector(
     int switch_var_id, vector<unique_ptr<GeneratorBase>> &&generator_for_value)
     : switch_var_id(switch_var_id),
@@ -116,6 +152,22 @@ void GeneratorSwitchVector::generate_applicable_ops(
     }
 }
 
+int GeneratorSwitchVector::compile(vector<int> &program) const {
+    int node = program.size();
+    int num_values = generator_for_value.size();
+    program.push_back(SWITCH);
+    program.push_back(switch_var_id);
+    program.push_back(num_values);
+    program.resize(program.size() + num_values, NO_NODE);
+    for (int value = 0; value < num_values; ++value) {
+        if (generator_for_value[value]) {
+            int child = generator_for_value[value]->compile(program);
+            program[node + 3 + value] = child;
+        }
+    }
+    return node;
+}
+
 GeneratorSwitchHash::GeneratorSwitchHash(
     int switch_var_id,
     unordered_map<int, unique_ptr<GeneratorBase>> &&generator_for_value)
@@ -133,6 +185,32 @@ void GeneratorSwitchHash::generate_applicable_ops(
     }
 }
 
+int GeneratorSwitchHash::compile(vector<int> &program) const {
+    /*
+      The switch table only covers the values up to the largest value with
+      a child. It is at most as large as the domain of the variable.
+    */
+    int num_values = 0;
+    for (const auto &item : generator_for_value)
+        num_values = max(num_values, item.first + 1);
+    int node = program.size();
+    program.push_back(SWITCH);
+    program.push_back(switch_var_id);
+    program.push_back(num_values);
+    program.resize(program.size() + num_values, NO_NODE);
+    // Compile the children in the order of their values for determinism.
+    vector<int> values;
+    values.reserve(generator_for_value.size());
+    for (const auto &item : generator_for_value)
+        values.push_back(item.first);
+    sort(values.begin(), values.end());
+    for (int value : values) {
+        int child = generator_for_value.at(value)->compile(program);
+        program[node + 3 + value] = child;
+    }
+    return node;
+}
+
 GeneratorSwitchSingle::GeneratorSwitchSingle(
     int switch_var_id, int value, unique_ptr<GeneratorBase> generator_for_value)
     : switch_var_id(switch_var_id),
@@ -147,6 +225,22 @@ void GeneratorSwitchSingle::generate_applicable_ops(
     }
 }
 
+int GeneratorSwitchSingle::compile(vector<int> &program) const {
+    int node = program.size();
+    program.insert(program.end(), {SWITCH_SINGLE, switch_var_id, value, NO_NODE});
+    int child = generator_for_value->compile(program);
+    program[node + 3] = child;
+    return node;
+}
+
+void GeneratorSwitchSingle::compile_fork_child(
+    vector<int> &program, int fork_entry) const {
+    int child = generator_for_value->compile(program);
+    program[fork_entry] = switch_var_id;
+    program[fork_entry + 1] = value;
+    program[fork_entry + 2] = child;
+}
+
 GeneratorLeafVector::GeneratorLeafVector(vector<OperatorID> &&applicable_operators)
     : applicable_operators(move(applicable_operators)) {
 }
@@ -165,6 +259,15 @@ void GeneratorLeafVector::generate_applicable_ops(
     }
 }
 
+int GeneratorLeafVector::compile(vector<int> &program) const {
+    int node = program.size();
+    program.push_back(LEAF);
+    program.push_back(applicable_operators.size());
+    for (OperatorID op_id : applicable_operators)
+        program.push_back(op_id.get_index());
+    return node;
+}
+
 GeneratorLeafSingle::GeneratorLeafSingle(OperatorID applicable_operator)
     : applicable_operator(applicable_operator) {
 }
@@ -173,4 +276,10 @@ void GeneratorLeafSingle::generate_applicable_ops(
     const vector<int> &, vector<OperatorID> &applicable_ops) const {
     applicable_ops.push_back(applicable_operator);
 }
+
+int GeneratorLeafSingle::compile(vector<int> &program) const {
+    int node = program.size();
+    program.insert(program.end(), {LEAF, 1, applicable_operator.get_index()});
+    return node;
+}
 }
@@ -16,6 +16,21 @@ public:
 
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const = 0;
+
+    /*
+      Appends this node and its descendants to the program of a
+      CompiledSuccessorGenerator. Returns the position of this node in the
+      program.
+    */
+    virtual int compile(std::vector<int> &program) const = 0;
+
+    /*
+      Like compile, but for a child of a fork. Writes the fork entry
+      (var_id, value, child) for this node to fork_entry (see
+      CompiledNodeType).
+    */
+    virtual void compile_fork_child(
+        std::vector<int> &program, int fork_entry) const;
 };
 
 class GeneratorForkBinary : public GeneratorBase {
@@ -27,6 +42,7 @@ public:
         std::unique_ptr<GeneratorBase> generator2);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 
 class GeneratorForkMulti : public GeneratorBase {
@@ -35,6 +51,7 @@ public:
     GeneratorForkMulti(std::vector<std::unique_ptr<GeneratorBase>> children);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 
 class GeneratorSwitchVector : public GeneratorBase {
@@ -46,6 +63,7 @@ public:
         std::vector<std::unique_ptr<GeneratorBase>> &&generator_for_value);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 
 class GeneratorSwitchHash : public GeneratorBase {
@@ -57,6 +75,7 @@ public:
         std::unordered_map<int, std::unique_ptr<GeneratorBase>> &&generator_for_value);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 
 class GeneratorSwitchSingle : public GeneratorBase {
@@ -69,6 +88,9 @@ public:
         std::unique_ptr<GeneratorBase> generator_for_value);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
+    virtual void compile_fork_child(
+        std::vector<int> &program, int fork_entry) const override;
 };
 
 class GeneratorLeafVector : public GeneratorBase {
@@ -77,6 +99,7 @@ public:
     GeneratorLeafVector(std::vector<OperatorID> &&applicable_operators);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 
 class GeneratorLeafSingle : public GeneratorBase {
@@ -85,6 +108,7 @@ public:
     GeneratorLeafSingle(OperatorID applicable_operator);
     virtual void generate_applicable_ops(
         const std::vector<int> &state, std::vector<OperatorID> &applicable_ops) const override;
+    virtual int compile(std::vector<int> &program) const override;
 };
 }
 
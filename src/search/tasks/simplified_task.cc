@@ -8,6 +8,7 @@ SimplifiedTask::SimplifiedTask(const shared_ptr<RootTask> parent, compositor com
   cout << "> Simplifing Task (Composing Operators)" << endl;
   //print_problem();
   //print_operators();
+  numParentOperators = operators.size();
 
   std::set<int> compositedOperators = compositor.compositedOperatorIDs;
   //Clear the compositedOperators
@@ -22,12 +23,14 @@ SimplifiedTask::SimplifiedTask(const shared_ptr<RootTask> parent, compositor com
   {
       operators.push_back(CompOp);
   }
+  compactOperators();
   	//print_operators();
 }
 
 
 SimplifiedTask::SimplifiedTask(const shared_ptr<RootTask> parent, std::list<int> safeVariables) : RootTask(*parent) {
-  if (safeVariables.empty()) {return;}
+  numParentOperators = operators.size();
+  if (safeVariables.empty()) {compactOperators(); return;}
     /*
         Remo: Create the simplified, i.e. the safely abstracted, task here by
         modifying the vectors listed below (inherited from RootTask):
@@ -48,10 +51,8 @@ SimplifiedTask::SimplifiedTask(const shared_ptr<RootTask> parent, std::list<int>
     //print_operators();
 
     //axioms.clear();
-    simplifyOperators(safeVariables);
-    removeGoals(safeVariables);
-    resizeVariableIDs(safeVariables);
     removeVariables(safeVariables);
+    compactOperators();
 
     cout << variables.size() << " variables remain." << endl;
 
@@ -60,159 +61,115 @@ SimplifiedTask::SimplifiedTask(const shared_ptr<RootTask> parent, std::list<int>
     //print_operators();
 }
 
-void SimplifiedTask::removeVariables(std::list<int> safeVarID)
+/*
+Projects the task onto the remaining variables in a single pass: the variable remap table is computed once and then
+the variables, initial state, goals, mutexes, operators and axioms are rewritten with it. Facts on safe variables
+are dropped from all of them. The remap keeps the order of the variables, so sorted fact collections stay sorted.
+*/
+void SimplifiedTask::removeVariables(const std::list<int> &safeVarID)
 {
     cout << "Removing Safe Variables..." << endl;
-    std::list<string> safeVariables;
-    for (int safeVarID : safeVarID) {
-        safeVariables.push_back(get_variable(safeVarID).name);
-
+    //Remap table: old variable id -> new variable id (-1 for removed variables)
+    vector<int> variableRemap(variables.size(), 0);
+    for (int var : safeVarID) {variableRemap[var] = -1;}
+    int numRemaining = 0;
+    for (int var = 0; var < (int)variables.size(); var++)
+    {
+        if (variableRemap[var] != -1) {variableRemap[var] = numRemaining++;}
     }
 
-    for (string safe_var : safeVariables)
+    auto projectFacts = [&variableRemap](vector<FactPair> &facts)
     {
-        //This is very inefficient but .erase resizes the vector so I'm not sure how to do this better yet
-        for (int i = 0; i < (int)variables.size(); i++)
+        int kept = 0;
+        for (const FactPair &fact : facts)
         {
-            if (safe_var == variables[i].name)
-            {
-                //cout << "Removing variable: " << safe_var << std::endl;
-                variables.erase(variables.begin() + i);
-                break;
-            }
+            int var = variableRemap[fact.var];
+            if (var != -1) {facts[kept++] = FactPair(var, fact.value);}
         }
-    }
-}
-
-void SimplifiedTask::simplifyOperators(std::list<int> safeVarID)
-{
-    cout << "Simplifing Operators..." << endl;
-    std::list<string> safeOperators;
-    for (int i = 0; i < (int)operators.size(); i++)
+        facts.erase(facts.begin() + kept, facts.end());
+    };
+    auto projectOperator = [&](ExplicitOperator &op)
     {
-        ExplicitOperator op = operators[i];
-        bool free_operation = true;
-
-        for (const FactPair& precon : op.preconditions){
-            for (int var : safeVarID){
-                if (var != precon.var){
-                    free_operation = false;
-                }
-            }
-        }
-        for (const ExplicitEffect& postcon : op.effects){
-            for (int var : safeVarID){
-                if (var != postcon.fact.var){
-                    free_operation = false;
-                }
-            }
-        }
-        if (free_operation)
+        projectFacts(op.preconditions);
+        int kept = 0;
+        for (ExplicitEffect &effect : op.effects)
         {
-            safeOperators.push_back(op.name);
+            int var = variableRemap[effect.fact.var];
+            if (var == -1) {continue;}
+            effect.fact.var = var;
+            projectFacts(effect.conditions);
+            if (&op.effects[kept] != &effect) {op.effects[kept] = std::move(effect);}
+            kept++;
         }
+        op.effects.erase(op.effects.begin() + kept, op.effects.end());
+    };
+
+    for (ExplicitOperator &op : operators) {projectOperator(op);}
+    //Axioms have exactly one effect, the ones deriving a removed variable are dropped
+    int keptAxioms = 0;
+    for (ExplicitOperator &axiom : axioms)
+    {
+        projectOperator(axiom);
+        if (axiom.effects.empty()) {continue;}
+        if (&axioms[keptAxioms] != &axiom) {axioms[keptAxioms] = std::move(axiom);}
+        keptAxioms++;
     }
+    axioms.erase(axioms.begin() + keptAxioms, axioms.end());
 
-    //Remove the operators that are safe
-    for (string safe_op : safeOperators)
+    projectFacts(goals);
+
+    vector<vector<set<FactPair>>> projectedMutexes;
+    projectedMutexes.reserve(numRemaining);
+    for (int var = 0; var < (int)variables.size(); var++)
     {
-        //This is very inefficient but .erase resizes the vector so I'm not sure how to do this better yet
-        for (int i = 0; i < (int)operators.size(); i++)
+        if (variableRemap[var] == -1) {continue;}
+        vector<set<FactPair>> valueMutexes(mutexes[var].size());
+        for (int val = 0; val < (int)mutexes[var].size(); val++)
         {
-            if (safe_op == operators[i].name)
+            for (const FactPair &fact : mutexes[var][val])
             {
-                //cout << "Removing operation: " << safe_op << std::endl;
-                //operators.erase(operators.begin() + i);
-                operators[i].preconditions.clear();
-                operators[i].effects.clear();
-                break;
+                int mutexVar = variableRemap[fact.var];
+                //Facts are visited in order, so inserting at the end is constant time
+                if (mutexVar != -1) {valueMutexes[val].insert(valueMutexes[val].end(), FactPair(mutexVar, fact.value));}
             }
         }
+        projectedMutexes.push_back(std::move(valueMutexes));
     }
+    mutexes.swap(projectedMutexes);
 
-    //Remove the preconditions / postconditions using the abstracted variables
-    for (int i = 0; i < (int)operators.size(); i++)
+    int kept = 0;
+    for (int var = 0; var < (int)variables.size(); var++)
     {
-        bool all_is_clean = true;
-        do //It is horrible to brute force it like this. I'll fix it later (hopefully)
+        if (variableRemap[var] == -1) {continue;}
+        if (kept != var)
         {
-            all_is_clean = true;
-            for (int var : safeVarID){
-                for (int j = 0; j < operators[i].preconditions.size(); j++) {
-                    if (var == operators[i].preconditions[j].var){
-                        //cout << operators[i].name << ": Removing precondition: " << operators[i].preconditions[j].var << " = " << operators[i].preconditions[j].value << std::endl;
-
-                        all_is_clean = false;
-                        operators[i].preconditions.erase(operators[i].preconditions.begin() + j);
-                        break;
-                    }
-                }
-            }
-            for (int var : safeVarID){
-                for (int j = 0; j < operators[i].effects.size(); j++){ //(const ExplicitEffect& postcon : op.effects){
-                    if (var == operators[i].effects[j].fact.var){
-                        //cout << operators[i].name << ": Removing postcondition: " << operators[i].effects[j].fact.var << " = " << operators[i].effects[j].fact.value << std::endl;
-
-                        all_is_clean = false;
-                        operators[i].effects.erase(operators[i].effects.begin() + j);
-                        break;
-                    }
-                }
-            }
+            variables[kept] = std::move(variables[var]);
+            initial_state_values[kept] = initial_state_values[var];
         }
-        while (!all_is_clean);
+        kept++;
     }
+    variables.erase(variables.begin() + kept, variables.end());
+    initial_state_values.resize(kept);
 }
 
-void SimplifiedTask::removeGoals(std::list<int> safeVarID)
+/*
+Removes all operators without effects (the ones that were "removed" by clearing them and the ones that only changed
+abstracted variables) and remembers for every remaining operator its id in the parent task.
+*/
+void SimplifiedTask::compactOperators()
 {
-    cout << "Removing Goals for safe variables..." << endl;
-    std::list<FactPair> safeGoals;
-    for (int safeVarID : safeVarID) {
-        for (FactPair goal : goals) {
-            if (goal.var == safeVarID) {safeGoals.push_back(goal);}
-        }
-    }
-
-    for (FactPair goal : safeGoals)
+    parentOperatorIDs.clear();
+    vector<ExplicitOperator> remainingOperators;
+    remainingOperators.reserve(operators.size());
+    for (int i = 0; i < (int)operators.size(); i++)
     {
-        auto index = std::find(goals.begin(), goals.end(), goal);
-
-        if (index != goals.end()) {
-            goals.erase(index);
-            //cout << "Removing goal: " << goal.var << " = " << goal.value << std::endl;
-        }
-    }
-}
-
-void SimplifiedTask::resizeVariableIDs(std::list<int> safeVarID)
-{
-    cout << "Adjusting VariableIDs..." << endl;
-    int offset = 0;
-    safeVarID.sort();
-    //cout << "Rezining these variable ids: ";
-    //for (int target : safeVarID)
-    //{
-    //  cout << target << ", ";
-    //}
-    //cout << endl;
-    for (int target : safeVarID) {
-        target = target - offset;//This "moves" safeVarIDs as the list is shifted
-        //cout << "Adjusting: " << target << endl;
-
-        //Starting from the next higher variable (If we remove variable 3, we want to reduce all variables 4,5,6,... by one)
-        for (int i = target+1; i < (int)variables.size()-offset; i++) {
-            variableAdjuster::adjustOperators(i, operators);
-            variableAdjuster::adjustInitialValues(i,  initial_state_values);
-            variableAdjuster::adjustGoals(i,  goals);
-            variableAdjuster::adjustMutexIndex(i,  mutexes);
-            variableAdjuster::adjustMutexContent(i,  mutexes);
-        }
-
-        initial_state_values.pop_back(); //Removing last (now unused) slot
-        mutexes.pop_back();
-        offset++;
+        if (operators[i].effects.empty()) {continue;}
+        parentOperatorIDs.push_back(i);
+        remainingOperators.push_back(std::move(operators[i]));
     }
+    int numRemoved = operators.size() - remainingOperators.size();
+    operators.swap(remainingOperators);
+    if (numRemoved > 0) {cout << "Removed " << numRemoved << " operators without effects, " << operators.size() << " operators remain." << endl;}
 }
 
 void SimplifiedTask::print_variables()
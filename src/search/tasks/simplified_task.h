@@ -2,7 +2,6 @@
 #define TASKS_SIMPLIFIED_TASK_H
 
 #include "root_task.h"
-#include "../safe_abstraction/variableAdjuster.h"
 #include "../safe_abstraction/compositor.h"
 
 
@@ -16,10 +15,16 @@ namespace tasks {
 
 class SimplifiedTask : public RootTask {
 private:
-    void removeVariables(std::list<int> safeVarID);
-    void simplifyOperators(std::list<int> safeVarID);
-    void removeGoals(std::list<int> safeVarID);
-    void resizeVariableIDs(std::list<int> safeVarID);
+    /*
+      Operator id in the parent task for every operator of this task. Operators that were added by the compositor
+      get the ids following the operators of the parent (in the order of compositor.compositeOperators), which are
+      the ids used as keys of compositor.decompositOperations.
+    */
+    vector<int> parentOperatorIDs;
+    int numParentOperators;
+
+    void compactOperators();
+    void removeVariables(const std::list<int> &safeVarID);
     void print_variables();
     void print_mutexes();
     void print_operators(bool detailed = false);
@@ -28,6 +33,9 @@ private:
 public:
     SimplifiedTask(const shared_ptr<RootTask> parent, std::list<int> safeVariables);
     SimplifiedTask(const shared_ptr<RootTask> parent, compositor compositor);
+
+    int get_parent_operator_id(int op) const {return parentOperatorIDs[op];}
+    int get_num_parent_operators() const {return numParentOperators;}
 };
 
 }
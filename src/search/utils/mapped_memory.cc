@@ -0,0 +1,135 @@
+#include "mapped_memory.h"
+
+#include "logging.h"
+#include "system.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace utils {
+string g_external_memory_directory;
+
+static void exit_with_system_error(const string &message) {
+    cerr << message << ": " << strerror(errno) << endl;
+    exit_with(ExitCode::SEARCH_CRITICAL_ERROR);
+}
+
+#if OPERATING_SYSTEM == LINUX || OPERATING_SYSTEM == OSX
+MappedMemoryPool::MappedMemoryPool(const string &directory, size_t chunk_size)
+    : file_descriptor(-1),
+      chunk_size(chunk_size),
+      file_size(0),
+      next_free(nullptr),
+      bytes_left(0),
+      allocated_bytes(0) {
+    string path_template = directory + "/downward-states-XXXXXX";
+    vector<char> path(path_template.begin(), path_template.end());
+    path.push_back('\0');
+    file_descriptor = mkstemp(path.data());
+    if (file_descriptor == -1) {
+        exit_with_system_error("Could not create external memory file in " + directory);
+    }
+    // The file is only accessed through the descriptor and vanishes on exit.
+    unlink(path.data());
+}
+
+MappedMemoryPool::~MappedMemoryPool() {
+    for (const auto &chunk : chunks) {
+        munmap(chunk.first, chunk.second);
+    }
+    close(file_descriptor);
+}
+
+void MappedMemoryPool::add_chunk(size_t min_size) {
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t size = max(chunk_size, min_size);
+    size = (size + page_size - 1) / page_size * page_size;
+    if (ftruncate(file_descriptor, file_size + size) == -1) {
+        exit_with_system_error("Could not grow external memory file");
+    }
+    void *chunk = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                       file_descriptor, file_size);
+    if (chunk == MAP_FAILED) {
+        exit_with_system_error("Could not map external memory file");
+    }
+    file_size += size;
+    chunks.emplace_back(static_cast<char *>(chunk), size);
+    next_free = static_cast<char *>(chunk);
+    bytes_left = size;
+}
+#else
+MappedMemoryPool::MappedMemoryPool(const string &, size_t chunk_size)
+    : file_descriptor(-1),
+      chunk_size(chunk_size),
+      file_size(0),
+      next_free(nullptr),
+      bytes_left(0),
+      allocated_bytes(0) {
+    cerr << "External memory is not supported on this operating system." << endl;
+    exit_with(ExitCode::SEARCH_UNSUPPORTED);
+}
+
+MappedMemoryPool::~MappedMemoryPool() {
+}
+
+void MappedMemoryPool::add_chunk(size_t) {
+}
+#endif
+
+void *MappedMemoryPool::allocate(size_t size, size_t alignment) {
+    auto it = free_blocks.find(size);
+    if (it != free_blocks.end() && !it->second.empty() &&
+        reinterpret_cast<size_t>(it->second.back()) % alignment == 0) {
+        char *result = it->second.back();
+        it->second.pop_back();
+        allocated_bytes += size;
+        return result;
+    }
+    size_t padding = (alignment - reinterpret_cast<size_t>(next_free) % alignment) % alignment;
+    if (padding + size > bytes_left) {
+        // Chunks are page-aligned, so no padding is needed in a new chunk.
+        add_chunk(size);
+        padding = 0;
+    }
+    char *result = next_free + padding;
+    next_free = result + size;
+    bytes_left -= padding + size;
+    allocated_bytes += size;
+    assert(reinterpret_cast<size_t>(result) % alignment == 0);
+    return result;
+}
+
+void MappedMemoryPool::deallocate(void *block, size_t size) {
+    char *start = static_cast<char *>(block);
+    allocated_bytes -= size;
+    if (start + size == next_free) {
+        // The most recent allocation is returned to the current chunk.
+        next_free = start;
+        bytes_left += size;
+    } else {
+        free_blocks[size].push_back(start);
+    }
+}
+
+void MappedMemoryPool::print_statistics(LogProxy &log) const {
+    log << "External memory: " << allocated_bytes << " bytes allocated in "
+        << file_size << " bytes of mapped file" << endl;
+}
+
+shared_ptr<MappedMemoryPool> create_external_memory_pool() {
+    if (g_external_memory_directory.empty()) {
+        return nullptr;
+    }
+    return make_shared<MappedMemoryPool>(g_external_memory_directory);
+}
+}
@@ -0,0 +1,134 @@
+#ifndef UTILS_MAPPED_MEMORY_H
+#define UTILS_MAPPED_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace utils {
+class LogProxy;
+
+/*
+  Directory in which search algorithms store their per-state data (see
+  MappedMemoryPool). If empty (the default), per-state data is kept in RAM.
+*/
+extern std::string g_external_memory_directory;
+
+/*
+  MappedMemoryPool hands out memory that is backed by a file instead of swap
+  space. The file is created (and immediately unlinked) in the given
+  directory and mapped into memory in chunks of chunk_size bytes. Since the
+  mapping is shared with the file, the operating system can write cold pages
+  back to the file and evict them whenever memory gets tight, and reload them
+  on the next access. This lets data structures that are only partially hot,
+  such as the state data and search nodes of a large search, grow beyond the
+  available RAM.
+
+  Memory is allocated in a stack-like fashion. Released blocks are kept in
+  free lists by size and handed out again for requests of the same size,
+  which suits the fixed-size segments of the segmented vectors used for
+  per-state data. The file only shrinks when the pool is destroyed. The pool
+  is not thread-safe.
+
+  Note that the mapped file counts towards the address space of the process.
+  Memory limits should therefore be enforced on resident memory (e.g., with
+  cgroups) rather than with an address space limit.
+*/
+class MappedMemoryPool {
+    int file_descriptor;
+    const size_t chunk_size;
+    size_t file_size;
+    std::vector<std::pair<char *, size_t>> chunks;
+    char *next_free;
+    size_t bytes_left;
+    size_t allocated_bytes;
+    std::unordered_map<size_t, std::vector<char *>> free_blocks;
+
+    void add_chunk(size_t min_size);
+public:
+    explicit MappedMemoryPool(
+        const std::string &directory, size_t chunk_size = 64 * 1024 * 1024);
+    ~MappedMemoryPool();
+
+    MappedMemoryPool(const MappedMemoryPool &) = delete;
+    MappedMemoryPool &operator=(const MappedMemoryPool &) = delete;
+
+    void *allocate(size_t size, size_t alignment);
+    void deallocate(void *block, size_t size);
+
+    size_t get_allocated_bytes() const {
+        return allocated_bytes;
+    }
+
+    size_t get_file_size() const {
+        return file_size;
+    }
+
+    void print_statistics(LogProxy &log) const;
+};
+
+/*
+  Returns a pool in g_external_memory_directory or nullptr if no directory
+  is set.
+*/
+extern std::shared_ptr<MappedMemoryPool> create_external_memory_pool();
+
+/*
+  Allocator for the containers in segmented_vector.h. It allocates from the
+  given pool or, if the pool is nullptr, from the heap like std::allocator.
+*/
+template<typename T>
+class MappedAllocator {
+    template<typename>
+    friend class MappedAllocator;
+
+    std::shared_ptr<MappedMemoryPool> pool;
+public:
+    using value_type = T;
+
+    MappedAllocator() = default;
+
+    explicit MappedAllocator(const std::shared_ptr<MappedMemoryPool> &pool)
+        : pool(pool) {
+    }
+
+    template<typename U>
+    MappedAllocator(const MappedAllocator<U> &other)
+        : pool(other.pool) {
+    }
+
+    T *allocate(size_t n) {
+        if (pool) {
+            return static_cast<T *>(pool->allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (pool) {
+            pool->deallocate(p, n * sizeof(T));
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    const std::shared_ptr<MappedMemoryPool> &get_pool() const {
+        return pool;
+    }
+
+    template<typename U>
+    bool operator==(const MappedAllocator<U> &other) const {
+        return pool == other.pool;
+    }
+
+    template<typename U>
+    bool operator!=(const MappedAllocator<U> &other) const {
+        return pool != other.pool;
+    }
+};
+}
+
+#endif